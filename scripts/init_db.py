@@ -22,6 +22,11 @@ def create_connection(db_file):
         print(f"Error connecting to database: {e}")
         return None
 
+def detach_search_index(conn):
+    """移除 members_fts 的同步触发器，使本脚本可以写入 members 表"""
+    for trigger in ("members_ai", "members_ad", "members_au"):
+        conn.execute(f"DROP TRIGGER IF EXISTS {trigger};")
+
 def create_tables(conn):
     """[Fix] 创建完整的数据库表结构，与 C++ 保持一致"""
     cursor = conn.cursor()
@@ -48,35 +53,10 @@ def create_tables(conn):
         );
     """)
 
-    # 2. FTS5 全文检索表 (用于搜索)
-    # 注意：Python sqlite3 必须编译了 FTS5 支持才能运行此句。
-    # 大多数现代 Linux/macOS 的 Python 默认都支持。
-    try:
-        cursor.execute("""
-            CREATE VIRTUAL TABLE IF NOT EXISTS members_fts USING fts5(
-                name, bio, content='members', content_rowid='rowid'
-            );
-        """)
-
-        # FTS 触发器 (保持同步)
-        cursor.execute("""
-            CREATE TRIGGER IF NOT EXISTS members_ai AFTER INSERT ON members BEGIN
-              INSERT INTO members_fts(rowid, name, bio) VALUES (new.rowid, new.name, new.bio);
-            END;
-        """)
-        cursor.execute("""
-            CREATE TRIGGER IF NOT EXISTS members_ad AFTER DELETE ON members BEGIN
-              INSERT INTO members_fts(members_fts, rowid, name, bio) VALUES('delete', old.rowid, old.name, old.bio);
-            END;
-        """)
-        cursor.execute("""
-            CREATE TRIGGER IF NOT EXISTS members_au AFTER UPDATE ON members BEGIN
-              INSERT INTO members_fts(members_fts, rowid, name, bio) VALUES('delete', old.rowid, old.name, old.bio);
-              INSERT INTO members_fts(rowid, name, bio) VALUES (new.rowid, new.name, new.bio);
-            END;
-        """)
-    except sqlite3.OperationalError as e:
-        print(f"Warning: FTS5 support missing in Python sqlite3. Search index skipped. ({e})")
+    # 2. FTS5 全文检索表由应用自己维护：members_fts 使用应用注册的 cjk 分词器，
+    #    它的同步触发器在没有注册该分词器的连接上 (如本脚本) 会报 "no such tokenizer: cjk"。
+    #    这里只移除触发器，应用下次启动时发现触发器缺失会重建索引并恢复触发器。
+    detach_search_index(conn)
 
     # 3. Media Resources 表 (v0.8 支持)
     cursor.execute("""
@@ -157,8 +137,7 @@ def init_db_from_csv(db_path, csv_path):
         cursor.execute("DELETE FROM media_resources")
         cursor.execute("DELETE FROM settings")
         cursor.execute("DELETE FROM operation_logs")
-        # 如果 FTS 表存在，重建它通常会自动清理，或者手动清理
-        # cursor.execute("INSERT INTO members_fts(members_fts) VALUES('rebuild')")
+        # members_fts 由应用在下次启动时重建 (见 detach_search_index)
     except Exception as e:
         print(f"Warning cleaning data: {e}")
 
@@ -0,0 +1,99 @@
+#include "bridge_dispatcher.h"
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QPointer>
+
+#include <utility>
+
+#include "core/log/log.h"
+#include "core/task/task_manager.h"
+
+BridgeDispatcher::BridgeDispatcher(QObject* parent)
+    : QObject(parent) {
+}
+
+BridgeDispatcher::~BridgeDispatcher() {
+    // Tasks still queued see the flag and skip their work
+    for (const auto& pending : std::as_const(m_pending)) {
+        pending.cancelled->store(true);
+    }
+}
+
+void BridgeDispatcher::post(const QString& requestId, const QString& channel, Work work,
+                            Deliver deliver) {
+    quint64 serial = m_nextSerial++;
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    if (!channel.isEmpty()) {
+        auto it = m_latestInChannel.find(channel);
+        if (it != m_latestInChannel.end()) {
+            cancelSerial(it.value());  // superseded
+        }
+        m_latestInChannel[channel] = serial;
+    }
+    if (!requestId.isEmpty()) {
+        cancel(requestId);  // a reused id replaces the earlier request
+        m_byRequestId[requestId] = serial;
+    }
+    m_pending.insert(serial, {requestId, channel, cancelled});
+
+    // Results are posted to the application object, which outlives this dispatcher; the
+    // QPointer is only dereferenced back on the GUI thread.
+    QPointer<BridgeDispatcher> self(this);
+    clan::core::TaskManager::instance().enqueue(
+        [self, serial, cancelled, work = std::move(work), deliver = std::move(deliver)] {
+            if (cancelled->load()) {
+                return;
+            }
+            QString result;
+            try {
+                result = work();
+            } catch (std::exception& e) {
+                LOGERROR("[Bridge] Request failed: {}", e.what());
+            }
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [self, serial, result = std::move(result), deliver] {
+                    if (self) {
+                        self->finish(serial, result, deliver);
+                    }
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void BridgeDispatcher::cancel(const QString& requestId) {
+    auto it = m_byRequestId.constFind(requestId);
+    if (it != m_byRequestId.constEnd()) {
+        cancelSerial(it.value());
+    }
+}
+
+void BridgeDispatcher::finish(quint64 serial, const QString& result, const Deliver& deliver) {
+    if (take(serial)) {
+        deliver(result);
+    }
+}
+
+void BridgeDispatcher::cancelSerial(quint64 serial) {
+    if (auto pending = take(serial)) {
+        pending->cancelled->store(true);
+    }
+}
+
+std::optional<BridgeDispatcher::Pending> BridgeDispatcher::take(quint64 serial) {
+    auto it = m_pending.find(serial);
+    if (it == m_pending.end()) {
+        return std::nullopt;  // already delivered or cancelled
+    }
+    Pending pending = std::move(it.value());
+    m_pending.erase(it);
+    if (!pending.requestId.isEmpty() && m_byRequestId.value(pending.requestId) == serial) {
+        m_byRequestId.remove(pending.requestId);
+    }
+    if (!pending.channel.isEmpty() && m_latestInChannel.value(pending.channel) == serial) {
+        m_latestInChannel.remove(pending.channel);
+    }
+    return pending;
+}
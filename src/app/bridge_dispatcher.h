@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+
+// Runs bridge calls on the TaskManager executor and hands each result back to the GUI
+// thread. A request is identified by the id the page chose for it (may be empty) and
+// optionally belongs to a channel, e.g. "search:<frame>": a newer request on the same
+// channel cancels the older ones, so a burst of keystrokes only delivers the last search.
+//
+// Cancellation is cooperative: a request that has not started is skipped, one that is
+// already running finishes but its result is dropped. All members are GUI-thread only.
+class BridgeDispatcher : public QObject {
+    Q_OBJECT
+
+  public:
+    using Work = std::function<QString()>;                       // worker thread
+    using Deliver = std::function<void(const QString& result)>;  // GUI thread
+
+    explicit BridgeDispatcher(QObject* parent = nullptr);
+    ~BridgeDispatcher() override;
+
+    void post(const QString& requestId, const QString& channel, Work work, Deliver deliver);
+
+    // Cancels a pending request; unknown or already delivered ids are ignored.
+    void cancel(const QString& requestId);
+
+    int pendingCount() const { return m_pending.size(); }
+
+  private:
+    struct Pending {
+        QString requestId;
+        QString channel;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    void finish(quint64 serial, const QString& result, const Deliver& deliver);
+    void cancelSerial(quint64 serial);
+    std::optional<Pending> take(quint64 serial);
+
+    quint64 m_nextSerial = 1;
+    QHash<quint64, Pending> m_pending;        // serial -> request
+    QHash<QString, quint64> m_byRequestId;    // page request id -> serial
+    QHash<QString, quint64> m_latestInChannel;
+};
@@ -13,8 +13,18 @@
 #include <QStandardPaths>
 #include <QUuid>
 
+#include <map>
+#include <memory>
+
+#include "core/cache/thumbnail_cache.h"
 #include "core/db/database_manager.h"
+#include "core/db/member_diff.h"
+#include "core/db/member_import.h"
+#include "core/json/bridge_json.h"
+#include "core/json/json_writer.h"
+#include "core/json/tree_snapshot.h"
 #include "core/log/log.h"
+#include "core/network/media_server.h"
 #include "core/platform/path_manager.h"
 #include "core/resource/resource_manager.h"
 
@@ -27,36 +37,139 @@ void JsBridge::test(const QString& message) {
     QMessageBox::information(nullptr, "Message from JS", message);
 }
 
+namespace {
+// Per-thread output buffer for the bridge reads, which run concurrently on the TaskManager
+// executor. Reused across calls; a buffer grown by a huge payload is not kept.
+clan::core::JsonWriter& ScratchWriter() {
+    constexpr size_t kInitialBytes = 64 * 1024;
+    constexpr size_t kMaxRetainedBytes = 4 * 1024 * 1024;
+    thread_local clan::core::JsonWriter writer(kInitialBytes);
+    if (writer.capacity() > kMaxRetainedBytes) {
+        writer = clan::core::JsonWriter(kInitialBytes);
+    }
+    writer.Clear();
+    return writer;
+}
+
+QString ToQString(const clan::core::JsonWriter& out) {
+    return QString::fromUtf8(out.str().data(), static_cast<qsizetype>(out.size()));
+}
+
+// Node shape shared by the full tree payload, the pages and the incremental deltas.
+void WriteTreeNode(clan::core::JsonWriter& out, const clan::core::Member& m) {
+    // Small cached thumbnail for the node avatar (empty without the media server)
+    std::string avatar;
+    if (!m.portrait_path.empty()) {
+        avatar = clan::core::MediaServer::instance().ThumbnailUrl(m.portrait_path, 64);
+    }
+    clan::core::WriteTreeNodeFields(out, m, avatar);
+}
+
+// The revision is read before the page, so deltas from it replay any racing write.
+QString TreePageToJson(qint64 revision, const clan::core::TreePage& page) {
+    auto& out = ScratchWriter();
+    out.BeginObject().Field("revision", static_cast<int64_t>(revision)).Key("nodes").BeginArray();
+    for (size_t i = 0; i < page.members.size(); ++i) {
+        out.BeginObject();
+        WriteTreeNode(out, page.members[i]);
+        out.Field("childCount", static_cast<int64_t>(page.child_counts[i])).EndObject();
+    }
+    out.EndArray().Field("hasMore", page.has_more).EndObject();
+    return ToQString(out);
+}
+
+size_t PageLimit(int limit) {
+    return limit > 0 ? static_cast<size_t>(limit) : 0;
+}
+}  // namespace
+
 QString JsBridge::fetchFamilyTree() {
     auto& db = clan::core::DatabaseManager::instance();
-    auto members = db.GetAllMembers();
+    auto members = db.GetTreeMembers();  // resident index, no SQLite round-trip
 
-    QJsonArray jsonArray;
+    auto& out = ScratchWriter();
+    out.Reserve(members.size() * 256);  // typical node size, avoids regrowing
+    out.BeginArray();
     for (const auto& m : members) {
-        QJsonObject jobj;
-        jobj["id"] = QString::fromStdString(m.id);
-        jobj["name"] = QString::fromStdString(m.name);
-        jobj["parentId"] = QString::fromStdString(m.father_id);
-        jobj["generation"] = m.generation;
-        jobj["generationName"] = QString::fromStdString(m.generation_name);
-        jobj["spouseName"] = QString::fromStdString(m.spouse_name);
-        jobj["gender"] = QString::fromStdString(m.gender);
-        jobj["portraitPath"] = QString::fromStdString(m.portrait_path);
-
-        QString lifeSpan;
-        if (!m.birth_date.empty()) {
-            lifeSpan = QString::fromStdString(m.birth_date).left(4);
-            if (!m.death_date.empty()) {
-                lifeSpan += "-" + QString::fromStdString(m.death_date).left(4);
-            }
-        }
-        jobj["lifeSpan"] = lifeSpan;
+        out.BeginObject();
+        WriteTreeNode(out, m);
+        out.EndObject();
+    }
+    out.EndArray();
+    return ToQString(out);
+}
+
+QString JsBridge::fetchTreeSnapshot() {
+    qint64 revision = treeRevision();  // before the members, as for the JSON snapshot
+    std::vector<int32_t> fathers;
+    auto members = clan::core::DatabaseManager::instance().GetTreeMembers(&fathers);
+
+    auto& media = clan::core::MediaServer::instance();
+    auto bytes = std::make_shared<const std::string>(clan::core::EncodeTreeSnapshot(
+        members, fathers, static_cast<uint64_t>(revision),
+        [&media](const clan::core::Member& m) { return media.ThumbnailUrl(m.portrait_path, 64); }));
+    std::string url = media.PublishBlob("tree", static_cast<uint64_t>(revision), bytes);
+
+    auto& out = ScratchWriter();
+    out.BeginObject()
+        .Field("url", url)
+        .Field("revision", static_cast<int64_t>(revision))
+        .Field("bytes", static_cast<int64_t>(bytes->size()))
+        .EndObject();
+    return ToQString(out);
+}
+
+qint64 JsBridge::treeRevision() {
+    return static_cast<qint64>(clan::core::DatabaseManager::instance().GetTreeRevision());
+}
 
-        jsonArray.append(jobj);
+QString JsBridge::fetchTreeDelta(qint64 sinceRevision) {
+    auto delta = clan::core::DatabaseManager::instance().GetTreeDelta(
+        static_cast<uint64_t>(sinceRevision < 0 ? 0 : sinceRevision));
+
+    auto& out = ScratchWriter();
+    out.BeginObject()
+        .Field("revision", static_cast<int64_t>(delta.revision))
+        .Field("since", static_cast<int64_t>(sinceRevision))
+        .Field("resync", delta.full_resync)
+        .Key("changes")
+        .BeginArray();
+    for (const auto& change : delta.changes) {
+        out.BeginObject();
+        if (change.kind == clan::core::TreeChangeKind::kRemove) {
+            out.Field("op", "remove").Field("id", change.member.id);
+        } else {
+            out.Field("op", change.kind == clan::core::TreeChangeKind::kAdd ? "add" : "update");
+            out.Key("node").BeginObject();
+            WriteTreeNode(out, change.member);
+            out.EndObject();
+        }
+        out.EndObject();
     }
+    out.EndArray().EndObject();
+    return ToQString(out);
+}
 
-    QJsonDocument doc(jsonArray);
-    return doc.toJson(QJsonDocument::Compact);
+QString JsBridge::fetchSubtree(const QString& rootId, int depth, int limit) {
+    qint64 revision = treeRevision();
+    auto page = clan::core::DatabaseManager::instance().GetSubtree(
+        rootId.toStdString(), depth, PageLimit(limit));
+    return TreePageToJson(revision, page);
+}
+
+QString JsBridge::fetchTreeChildren(const QString& memberId, int offset, int limit) {
+    qint64 revision = treeRevision();
+    auto page = clan::core::DatabaseManager::instance().GetChildPage(
+        memberId.toStdString(), static_cast<size_t>(qMax(offset, 0)), PageLimit(limit));
+    return TreePageToJson(revision, page);
+}
+
+QString JsBridge::fetchGenerations(int minGeneration, int maxGeneration, int offset,
+                                   int limit) {
+    qint64 revision = treeRevision();
+    auto page = clan::core::DatabaseManager::instance().GetGenerationRange(
+        minGeneration, maxGeneration, static_cast<size_t>(qMax(offset, 0)), PageLimit(limit));
+    return TreePageToJson(revision, page);
 }
 
 QString JsBridge::fetchMemberDetail(const QString& id) {
@@ -88,7 +201,7 @@ QString JsBridge::fetchMemberDetail(const QString& id) {
     return doc.toJson(QJsonDocument::Compact);
 }
 
-QString JsBridge::getLocalImage(const QString& filePath) {
+QString JsBridge::getLocalImage(const QString& filePath, int size) {
     if (filePath.isEmpty() || filePath.startsWith("http")) {
         return "";
     }
@@ -103,28 +216,45 @@ QString JsBridge::getLocalImage(const QString& filePath) {
         realPath = QString::fromStdString(absPath.string());
     }
 
-    QFileInfo finalInfo(realPath);
-    if (!finalInfo.exists()) {
-        qWarning() << "[JsBridge] Image file not found:" << realPath;
-        return "";
+    if (size <= 0) {
+        size = clan::core::ThumbnailCache::kSizes.back();
     }
 
-    QImage image(realPath);
-    if (image.isNull()) {
+    // Served by URL when the media server runs: no payload through executeJavascript,
+    // and the web view caches the image (revalidated by ETag).
+    std::string url =
+        clan::core::MediaServer::instance().ThumbnailUrl(realPath.toStdString(), size);
+    if (!url.empty()) {
+        return QString::fromStdString(url);
+    }
+
+    // Decoded and scaled once per file version and size tier; later calls are served from
+    // the thumbnail cache without touching QImage.
+    auto png = clan::core::ThumbnailCache::instance().Get(
+        std::filesystem::path(realPath.toStdU16String()), size, &JsBridge::encodeThumbnail);
+    if (!png) {
+        qWarning() << "[JsBridge] Image file not found or unreadable:" << realPath;
         return "";
     }
 
-    if (image.width() > 500) {
-        image = image.scaledToWidth(500, Qt::SmoothTransformation);
+    QByteArray bytes = QByteArray::fromRawData(png->data(), static_cast<qsizetype>(png->size()));
+    return QString("data:image/png;base64,%1").arg(QString::fromLatin1(bytes.toBase64()));
+}
+
+std::string JsBridge::encodeThumbnail(const std::filesystem::path& source, int width) {
+    QImage image(QString::fromStdU16String(source.u16string()));
+    if (image.isNull()) {
+        return std::string();
+    }
+    if (image.width() > width) {
+        image = image.scaledToWidth(width, Qt::SmoothTransformation);
     }
 
     QByteArray byteArray;
     QBuffer buffer(&byteArray);
     buffer.open(QIODevice::WriteOnly);
     image.save(&buffer, "PNG");
-    QString base64 = byteArray.toBase64();
-
-    return QString("data:image/png;base64,%1").arg(base64);
+    return byteArray.toStdString();
 }
 
 QString JsBridge::searchMembers(const QString& keyword) {
@@ -136,39 +266,20 @@ QString JsBridge::searchMembers(const QString& keyword) {
         LOGINFO("[JsBridge] Search keyword: {}", keyword.toStdString());
 
         auto& db = clan::core::DatabaseManager::instance();
-        // This relies on SQL LIKE query now, so it should be robust
+        // Ranked FTS5 search (LIKE fallback), capped at the default result limit
         auto results = db.SearchMembers(keyword.toStdString());
 
         LOGINFO("[JsBridge] Search returned {} results", results.size());
 
-        QJsonArray jsonArray;
+        auto& out = ScratchWriter();
+        out.BeginArray();
         for (const auto& m : results) {
-            QJsonObject jobj;
-            try {
-                jobj["id"] = QString::fromStdString(m.id);
-                jobj["name"] = QString::fromStdString(m.name);
-                jobj["generation"] = m.generation;
-                jobj["generationName"] = QString::fromStdString(m.generation_name);
-                jobj["parentId"] = QString::fromStdString(m.father_id);
-                jobj["fatherName"] = QString::fromStdString(m.father_name);
-                jobj["spouseName"] = QString::fromStdString(m.spouse_name);
-                // Ensure aliases is valid (handle nulls if any sneak in)
-                jobj["aliases"] = QString::fromStdString(m.aliases);
-
-                QString bio = QString::fromStdString(m.bio);
-                if (bio.length() > 50) {
-                    bio = bio.left(50) + "...";
-                }
-                jobj["bioSnippet"] = bio;
-                jsonArray.append(jobj);
-            } catch (std::exception& ex) {
-                LOGERROR("[JsBridge] Serialization error for member {}: {}", m.id, ex.what());
-                continue;  // Skip bad member
-            }
+            out.BeginObject();
+            clan::core::WriteSearchHitFields(out, m);
+            out.EndObject();
         }
-
-        QJsonDocument doc(jsonArray);
-        return doc.toJson(QJsonDocument::Compact);
+        out.EndArray();
+        return ToQString(out);
 
     } catch (std::exception& e) {
         LOGERROR("[JsBridge] Search fatal error: {}", e.what());
@@ -183,10 +294,37 @@ QString JsBridge::searchMembers(const QString& keyword) {
     }
 }
 
+namespace {
+// Operation-log details of a media import: what it cost and how the files were stored
+std::string IngestLogChanges(size_t files, uint64_t bytes, int64_t elapsedMs,
+                             const std::map<clan::core::IngestMethod, size_t>& methods,
+                             size_t deduplicated) {
+    clan::core::JsonWriter out(256);
+    out.BeginObject()
+        .Field("files", static_cast<int64_t>(files))
+        .Field("bytes", static_cast<int64_t>(bytes))
+        .Field("ms", elapsedMs)
+        .Key("methods")
+        .BeginObject();
+    for (const auto& [method, count] : methods) {
+        out.Field(clan::core::IngestMethodName(method), static_cast<int64_t>(count));
+    }
+    out.EndObject().Field("deduplicated", static_cast<int64_t>(deduplicated)).EndObject();
+    return out.str();
+}
+}  // namespace
+
 QString JsBridge::importResource(const QString& memberId, const QString& type) {
     if (memberId.isEmpty())
         return "{\"error\": \"No member ID\"}";
 
+    QString filePath = selectResourceFile(type);
+    if (filePath.isEmpty())
+        return "{\"status\": \"cancelled\"}";
+    return importResourceFile(memberId, type, filePath);
+}
+
+QString JsBridge::selectResourceFile(const QString& type) {
     QString filter;
     if (type == "video")
         filter = "Videos (*.mp4 *.avi *.mov *.mkv *.webm)";
@@ -195,18 +333,26 @@ QString JsBridge::importResource(const QString& memberId, const QString& type) {
     else if (type == "audio")
         filter = "Audio (*.mp3 *.wav *.aac)";
 
-    QString filePath = QFileDialog::getOpenFileName(
-        nullptr, QString("Select %1 for Import").arg(type), QDir::homePath(), filter);
+    return QFileDialog::getOpenFileName(nullptr, QString("Select %1 for Import").arg(type),
+                                        QDir::homePath(), filter);
+}
 
-    if (filePath.isEmpty())
-        return "{\"status\": \"cancelled\"}";
+QString JsBridge::importResourceFile(const QString& memberId, const QString& type,
+                                     const QString& filePath) {
+    if (memberId.isEmpty())
+        return "{\"error\": \"No member ID\"}";
 
+    clan::core::MediaIngest ingest;
     auto res = clan::core::ResourceManager::instance().ImportFile(
-        filePath.toStdString(), memberId.toStdString(), type.toStdString());
+        filePath.toStdString(), memberId.toStdString(), type.toStdString(), &ingest);
 
     if (res.id.empty()) {
         return "{\"error\": \"Import failed\"}";
     }
+    clan::core::DatabaseManager::instance().AddOperationLog(
+        "IMPORT", "media", res.id, res.title,
+        IngestLogChanges(1, ingest.bytes, ingest.elapsed_ms, {{ingest.method, 1}},
+                         ingest.deduplicated ? 1 : 0));
 
     QJsonObject jobj;
     jobj["id"] = QString::fromStdString(res.id);
@@ -221,6 +367,14 @@ QString JsBridge::importMultipleResources(const QString& memberId, const QString
     if (memberId.isEmpty())
         return "{\"error\": \"No member ID\"}";
 
+    QStringList filePaths = selectResourceFiles(type);
+    if (filePaths.isEmpty())
+        return "{\"status\": \"cancelled\", \"count\": 0}";
+
+    return importResourceFiles(memberId, type, filePaths);
+}
+
+QStringList JsBridge::selectResourceFiles(const QString& type) {
     QString filter;
     if (type == "video")
         filter = "Videos (*.mp4 *.avi *.mov *.mkv *.webm)";
@@ -230,48 +384,80 @@ QString JsBridge::importMultipleResources(const QString& memberId, const QString
         filter = "Audio (*.mp3 *.wav *.aac *.m4a *.flac)";
 
     // Use getOpenFileNames for multi-select
-    QStringList filePaths = QFileDialog::getOpenFileNames(
+    return QFileDialog::getOpenFileNames(
         nullptr, QString("Select %1 files (multi-select)").arg(type), QDir::homePath(), filter);
+}
 
-    if (filePaths.isEmpty())
-        return "{\"status\": \"cancelled\", \"count\": 0}";
+QString JsBridge::importResourceFiles(const QString& memberId, const QString& type,
+                                      const QStringList& filePaths,
+                                      const ResourceImportProgressCallback& onProgress) {
+    if (memberId.isEmpty())
+        return "{\"error\": \"No member ID\"}";
+
+    std::vector<std::string> paths;
+    paths.reserve(filePaths.size());
+    for (const QString& filePath : filePaths) {
+        paths.push_back(filePath.toStdString());
+    }
+
+    clan::core::MediaImportOptions options;
+    if (type == "photo") {
+        // Build the strip thumbnail while the file is still in the page cache, so the
+        // refreshed list shows it without an encode per image
+        options.after_copy = [](const clan::core::MediaResource&,
+                                const std::filesystem::path& stored) {
+            std::error_code ec;
+            auto source = std::filesystem::weakly_canonical(stored, ec);
+            clan::core::ThumbnailCache::instance().Get(ec ? stored : source, kStripThumbnailSize,
+                                                       &JsBridge::encodeThumbnail);
+        };
+    }
+
+    auto result = clan::core::ResourceManager::instance().ImportFiles(
+        paths, memberId.toStdString(), type.toStdString(),
+        [&](const clan::core::MediaImportProgress& p) {
+            if (onProgress) {
+                onProgress(p.done, p.total, p.ok);
+            }
+        },
+        options);
+
+    if (!result.imported.empty()) {
+        clan::core::DatabaseManager::instance().AddOperationLog(
+            "IMPORT", "media", memberId.toStdString(),
+            std::to_string(result.imported.size()) + " " + type.toStdString() + " file(s)",
+            IngestLogChanges(result.imported.size(), result.bytes, result.elapsed_ms,
+                             result.methods, result.deduplicated));
+    }
 
     QJsonArray successArray;
+    for (const auto& res : result.imported) {
+        QJsonObject jobj;
+        jobj["id"] = QString::fromStdString(res.id);
+        jobj["title"] = QString::fromStdString(res.title);
+        jobj["filePath"] = QString::fromStdString(res.file_path);
+        successArray.append(jobj);
+    }
     QJsonArray errorArray;
-    int imported = 0;
-    int failed = 0;
-
-    for (const QString& filePath : filePaths) {
-        auto res = clan::core::ResourceManager::instance().ImportFile(
-            filePath.toStdString(), memberId.toStdString(), type.toStdString());
-
-        if (!res.id.empty()) {
-            QJsonObject jobj;
-            jobj["id"] = QString::fromStdString(res.id);
-            jobj["title"] = QString::fromStdString(res.title);
-            jobj["filePath"] = QString::fromStdString(res.file_path);
-            successArray.append(jobj);
-            imported++;
-        } else {
-            QJsonObject errObj;
-            errObj["file"] = QFileInfo(filePath).fileName();
-            errObj["error"] = "Import failed";
-            errorArray.append(errObj);
-            failed++;
-        }
+    for (const auto& failure : result.failed) {
+        QJsonObject errObj;
+        errObj["file"] = QFileInfo(QString::fromStdString(failure.file)).fileName();
+        errObj["error"] = QString::fromStdString(failure.error);
+        errorArray.append(errObj);
     }
 
-    QJsonObject result;
-    result["status"] = "completed";
-    result["imported"] = imported;
-    result["failed"] = failed;
-    result["total"] = filePaths.size();
-    result["resources"] = successArray;
+    QJsonObject jsonResult;
+    jsonResult["status"] = "completed";
+    jsonResult["imported"] = static_cast<int>(result.imported.size());
+    jsonResult["failed"] = static_cast<int>(result.failed.size());
+    jsonResult["total"] = filePaths.size();
+    jsonResult["elapsedMs"] = static_cast<qint64>(result.elapsed_ms);
+    jsonResult["resources"] = successArray;
     if (!errorArray.isEmpty()) {
-        result["errors"] = errorArray;
+        jsonResult["errors"] = errorArray;
     }
 
-    QJsonDocument doc(result);
+    QJsonDocument doc(jsonResult);
     return doc.toJson(QJsonDocument::Compact);
 }
 
@@ -281,28 +467,32 @@ QString JsBridge::fetchMemberResources(const QString& memberId, const QString& t
 
     auto& paths = clan::core::PathManager::instance();
     std::filesystem::path mediaDir = paths.resources_dir();
+    auto& media = clan::core::MediaServer::instance();
 
-    QJsonArray jsonArray;
+    auto& out = ScratchWriter();
+    out.BeginArray();
     for (const auto& r : list) {
-        QJsonObject jobj;
-        jobj["id"] = QString::fromStdString(r.id);
-        jobj["title"] = QString::fromStdString(r.title);
-        jobj["description"] = QString::fromStdString(r.description);
-
-        std::filesystem::path absPath = mediaDir / r.file_path;
-        QString url = QUrl::fromLocalFile(QString::fromStdString(absPath.string())).toString();
-
-        // [Added] Debug Log for URL
-        qDebug() << "[JsBridge] Generated Media URL:" << url;
-
-        jobj["url"] = url;
-        jobj["type"] = QString::fromStdString(r.resource_type);
+        // Loopback URL (Range/ETag aware) when available, file URL otherwise
+        std::string url = media.MediaUrl(r.file_path);
+        if (url.empty()) {
+            std::filesystem::path absPath = mediaDir / r.file_path;
+            url = QUrl::fromLocalFile(QString::fromStdString(absPath.string()))
+                      .toString()
+                      .toStdString();
+        }
 
-        jsonArray.append(jobj);
+        out.BeginObject();
+        clan::core::WriteMediaResourceFields(out, r, url);
+        if (r.resource_type == "photo") {
+            std::string thumb = media.ThumbnailUrl(r.file_path, kStripThumbnailSize);
+            if (!thumb.empty()) {
+                out.Field("thumbUrl", thumb);
+            }
+        }
+        out.EndObject();
     }
-
-    QJsonDocument doc(jsonArray);
-    return doc.toJson(QJsonDocument::Compact);
+    out.EndArray();
+    return ToQString(out);
 }
 QString JsBridge::deleteMediaResource(const QString& resourceId) {
     if (resourceId.isEmpty()) {
@@ -344,10 +534,16 @@ void JsBridge::updateMemberPortrait(const QString& memberId) {
 
     // 2. 更新数据库
     // 注意：DatabaseManager 需要支持 UpdateMemberPortrait 方法
-    bool success = clan::core::DatabaseManager::instance().UpdateMemberPortrait(
-        memberId.toStdString(), fileName.toStdString());
+    auto& db = clan::core::DatabaseManager::instance();
+    auto before = db.GetMemberById(memberId.toStdString());
+    bool success = db.UpdateMemberPortrait(memberId.toStdString(), fileName.toStdString());
 
     if (success) {
+        auto after = before;
+        after.portrait_path = fileName.toStdString();
+        db.AddOperationLog("UPDATE", "member", before.id, before.name,
+                           clan::core::EncodeMemberDiff(clan::core::DiffMembers(before, after)));
+
         qDebug() << "Portrait updated for member:" << memberId << "Path:" << fileName;
 
         // 3. 关键步骤：主动刷新前端的成员详情
@@ -390,15 +586,17 @@ QString JsBridge::saveMember(const QString& memberJson) {
         m.id = QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
     }
 
-    // Determine if this is create or update
-    bool isNew = obj["isNew"].toBool(false);
-    std::string action = isNew ? "CREATE" : "UPDATE";
-
     try {
+        // Create or update follows the stored record (the client's isNew flag can be stale),
+        // and the log keeps only the changed fields
+        auto before = db.GetMemberById(m.id);
+        std::string action = before.id.empty() ? "CREATE" : "UPDATE";
         db.SaveMember(m);
 
-        // Log the operation
-        db.AddOperationLog(action, "member", m.id, m.name, memberJson.toStdString());
+        auto diff = clan::core::DiffMembers(before, m);
+        if (!diff.empty()) {
+            db.AddOperationLog(action, "member", m.id, m.name, clan::core::EncodeMemberDiff(diff));
+        }
 
         QJsonObject result;
         result["success"] = true;
@@ -425,15 +623,15 @@ QString JsBridge::deleteMember(const QString& memberId) {
         return QJsonDocument(result).toJson(QJsonDocument::Compact);
     }
 
-    // Get member name for logging
+    // The log keeps the deleted record, so it can be restored
     auto member = db.GetMemberById(memberId.toStdString());
-    std::string memberName = member.name;
 
     bool success = db.DeleteMember(memberId.toStdString());
 
     if (success) {
-        // Log the operation
-        db.AddOperationLog("DELETE", "member", memberId.toStdString(), memberName, "");
+        db.AddOperationLog(
+            "DELETE", "member", memberId.toStdString(), member.name,
+            clan::core::EncodeMemberDiff(clan::core::DiffMembers(member, clan::core::Member{})));
     }
 
     QJsonObject result;
@@ -468,20 +666,87 @@ QString JsBridge::getOperationLogs(int limit, int offset) {
     auto& db = clan::core::DatabaseManager::instance();
     auto logs = db.GetOperationLogs(limit, offset);
 
-    QJsonArray jsonArray;
+    auto& out = ScratchWriter();
+    out.BeginArray();
     for (const auto& log : logs) {
-        QJsonObject obj;
-        obj["id"] = log.id;
-        obj["action"] = QString::fromStdString(log.action);
-        obj["targetType"] = QString::fromStdString(log.target_type);
-        obj["targetId"] = QString::fromStdString(log.target_id);
-        obj["targetName"] = QString::fromStdString(log.target_name);
-        obj["changes"] = QString::fromStdString(log.changes);
-        obj["createdAt"] = static_cast<qint64>(log.created_at);
-        jsonArray.append(obj);
-    }
-
-    return QJsonDocument(jsonArray).toJson(QJsonDocument::Compact);
+        out.BeginObject();
+        clan::core::WriteOperationLogFields(out, log);
+        out.EndObject();
+    }
+    out.EndArray();
+    return ToQString(out);
+}
+
+QString JsBridge::queryOperationLogs(const QString& queryJson) {
+    auto& db = clan::core::DatabaseManager::instance();
+    QJsonObject obj = QJsonDocument::fromJson(queryJson.toUtf8()).object();
+
+    clan::core::OperationLogQuery query;
+    query.action = obj["action"].toString().toStdString();
+    query.target_type = obj["targetType"].toString().toStdString();
+    query.target_id = obj["targetId"].toString().toStdString();
+    query.since = obj["since"].toInteger();
+    query.until = obj["until"].toInteger();
+    query.limit = qBound(1, obj["limit"].toInt(100), 1000);
+    query.archived = obj["archived"].toBool();
+    QJsonObject before = obj["before"].toObject();
+    query.cursor_created_at = before["createdAt"].toInteger();
+    query.cursor_id = before["id"].toInteger();
+
+    auto page = db.QueryOperationLogs(query);
+
+    auto& out = ScratchWriter();
+    out.BeginObject();
+    out.Key("logs").BeginArray();
+    for (const auto& log : page.logs) {
+        out.BeginObject();
+        clan::core::WriteOperationLogFields(out, log);
+        out.EndObject();
+    }
+    out.EndArray();
+    out.Field("hasMore", page.has_more);
+    if (query.cursor_id == 0) {
+        auto total = db.CountOperationLogs(query);
+        out.Field("total", total.count);
+        out.Field("totalExact", total.exact);
+    }
+    out.EndObject();
+    return ToQString(out);
+}
+
+QString JsBridge::importMembers(const QString& filePath,
+                                const ImportProgressCallback& onProgress) {
+    auto& db = clan::core::DatabaseManager::instance();
+
+    QJsonObject result;
+    try {
+        auto source = clan::core::OpenMemberSource(filePath.toStdString());
+        auto imported = db.ImportMembers(*source, [&](const clan::core::ImportProgress& p) {
+            if (onProgress)
+                onProgress(p.rows, p.indexing);
+        });
+
+        result["success"] = imported.ok;
+        result["imported"] = static_cast<qint64>(imported.imported);
+        result["matched"] = static_cast<qint64>(imported.matched);
+        result["skipped"] = static_cast<qint64>(imported.skipped);
+        result["unresolvedFathers"] = static_cast<qint64>(imported.unresolved_fathers);
+        result["elapsedMs"] = imported.elapsed_ms;
+        if (!imported.ok) {
+            result["error"] = QString::fromStdString(imported.error);
+        } else {
+            db.AddOperationLog("IMPORT", "member", "", QFileInfo(filePath).fileName().toStdString(),
+                               QString("%1 imported, %2 skipped")
+                                   .arg(imported.imported)
+                                   .arg(imported.skipped)
+                                   .toStdString());
+        }
+    } catch (std::exception& e) {
+        // Unreadable file or unsupported format
+        result["success"] = false;
+        result["error"] = QString::fromStdString(e.what());
+    }
+    return QJsonDocument(result).toJson(QJsonDocument::Compact);
 }
 
 QString JsBridge::selectFile(const QString& filter) {
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
+
+#include <filesystem>
+#include <functional>
+#include <string>
 
 class JsBridge : public QObject {
     Q_OBJECT
@@ -10,8 +15,22 @@ public:
 public slots:
     Q_INVOKABLE void test(const QString& message);
     Q_INVOKABLE QString fetchFamilyTree();
+    // fetchFamilyTree as a binary snapshot (core/json/tree_snapshot.h) published on the
+    // MediaServer: {"url", "revision", "bytes"}; url is empty when the server is not running
+    Q_INVOKABLE QString fetchTreeSnapshot();
+    // Incremental tree updates: current revision and the changes since a revision
+    Q_INVOKABLE qint64 treeRevision();
+    Q_INVOKABLE QString fetchTreeDelta(qint64 sinceRevision);
+    // Paged tree for large clans: {"revision", "nodes", "hasMore"}, each node with its
+    // childCount. limit <= 0 means unlimited; an empty rootId starts from the roots.
+    Q_INVOKABLE QString fetchSubtree(const QString& rootId, int depth, int limit);
+    Q_INVOKABLE QString fetchTreeChildren(const QString& memberId, int offset, int limit);
+    Q_INVOKABLE QString fetchGenerations(int minGeneration, int maxGeneration, int offset,
+                                         int limit);
     Q_INVOKABLE QString fetchMemberDetail(const QString& id);
-    Q_INVOKABLE QString getLocalImage(const QString& filePath);
+    // URL of a thumbnail at most `size` pixels wide (rounded up to a cache tier): served by
+    // the loopback MediaServer, or a data URL when it is not running
+    Q_INVOKABLE QString getLocalImage(const QString& filePath, int size = 500);
     Q_INVOKABLE QString searchMembers(const QString& keyword);
     Q_INVOKABLE QString importResource(const QString& memberId, const QString& type);
     Q_INVOKABLE QString fetchMemberResources(const QString& memberId, const QString& type);
@@ -24,8 +43,44 @@ public slots:
     Q_INVOKABLE QString getSettings(const QString& key);
     Q_INVOKABLE void saveSettings(const QString& key, const QString& value);
     Q_INVOKABLE QString getOperationLogs(int limit, int offset);
+    // Filtered keyset page of the operation logs. queryJson: {"action", "targetType",
+    // "targetId", "since", "until", "before": {"createdAt", "id"}, "limit", "archived"}, all
+    // optional; "before" is the last entry of the previous page. Returns {"logs",
+    // "hasMore", "total", "totalExact"}; total is only sent with the first page.
+    Q_INVOKABLE QString queryOperationLogs(const QString& queryJson);
     Q_INVOKABLE QString selectFile(const QString& filter);
 
     Q_INVOKABLE QString importMultipleResources(const QString& memberId,
                                                 const QString& type);  // Batch import
+
+public:
+    // PNG thumbnail at most `width` pixels wide (ThumbnailCache encoder); any thread
+    static std::string encodeThumbnail(const std::filesystem::path& source, int width);
+
+    // Width of the photo strip thumbnails (thumbUrl in fetchMemberResources)
+    static constexpr int kStripThumbnailSize = 128;
+
+    // importResource in two steps, like importResourceFiles below: the native file dialog
+    // (UI thread only) and the copy of the chosen file (any thread).
+    QString selectResourceFile(const QString& type);
+    QString importResourceFile(const QString& memberId,
+                               const QString& type,
+                               const QString& filePath);
+
+    // importMultipleResources in two steps, so that the copy can run off the UI thread:
+    // the native multi-select dialog (UI thread only) and the import of the chosen files.
+    // The import runs on the TaskManager pipeline (ResourceManager::ImportFiles); onProgress
+    // is called once per file on the calling thread.
+    using ResourceImportProgressCallback =
+        std::function<void(qulonglong done, qulonglong total, bool ok)>;
+    QStringList selectResourceFiles(const QString& type);
+    QString importResourceFiles(const QString& memberId,
+                                const QString& type,
+                                const QStringList& filePaths,
+                                const ResourceImportProgressCallback& onProgress = {});
+
+    // Bulk member import from a .csv or .ged file; blocks for the whole import, so call it
+    // off the UI thread. onProgress runs on the calling thread.
+    using ImportProgressCallback = std::function<void(qulonglong rows, bool indexing)>;
+    QString importMembers(const QString& filePath, const ImportProgressCallback& onProgress);
 };
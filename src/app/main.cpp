@@ -1,4 +1,3 @@
-#include <chrono>
 #include <iostream>
 #include <thread>
 
@@ -16,9 +15,11 @@
 #include "core/crash/crashpad_handler.h"
 #include "core/db/database_manager.h"
 #include "core/log/log.h"
+#include "core/network/media_server.h"
 #include "core/network/network_manager.h"
 #include "core/platform/path_manager.h"
 #include "core/task/task_manager.h"
+#include "js_bridge.h"
 #include "mainwindow.h"
 #include "shared/Constants.h"
 #include "version.h"
@@ -46,20 +47,6 @@ void listResources(const QString& path) {
     }
 }
 
-void benchmark(const std::string& mode_desc, int N) {
-    using namespace std::chrono;
-    std::cout << "Starting test: " << mode_desc << std::endl;
-    int x{8};
-    auto start = high_resolution_clock::now();
-    for (int i = 0; i < N; ++i) {
-        LOGINFO("Log message number {}", i);
-        LOGTRACE("Log message number {}", i);
-    }
-    auto end = high_resolution_clock::now();
-    auto dur_ms = duration_cast<milliseconds>(end - start).count();
-    std::cout << "Finished " << N << " logs in " << dur_ms << "ms" << std::endl;
-}
-
 void setup_crashpad() {
     auto& paths = clan::core::PathManager::instance();
     namespace fs = std::filesystem;
@@ -163,7 +150,6 @@ int main(int argc, char* argv[]) {
     auto& paths = clan::core::PathManager::instance();
     clan::core::ConfigManager::instance().load(paths.config_dir().string());
 
-    const int log_count = 1132;
     // clang-format off
     clan::core::Log::instance().init({
         .use_async = true,
@@ -176,8 +162,6 @@ int main(int argc, char* argv[]) {
 
     clan::core::Log::instance().set_level(spdlog::level::trace);
 
-    // benchmark("vim-commentarySync + Rotating", log_count);
-
     clan::core::ConfigManager::instance().load((paths.config_dir() / "settings.ini").string());
 
     // 使用版本信息
@@ -252,6 +236,9 @@ int main(int argc, char* argv[]) {
     auto& db = clan::core::DatabaseManager::instance();
     db.Initialize(dbPath.toStdString());
 
+    // 3. 本地媒体服务：缩略图和音视频以 http://127.0.0.1 URL 的形式提供给 Web 前端
+    clan::core::MediaServer::instance().Start(paths.resources_dir(), &JsBridge::encodeThumbnail);
+
     // // 3. 插入丰富的产品级数据
     // // 注意：SaveMember 会自动处理更新，所以每次运行都不会重复插入
 
@@ -346,6 +333,8 @@ int main(int argc, char* argv[]) {
         Logger::instance().log("Main window shown.");
         result = a.exec();
     }
+    clan::core::MediaServer::instance().Stop();
+    clan::core::DatabaseManager::instance().FlushOperationLogs();
     clan::core::Log::instance().deinit();
     return result;
 }
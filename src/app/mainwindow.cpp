@@ -4,8 +4,12 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QDockWidget>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
 #include <QPushButton>
+#include <QSet>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QQuickView>
@@ -14,13 +18,35 @@
 #include <QVBoxLayout>
 #include <qlogging.h>
 
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#include "bridge_dispatcher.h"
 #include "core/Logger.h"
 #include "core/log/log.h"
 #include "core/platform/path_manager.h"
+#include "core/task/task_manager.h"
 #include "js_bridge.h"
 #include "ui_mainwindow.h"
 #include "widgets/LogViewer.h"  // from gui-widgets
 
+namespace {
+// JS that calls window.<callback>(<args>[, "<requestId>"]) if the page defines it. The
+// request id is only appended for calls made through the "request" envelope, so plain
+// callers see the same arguments as before.
+QString CallbackJs(const QString& callback, const QString& args, const QString& requestId) {
+    QString callArgs = args;
+    if (!requestId.isEmpty()) {
+        // JSON string literal, escaped by QJsonDocument: ["id"] -> "id"
+        QString quoted = QString::fromUtf8(
+            QJsonDocument(QJsonArray{requestId}).toJson(QJsonDocument::Compact));
+        callArgs += (args.isEmpty() ? "" : ", ") + quoted.mid(1, quoted.size() - 2);
+    }
+    return QString("if(window.%1) { window.%1(%2); }").arg(callback, callArgs);
+}
+}  // namespace
+
 void printf_resource_runtime() {
     // ---  ---
     qDebug() << "=========================================================";
@@ -61,6 +87,7 @@ MainWindow::MainWindow(QWidget* parent)
     // printf_resource_runtime();
 
     m_jsBridge = new JsBridge(this);
+    m_dispatcher = new BridgeDispatcher(this);
     embedCefView();
     // embedQmlView();
     Logger::instance().log("Main Window constructed and configured.");
@@ -194,8 +221,40 @@ void MainWindow::embedCefView() {
 }
 
 // web --call-- c++
+// invoke("request", requestId, method, ...args) is the same call as invoke(method, ...args),
+// but the answer carries requestId as the callback's last argument and the request can be
+// dropped with invoke("cancelRequest", requestId) until it is answered.
 void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameId& frameId,
                                 const QString& method, const QVariantList& arguments) {
+    if (method == "request") {
+        if (arguments.size() >= 2) {
+            handleBridgeCall(frameId, arguments.at(1).toString(), arguments.mid(2),
+                             arguments.at(0).toString());
+        }
+    } else if (method == "cancelRequest") {
+        if (!arguments.isEmpty()) {
+            m_dispatcher->cancel(arguments.first().toString());
+        }
+    } else {
+        handleBridgeCall(frameId, method, arguments, QString());
+    }
+}
+
+// Reads run on the TaskManager executor through m_dispatcher; writes and native dialogs
+// stay on the GUI thread, so a read issued after a write always sees it.
+void MainWindow::handleBridgeCall(const QCefFrameId& frameId, const QString& method,
+                                  const QVariantList& arguments, const QString& requestId) {
+    // GUI-thread writes would wait on the write connection a member import holds
+    static const QSet<QString> kWriteMethods = {
+        "saveMember",       "deleteMember", "updateMemberPortrait", "deleteMediaResource",
+        "importResource",   "saveSettings", "importMembers",
+    };
+    if (m_importingMembers && kWriteMethods.contains(method)) {
+        qInfo() << "[C++] Member import running; deferring" << method;
+        m_deferredWrites.append({frameId, method, arguments, requestId});
+        return;
+    }
+
     // 1. 既有的测试逻辑
     if (method == "test") {
         if (arguments.size() > 0) {
@@ -205,42 +264,81 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
     // 2. 【新增】核心业务：获取家谱数据
     else if (method == "fetchFamilyTree") {
         qInfo() << "[C++] Bridge: Received fetchFamilyTree request";
-
-        // A. 从数据库获取数据 (通过 JsBridge 封装)
-        // 这里的 jsonStr 格式如: [{"id":"1", "name":"爷爷", "parentId":""}, ...]
-        QString jsonStr = m_jsBridge->fetchFamilyTree();
-
-        // B. 构造回调 JS 代码
-        // 我们约定：前端必须挂载一个 window.onFamilyTreeDataReceived 函数来接收数据
-        // 注意：jsonStr 已经是合法的 JSON 字符串，直接拼接进 JS 代码中
-        // 为了防止 JSON 中有特殊字符导致 JS 语法错误，建议最好用 base64
-        // 传输，但为了演示简单，先直接拼。
-        QString jsCode =
-            QString(
-                "if(window.onFamilyTreeDataReceived) { window.onFamilyTreeDataReceived(%1); } else "
-                "{ console.warn('Frontend callback not found'); }")
-                .arg(jsonStr);
-
-        // C. 执行 JS，将数据“推”回前端
-        if (m_cefView) {
-            m_cefView->executeJavascript(frameId, jsCode, "");
-            qDebug() << "[C++] Data sent to frontend, length:" << jsonStr.length();
+        pushFamilyTree(frameId, requestId);
+    } else if (method == "fetchTreeSnapshot") {
+        // 二进制整树快照：字节经本地媒体服务下发，这里只回传 URL 与 revision
+        JsBridge* bridge = m_jsBridge;
+        m_dispatcher->post(
+            requestId, QString("tree:%1").arg(frameId),
+            [bridge] { return bridge->fetchTreeSnapshot(); },
+            [this, frameId, requestId](const QString& infoJson) {
+                QJsonObject info = QJsonDocument::fromJson(infoJson.toUtf8()).object();
+                if (!info["url"].toString().isEmpty()) {
+                    m_treeRevisions[frameId] = info["revision"].toInteger();
+                }
+                respond(frameId, "onTreeSnapshotReady", infoJson, requestId);
+            });
+    } else if (method == "fetchTreeDelta") {
+        // 前端主动增量拉取：参数为前端当前持有的 revision
+        qint64 since = arguments.isEmpty() ? -1 : arguments.first().toLongLong();
+        pushTreeDelta(frameId, since);
+    } else if (method == "fetchSubtree" || method == "fetchTreeChildren" ||
+               method == "fetchGenerations") {
+        // 分页家谱：只取视口需要的节点，大家族无需一次性下发全部成员
+        auto arg = [&arguments](int i, int fallback) {
+            return arguments.size() > i ? arguments.at(i).toInt() : fallback;
+        };
+        JsBridge* bridge = m_jsBridge;
+        BridgeDispatcher::Work work;
+        QString channel;  // 子节点展开可以并发；视图级请求新的取代旧的
+        if (method == "fetchSubtree") {
+            QString rootId = arguments.isEmpty() ? QString() : arguments.first().toString();
+            int depth = arg(1, 3);
+            int limit = arg(2, 2000);
+            work = [bridge, rootId, depth, limit] {
+                return bridge->fetchSubtree(rootId, depth, limit);
+            };
+            channel = QString("subtree:%1").arg(frameId);
+        } else if (method == "fetchTreeChildren") {
+            QString memberId = arguments.isEmpty() ? QString() : arguments.first().toString();
+            int offset = arg(1, 0);
+            int limit = arg(2, 500);
+            work = [bridge, memberId, offset, limit] {
+                return bridge->fetchTreeChildren(memberId, offset, limit);
+            };
+        } else {
+            int minGeneration = arg(0, 1);
+            int maxGeneration = arg(1, minGeneration);
+            int offset = arg(2, 0);
+            int limit = arg(3, 2000);
+            work = [bridge, minGeneration, maxGeneration, offset, limit] {
+                return bridge->fetchGenerations(minGeneration, maxGeneration, offset, limit);
+            };
+            channel = QString("generations:%1").arg(frameId);
         }
+        m_dispatcher->post(
+            requestId, channel, std::move(work),
+            [this, frameId, requestId](const QString& pageJson) {
+                // A frame that only holds pages still needs a base revision for deltas
+                if (!m_treeRevisions.contains(frameId)) {
+                    QJsonObject page = QJsonDocument::fromJson(pageJson.toUtf8()).object();
+                    m_treeRevisions[frameId] = page["revision"].toInteger();
+                }
+                respond(frameId, "onTreePageReceived", pageJson, requestId);
+            });
     } else if (method == "searchMembers") {
         if (!arguments.isEmpty()) {
             QString keyword = arguments.first().toString();
             // 搜索结果返回的是 JSON 数组字符串，例如 [{"id":"..."}, ...]
-            QString jsonResult = m_jsBridge->searchMembers(keyword);
-
-            // 拼接 JS 回调，同样以对象字面量形式传递
-            QString jsCode =
-                QString(
-                    "if(window.onSearchResultsReceived) { window.onSearchResultsReceived(%1); }")
-                    .arg(jsonResult);
-
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, jsCode, "");
-            }
+            // 同一页面的新搜索会取消尚未返回的旧搜索
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString("search:%1").arg(frameId),
+                [bridge, keyword] { return bridge->searchMembers(keyword); },
+                [this, frameId, requestId](const QString& jsonResult) {
+                    // 拼接 JS 回调，同样以对象字面量形式传递
+                    respond(frameId, "onSearchResultsReceived", jsonResult, requestId);
+                });
         }
     } else if (method == "showMemberDetail") {
         // arguments[0] 是我们传过来的 ID
@@ -260,84 +358,198 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
             QString id = arguments.first().toString();
             qInfo() << "[C++] Fetching details for Member ID:" << id;
 
-            // 2. 调用 Bridge (逻辑封装在 Bridge 中)
-            QString jsonResult = m_jsBridge->fetchMemberDetail(id);
-
-            // 3. 回调前端
-            // 注意：如果 jsonResult 是 "null"，前端判断 member 为空显示“未找到”
-            QString jsCode =
-                QString("if(window.onMemberDetailReceived) { window.onMemberDetailReceived(%1); }")
-                    .arg(jsonResult);
-
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, jsCode, "");
-            }
+            // 2. 调用 Bridge (逻辑封装在 Bridge 中)；只有最后一次选中的成员会被回调
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString("detail:%1").arg(frameId),
+                [bridge, id] { return bridge->fetchMemberDetail(id); },
+                [this, frameId, requestId](const QString& jsonResult) {
+                    // 3. 回调前端
+                    // 注意：如果 jsonResult 是 "null"，前端判断 member 为空显示“未找到”
+                    respond(frameId, "onMemberDetailReceived", jsonResult, requestId);
+                });
         }
     }
 
     else if (method == "getLocalImage") {
         if (!arguments.isEmpty()) {
             QString path = arguments.first().toString();
-            // 调用 Bridge 读取并压缩图片
-            QString base64Data = m_jsBridge->getLocalImage(path);
-
-            // 回调前端：这里我们定义一个新的回调名 onLocalImageLoaded
-            // 为了区分是哪张图，我们把 path 也传回去，或者简单点，直接由前端 Promise 处理
-            // 这里演示简单的回调模式：
-            QString jsCode =
-                QString("if(window.onLocalImageLoaded) { window.onLocalImageLoaded('%1', '%2'); }")
-                    .arg(path.replace("\\", "\\\\"))  // 处理路径转义
-                    .arg(base64Data);
-
-            if (m_cefView)
-                m_cefView->executeJavascript(frameId, jsCode, "");
+            // 可选的第二个参数：缩略图宽度 (64 / 128 / 500)
+            int size = arguments.size() >= 2 ? arguments.at(1).toInt() : 500;
+            // 调用 Bridge 读取缩略图 (命中缓存时不解码；未命中时在工作线程中解码和缩放)
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString(),
+                [bridge, path, size] { return bridge->getLocalImage(path, size); },
+                [this, frameId, requestId, path](const QString& base64Data) {
+                    // 回调前端：这里我们定义一个新的回调名 onLocalImageLoaded
+                    // 为了区分是哪张图，我们把 path 也传回去，或者简单点，直接由前端 Promise 处理
+                    // 这里演示简单的回调模式：
+                    QString escapedPath = QString(path).replace("\\", "\\\\");  // 处理路径转义
+                    QString args = QString("'%1', '%2'").arg(escapedPath, base64Data);
+                    respond(frameId, "onLocalImageLoaded", args, requestId);
+                });
         }
     } else if (method == "importResource") {
         if (arguments.size() >= 2) {
             QString memberId = arguments.at(0).toString();
             QString type = arguments.at(1).toString();  // "video", "photo"
 
-            // 调用 Bridge (会阻塞 UI 直到文件选完并复制完，简单场景可接受)
-            QString jsonResult = m_jsBridge->importResource(memberId, type);
+            // 文件选择框在 UI 线程，复制文件在工作线程
+            QString filePath = m_jsBridge->selectResourceFile(type);
+            if (filePath.isEmpty()) {
+                respond(frameId, "onResourceImported", "{\"status\": \"cancelled\"}",
+                        requestId);
+                return;
+            }
 
-            // 回调前端刷新列表
-            QString jsCode =
-                QString("if(window.onResourceImported) { window.onResourceImported(%1); }")
-                    .arg(jsonResult);
-            if (m_cefView)
-                m_cefView->executeJavascript(frameId, jsCode, "");
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString(),
+                [bridge, memberId, type, filePath] {
+                    return bridge->importResourceFile(memberId, type, filePath);
+                },
+                [this, frameId, requestId](const QString& jsonResult) {
+                    // 回调前端刷新列表
+                    respond(frameId, "onResourceImported", jsonResult, requestId);
+                });
         }
     } else if (method == "importMultipleResources") {
         if (arguments.size() >= 2) {
             QString memberId = arguments.at(0).toString();
             QString type = arguments.at(1).toString();  // "video", "photo", "audio"
 
-            // 批量导入 - 调用支持多选的方法
-            QString jsonResult = m_jsBridge->importMultipleResources(memberId, type);
+            // 批量导入 - 文件选择框在 UI 线程，复制文件在工作线程
+            QStringList files = m_jsBridge->selectResourceFiles(type);
+            if (files.isEmpty()) {
+                respond(frameId, "onMultipleResourcesImported",
+                        "{\"status\": \"cancelled\", \"count\": 0}", requestId);
+                return;
+            }
 
-            // 回调前端刷新列表
-            QString jsCode = QString(
-                                 "if(window.onMultipleResourcesImported) { "
-                                 "window.onMultipleResourcesImported(%1); }")
-                                 .arg(jsonResult);
+            JsBridge* bridge = m_jsBridge;
+            QPointer<MainWindow> self(this);
+            m_dispatcher->post(
+                requestId, QString(),
+                [bridge, self, frameId, memberId, type, files] {
+                    // Per-file progress, at most every 100 ms (plus the last file)
+                    auto lastPush = std::chrono::steady_clock::time_point();
+                    auto onProgress = [&](qulonglong done, qulonglong total, bool) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (!self ||
+                            (done < total && now - lastPush < std::chrono::milliseconds(100)))
+                            return;
+                        lastPush = now;
+                        QMetaObject::invokeMethod(
+                            self.data(),
+                            [self, frameId, done, total] {
+                                if (!self || !self->m_cefView)
+                                    return;
+                                QString jsCode = QString(
+                                                     "if(window.onResourceImportProgress) { "
+                                                     "window.onResourceImportProgress({done: "
+                                                     "%1, total: %2}); }")
+                                                     .arg(done)
+                                                     .arg(total);
+                                self->m_cefView->executeJavascript(frameId, jsCode, "");
+                            },
+                            Qt::QueuedConnection);
+                    };
+                    return bridge->importResourceFiles(memberId, type, files, onProgress);
+                },
+                [this, frameId, requestId](const QString& jsonResult) {
+                    // 回调前端刷新列表
+                    respond(frameId, "onMultipleResourcesImported", jsonResult, requestId);
+                });
+        }
+    } else if (method == "importMembers") {
+        // 批量导入成员：可选参数为文件路径，否则弹出文件选择框
+        QString filePath = arguments.isEmpty() ? QString() : arguments.first().toString();
+        if (filePath.isEmpty()) {
+            filePath = m_jsBridge->selectFile("Genealogy (*.csv *.ged *.gedcom)");
+        }
+        if (filePath.isEmpty()) {
             if (m_cefView)
-                m_cefView->executeJavascript(frameId, jsCode, "");
+                m_cefView->executeJavascript(
+                    frameId,
+                    "if(window.onMembersImported) { "
+                    "window.onMembersImported({success: false, cancelled: true}); }",
+                    "");
+            return;
         }
+
+        // The import holds the write connection for its whole run; keep the UI thread free
+        // and hop back to it for every callback into the page.
+        QPointer<MainWindow> self(this);
+        auto runOnUi = [self](std::function<void(MainWindow*)> fn) {
+            if (!self)
+                return;
+            QMetaObject::invokeMethod(
+                self.data(),
+                [self, fn = std::move(fn)] {
+                    if (self && self->m_cefView)
+                        fn(self.data());
+                },
+                Qt::QueuedConnection);
+        };
+        m_importingMembers = true;
+        JsBridge* bridge = m_jsBridge;
+        clan::core::TaskManager::instance().enqueue([self, bridge, runOnUi, frameId, filePath] {
+            QString resultJson =
+                bridge->importMembers(filePath, [&](qulonglong rows, bool indexing) {
+                    runOnUi([frameId, rows, indexing](MainWindow* w) {
+                        QString jsCode = QString(
+                                             "if(window.onMembersImportProgress) { "
+                                             "window.onMembersImportProgress({rows: %1, "
+                                             "indexing: %2}); }")
+                                             .arg(rows)
+                                             .arg(indexing ? "true" : "false");
+                        w->m_cefView->executeJavascript(frameId, jsCode, "");
+                    });
+                });
+            if (!self)
+                return;
+            QMetaObject::invokeMethod(
+                self.data(),
+                [self, frameId, resultJson] {
+                    if (!self)
+                        return;
+                    if (self->m_cefView) {
+                        QString jsCode =
+                            QString(
+                                "if(window.onMembersImported) { window.onMembersImported(%1); }")
+                                .arg(resultJson);
+                        self->m_cefView->executeJavascript(frameId, jsCode, "");
+                        // The change feed restarts after a bulk import: the delta asks for
+                        // a resync
+                        self->pushTreeDelta(frameId);
+                    }
+                    // Replay writes held back during the import; a deferred importMembers
+                    // defers whatever follows it again
+                    self->m_importingMembers = false;
+                    const auto deferred = std::exchange(self->m_deferredWrites, {});
+                    for (const DeferredCall& call : deferred) {
+                        self->handleBridgeCall(call.frameId, call.method, call.arguments,
+                                               call.requestId);
+                    }
+                },
+                Qt::QueuedConnection);
+        });
     } else if (method == "fetchMemberResources") {
         if (arguments.size() >= 2) {
             QString memberId = arguments.at(0).toString();
             QString type = arguments.at(1).toString();
 
-            QString jsonResult = m_jsBridge->fetchMemberResources(memberId, type);
-
-            // 回调前端
-            QString jsCode = QString(
-                                 "if(window.onMemberResourcesReceived) { "
-                                 "window.onMemberResourcesReceived(%1, '%2'); }")
-                                 .arg(jsonResult)
-                                 .arg(type);  // 把 type 传回去方便前端判断
-            if (m_cefView)
-                m_cefView->executeJavascript(frameId, jsCode, "");
+            // 每种类型一个通道：切换成员时旧的请求被取消，三种类型的计数请求互不影响
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString("resources:%1:%2").arg(frameId).arg(type),
+                [bridge, memberId, type] { return bridge->fetchMemberResources(memberId, type); },
+                [this, frameId, requestId, type](const QString& jsonResult) {
+                    // 回调前端，把 type 传回去方便前端判断
+                    respond(frameId, "onMemberResourcesReceived",
+                            QString("%1, '%2'").arg(jsonResult, type), requestId);
+                });
         }
     } else if (method == "updateMemberPortrait") {
         if (!arguments.isEmpty()) {
@@ -357,17 +569,8 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
                 m_cefView->executeJavascript(frameId, detailJs, "");
             }
 
-            // 3. 立即刷新族谱树 (ClanTree) TODO 局部刷新
-            // 重新获取整个列表，并通过 onFamilyTreeDataReceived 推送给前端
-            // 这样 ClanTree 上的节点小头像也会变
-            QString treeJson = m_jsBridge->fetchFamilyTree();
-            QString treeJs =
-                QString(
-                    "if(window.onFamilyTreeDataReceived) { window.onFamilyTreeDataReceived(%1); }")
-                    .arg(treeJson);
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, treeJs, "");
-            }
+            // 3. 增量刷新族谱树 (ClanTree)：只推送变更的节点，节点小头像随之更新
+            pushTreeDelta(frameId);
 
             // 4. Notify frontend to re-focus on this member (important for tree focus after
             // refresh)
@@ -395,15 +598,8 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
                 m_cefView->executeJavascript(frameId, jsCode, "");
             }
 
-            // 刷新族谱树
-            QString treeJson = m_jsBridge->fetchFamilyTree();
-            QString treeJs =
-                QString(
-                    "if(window.onFamilyTreeDataReceived) { window.onFamilyTreeDataReceived(%1); }")
-                    .arg(treeJson);
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, treeJs, "");
-            }
+            // 增量刷新族谱树
+            pushTreeDelta(frameId);
         }
     } else if (method == "deleteMember") {
         if (!arguments.isEmpty()) {
@@ -419,15 +615,8 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
                 m_cefView->executeJavascript(frameId, jsCode, "");
             }
 
-            // 刷新族谱树
-            QString treeJson = m_jsBridge->fetchFamilyTree();
-            QString treeJs =
-                QString(
-                    "if(window.onFamilyTreeDataReceived) { window.onFamilyTreeDataReceived(%1); }")
-                    .arg(treeJson);
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, treeJs, "");
-            }
+            // 增量刷新族谱树
+            pushTreeDelta(frameId);
         }
     } else if (method == "deleteMediaResource") {
         if (!arguments.isEmpty()) {
@@ -447,15 +636,13 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
     } else if (method == "getSettings") {
         if (!arguments.isEmpty()) {
             QString key = arguments.first().toString();
-            QString resultJson = m_jsBridge->getSettings(key);
-
-            QString jsCode =
-                QString("if(window.onSettingsReceived) { window.onSettingsReceived('%1', %2); }")
-                    .arg(key)
-                    .arg(resultJson);
-            if (m_cefView) {
-                m_cefView->executeJavascript(frameId, jsCode, "");
-            }
+            JsBridge* bridge = m_jsBridge;
+            m_dispatcher->post(
+                requestId, QString(), [bridge, key] { return bridge->getSettings(key); },
+                [this, frameId, requestId, key](const QString& resultJson) {
+                    respond(frameId, "onSettingsReceived", QString("'%1', %2").arg(key, resultJson),
+                            requestId);
+                });
         }
     } else if (method == "saveSettings") {
         if (arguments.size() >= 2) {
@@ -473,14 +660,23 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
             offset = arguments.at(1).toInt();
         }
 
-        QString resultJson = m_jsBridge->getOperationLogs(limit, offset);
-
-        QString jsCode =
-            QString("if(window.onOperationLogsReceived) { window.onOperationLogsReceived(%1); }")
-                .arg(resultJson);
-        if (m_cefView) {
-            m_cefView->executeJavascript(frameId, jsCode, "");
-        }
+        JsBridge* bridge = m_jsBridge;
+        m_dispatcher->post(
+            requestId, QString("logs:%1").arg(frameId),
+            [bridge, limit, offset] { return bridge->getOperationLogs(limit, offset); },
+            [this, frameId, requestId](const QString& resultJson) {
+                respond(frameId, "onOperationLogsReceived", resultJson, requestId);
+            });
+    } else if (method == "queryOperationLogs") {
+        // 游标分页：翻到多深都只读一页；新的筛选取代旧的请求
+        QString queryJson = arguments.isEmpty() ? QString("{}") : arguments.first().toString();
+        JsBridge* bridge = m_jsBridge;
+        m_dispatcher->post(
+            requestId, QString("logs:%1").arg(frameId),
+            [bridge, queryJson] { return bridge->queryOperationLogs(queryJson); },
+            [this, frameId, requestId](const QString& resultJson) {
+                respond(frameId, "onOperationLogPageReceived", resultJson, requestId);
+            });
     } else if (method == "selectFile") {
         QString filter = "";
         if (!arguments.isEmpty()) {
@@ -497,3 +693,69 @@ void MainWindow::onInvokeMethod(const QCefBrowserId& browserId, const QCefFrameI
         }
     }
 }
+
+// Push the whole tree together with the revision it reflects. The snapshot is serialized
+// on the executor; a newer snapshot request for the same frame supersedes this one.
+void MainWindow::pushFamilyTree(const QCefFrameId& frameId, const QString& requestId) {
+    JsBridge* bridge = m_jsBridge;
+    auto revision = std::make_shared<qint64>(-1);  // written by the task, read on delivery
+    m_dispatcher->post(
+        requestId, QString("tree:%1").arg(frameId),
+        [bridge, revision] {
+            // Capture the revision first: a write racing the snapshot is then replayed by
+            // the next delta instead of being lost (add/update/remove are idempotent on the
+            // client).
+            *revision = bridge->treeRevision();
+            return bridge->fetchFamilyTree();
+        },
+        [this, frameId, requestId, revision](const QString& jsonStr) {
+            if (!m_cefView) {
+                return;
+            }
+            // 我们约定：前端必须挂载一个 window.onFamilyTreeDataReceived 函数来接收数据
+            QString jsCode =
+                CallbackJs("onFamilyTreeDataReceived",
+                           QString("%1, %2").arg(jsonStr, QString::number(*revision)), requestId) +
+                " else { console.warn('Frontend callback not found'); }";
+            m_cefView->executeJavascript(frameId, jsCode, "");
+            m_treeRevisions[frameId] = *revision;
+            qDebug() << "[C++] Tree sent to frontend, length:" << jsonStr.length()
+                     << "revision:" << *revision;
+        });
+}
+
+void MainWindow::respond(const QCefFrameId& frameId, const QString& callback,
+                         const QString& args, const QString& requestId) {
+    if (m_cefView) {
+        m_cefView->executeJavascript(frameId, CallbackJs(callback, args, requestId), "");
+    }
+}
+
+// Push only the nodes changed since the frame's last known revision.
+void MainWindow::pushTreeDelta(const QCefFrameId& frameId, qint64 sinceRevision) {
+    if (sinceRevision < 0) {
+        auto it = m_treeRevisions.constFind(frameId);
+        if (it == m_treeRevisions.constEnd()) {
+            pushFamilyTree(frameId);  // frame never received a snapshot
+            return;
+        }
+        sinceRevision = it.value();
+    }
+
+    QString deltaJson = m_jsBridge->fetchTreeDelta(sinceRevision);
+    QJsonObject delta = QJsonDocument::fromJson(deltaJson.toUtf8()).object();
+
+    // A resync delta is forwarded too: the frontend reloads whatever part of the tree it
+    // shows (a paged view must not be sent every member). Older frontends without the
+    // delta callback fall back to a full refetch.
+    QString jsCode = QString(
+                         "if(window.onFamilyTreeDeltaReceived) { "
+                         "window.onFamilyTreeDeltaReceived(%1); } "
+                         "else if(window.CallBridge) { "
+                         "window.CallBridge.invoke('fetchFamilyTree', 'resync'); }")
+                         .arg(deltaJson);
+    if (m_cefView) {
+        m_cefView->executeJavascript(frameId, jsCode, "");
+        m_treeRevisions[frameId] = delta["revision"].toInteger();
+    }
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <QHash>
+#include <QList>
 #include <QMainWindow>
 #include <QVariantList>
 #include "CefVersion.h"
@@ -15,6 +17,7 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+class BridgeDispatcher;
 class LogViewer;
 class JsBridge;
 class QCefView;
@@ -45,8 +48,32 @@ private:
     void setupMenus();
     void embedQmlView();
     void embedCefView();
+    void handleBridgeCall(const QCefFrameId& frameId,
+                          const QString& method,
+                          const QVariantList& arguments,
+                          const QString& requestId);
+    void respond(const QCefFrameId& frameId,
+                 const QString& callback,
+                 const QString& args,
+                 const QString& requestId);
+    void pushFamilyTree(const QCefFrameId& frameId, const QString& requestId = QString());
+    void pushTreeDelta(const QCefFrameId& frameId, qint64 sinceRevision = -1);
     Ui::MainWindow* ui;
     LogViewer* m_logViewer = nullptr;
     QCefView* m_cefView = nullptr;
     JsBridge* m_jsBridge = nullptr;
+    BridgeDispatcher* m_dispatcher = nullptr;  // runs bridge reads off the GUI thread
+    QHash<QCefFrameId, qint64> m_treeRevisions;  // last tree revision pushed per frame
+
+    // A member import holds the database write connection until it finishes. Writes the
+    // page sends meanwhile wait here instead of blocking the GUI thread, and run in order
+    // once the import is done.
+    struct DeferredCall {
+        QCefFrameId frameId;
+        QString method;
+        QVariantList arguments;
+        QString requestId;
+    };
+    bool m_importingMembers = false;
+    QList<DeferredCall> m_deferredWrites;
 };
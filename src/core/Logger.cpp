@@ -1,8 +1,9 @@
 #include "Logger.h"
 
-#include <QDateTime>
 #include <QDebug>
 
+#include "core/log/log.h"
+
 Logger& Logger::instance() {
     static Logger loggerInstance;
         return loggerInstance;
@@ -10,12 +11,11 @@ Logger& Logger::instance() {
 
 void Logger::log(const QString& message)
 {
-    QString timedMessage =
-        QString("[%1] %2")
-            .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"))
-            .arg(message);
-    qDebug().noquote() << timedMessage;
-    emit newMessage(timedMessage);
+    if (!clan::core::Log::instance().logger()) {
+        qDebug().noquote() << message;  // before Log::init
+        return;
+    }
+    LOGINFO("{}", message.toStdString());
 }
 
 void Logger::test() {
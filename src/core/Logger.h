@@ -2,14 +2,14 @@
 #include <QObject>
 #include <QString>
 
+// Qt-side entry point into the spdlog Log (core/log/log.h): messages go through the same
+// sinks as LOGINFO, so they reach the files and the LogViewer ring.
 class Logger : public QObject {
     Q_OBJECT
 public:
     static Logger& instance();
     void log(const QString& message);
     void test();
-signals:
-    void newMessage(const QString& message);
 
 private:
     Logger() = default;
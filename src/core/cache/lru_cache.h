@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace clan::core {
+
+// Thread-safe least-recently-used map bounded by a total cost. By default every entry
+// costs 1, so the capacity is an entry count; pass a cost function to bound bytes
+// instead. Values are copied out, so large payloads should be held by shared_ptr.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+  public:
+    using CostFn = std::function<size_t(const Value&)>;
+
+    explicit LruCache(size_t capacity, CostFn cost = {})
+        : capacity_(capacity),
+          cost_fn_(std::move(cost)) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // Returns the value and marks it most recently used.
+    std::optional<Value> Get(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    // Inserts or replaces, then evicts from the cold end until the budget holds. An entry
+    // costing more than the whole capacity is not stored.
+    void Put(const Key& key, Value value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t cost = cost_fn_ ? cost_fn_(value) : 1;
+        EraseLocked(key);
+        if (cost > capacity_) {
+            return;
+        }
+        entries_.push_front({key, std::move(value), cost});
+        index_.emplace(key, entries_.begin());
+        total_cost_ += cost;
+        while (total_cost_ > capacity_) {
+            EraseLocked(entries_.back().key);
+        }
+    }
+
+    bool Erase(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return EraseLocked(key);
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.clear();
+        entries_.clear();
+        total_cost_ = 0;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    size_t cost() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_cost_;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+  private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    bool EraseLocked(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        total_cost_ -= it->second->cost;
+        entries_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    const size_t capacity_;
+    const CostFn cost_fn_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    size_t total_cost_ = 0;
+};
+
+}  // namespace clan::core
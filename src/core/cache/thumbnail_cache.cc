@@ -0,0 +1,251 @@
+#include "core/cache/thumbnail_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+#include "core/log/log.h"
+#include "core/platform/path_manager.h"
+
+namespace fs = std::filesystem;
+
+namespace clan::core {
+
+namespace {
+
+constexpr size_t kDefaultMemoryBudget = 32 * 1024 * 1024;
+
+// FNV-1a: the key names files on disk, so it must not change between runs (std::hash may)
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Where a thumbnail lives: one directory per source path, one file per version and tier
+struct CacheKey {
+    std::string source;  // 16 hex digits of the path hash
+    std::string entry;   // "<16 hex digits of mtime and size>-<tier>"
+
+    bool empty() const { return source.empty(); }
+    std::string memoryKey() const { return source + '/' + entry; }
+};
+
+// Empty if the source cannot be stat'ed
+CacheKey MakeCacheKey(const fs::path& source, int tier) {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(source, ec);
+    if (ec) {
+        return {};
+    }
+    auto size = fs::file_size(source, ec);
+    if (ec) {
+        return {};
+    }
+
+    const auto& native = source.native();
+    uint64_t pathHash = Fnv1a(native.data(), native.size() * sizeof(native[0]));
+    int64_t ticks = mtime.time_since_epoch().count();
+    uint64_t versionHash = Fnv1a(&ticks, sizeof(ticks));
+    versionHash = Fnv1a(&size, sizeof(size), versionHash);
+
+    char sourceHex[20];
+    char entry[40];
+    std::snprintf(sourceHex, sizeof(sourceHex), "%016llx",
+                  static_cast<unsigned long long>(pathHash));
+    std::snprintf(entry, sizeof(entry), "%016llx-%d",
+                  static_cast<unsigned long long>(versionHash), tier);
+    return {sourceHex, entry};
+}
+
+}  // namespace
+
+int ThumbnailCache::SizeTier(int requested) {
+    for (int size : kSizes) {
+        if (requested <= size) {
+            return size;
+        }
+    }
+    return kSizes.back();
+}
+
+ThumbnailCache& ThumbnailCache::instance() {
+    static ThumbnailCache cache(PathManager::instance().cache_dir() / "thumbnails",
+                                kDefaultMemoryBudget);
+    return cache;
+}
+
+ThumbnailCache::ThumbnailCache(fs::path dir, size_t memoryBudgetBytes, uint64_t diskBudgetBytes)
+    : dir_(std::move(dir)),
+      disk_budget_(diskBudgetBytes),
+      memory_(memoryBudgetBytes, [](const Bytes& bytes) { return bytes->size(); }) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        LOGWARN("[Thumbnail] Cannot create cache dir {}: {}", dir_.string(), ec.message());
+    }
+    // Also sizes the disk tier; files of older layouts count and age out like the rest
+    PruneDisk();
+}
+
+ThumbnailCache::Bytes ThumbnailCache::Get(const fs::path& source, int width,
+                                          const Encoder& encode) {
+    int tier = SizeTier(width);
+    CacheKey key = MakeCacheKey(source, tier);
+    if (key.empty()) {
+        return nullptr;  // missing source
+    }
+    std::string memoryKey = key.memoryKey();
+
+    if (auto hit = memory_.Get(memoryKey)) {
+        ++memory_hits_;
+        return *hit;
+    }
+
+    fs::path file = dir_ / key.source / (key.entry + ".thumb");
+    if (Bytes bytes = ReadFile(file)) {
+        ++disk_hits_;
+        std::error_code ec;
+        fs::last_write_time(file, fs::file_time_type::clock::now(), ec);  // LRU order on disk
+        memory_.Put(memoryKey, bytes);
+        return bytes;
+    }
+
+    ++misses_;
+    auto encoded = std::make_shared<const std::string>(encode(source, tier));
+    if (encoded->empty()) {
+        return nullptr;
+    }
+    if (WriteFile(file, *encoded)) {
+        RemoveStaleVersions(file);
+        if (disk_bytes_.fetch_add(encoded->size()) + encoded->size() > disk_budget_) {
+            PruneDisk();
+        }
+    }
+    memory_.Put(memoryKey, encoded);
+    return encoded;
+}
+
+void ThumbnailCache::Clear() {
+    std::lock_guard<std::mutex> lock(prune_mutex_);
+    memory_.Clear();
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+        fs::remove_all(entry.path(), ec);
+    }
+    disk_bytes_ = 0;
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const {
+    return {memory_hits_.load(), disk_hits_.load(), misses_.load(), disk_bytes_.load()};
+}
+
+// Files of a source are named "<version>-<tier>.thumb", so everything in its directory
+// without the current version prefix belongs to an edited or replaced source file.
+void ThumbnailCache::RemoveStaleVersions(const fs::path& current) {
+    std::string version = current.filename().string();
+    version.resize(version.find('-'));
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(current.parent_path(), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, version.size(), version) == 0 || name.ends_with(".tmp")) {
+            continue;  // current version, or a concurrent writer's temp file
+        }
+        std::error_code sizeEc;
+        uint64_t size = entry.file_size(sizeEc);
+        if (fs::remove(entry.path(), sizeEc) && size > 0) {
+            disk_bytes_ -= std::min<uint64_t>(size, disk_bytes_.load());
+        }
+    }
+}
+
+void ThumbnailCache::PruneDisk() {
+    std::lock_guard<std::mutex> lock(prune_mutex_);
+    struct File {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(dir_, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code statEc;
+        if (!it->is_regular_file(statEc)) {
+            continue;
+        }
+        File file{it->path(), it->last_write_time(statEc), it->file_size(statEc)};
+        if (!statEc) {
+            total += file.size;
+            files.push_back(std::move(file));
+        }
+    }
+
+    // Down to 3/4 of the budget, so that the next writes do not prune again right away
+    uint64_t target = disk_budget_ / 4 * 3;
+    if (total > disk_budget_) {
+        std::sort(files.begin(), files.end(),
+                  [](const File& a, const File& b) { return a.used < b.used; });
+        size_t removed = 0;
+        for (const File& file : files) {
+            if (total <= target) {
+                break;
+            }
+            if (fs::remove(file.path, ec)) {
+                total -= file.size;
+                ++removed;
+                if (file.path.parent_path() != dir_) {
+                    fs::remove(file.path.parent_path(), ec);  // only once it is empty
+                }
+            }
+        }
+        LOGINFO("[Thumbnail] Pruned {} file(s); disk cache now {} KiB", removed, total / 1024);
+    }
+    disk_bytes_ = total;
+}
+
+ThumbnailCache::Bytes ThumbnailCache::ReadFile(const fs::path& path) const {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.empty()) {
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(std::move(bytes));
+}
+
+// Written to a temp file and renamed into place, so a reader never sees a partial file.
+bool ThumbnailCache::WriteFile(const fs::path& path, const std::string& bytes) {
+    std::error_code dirEc;
+    fs::create_directories(path.parent_path(), dirEc);
+    fs::path temp = path;
+    temp += "." + std::to_string(++temp_serial_) + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) ||
+            !out.flush()) {
+            LOGWARN("[Thumbnail] Cannot write {}", temp.string());
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        LOGWARN("[Thumbnail] Cannot store {}: {}", path.string(), ec.message());
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace clan::core
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "core/cache/lru_cache.h"
+
+namespace clan::core {
+
+// Persistent cache of encoded image thumbnails. An entry is keyed by the source path, its
+// modification time and size, and the size tier, so editing or replacing a source file
+// simply misses and re-encodes. Storing the new version removes the old one's tiers.
+//
+// Lookups go memory (LRU, bounded in bytes) -> disk (<dir>/<source>/<version>-<tier>.thumb)
+// -> encoder. The disk tier is bounded too: past its budget the least recently used files
+// (by modification time, which a disk hit refreshes) are removed. The encoder is supplied
+// by the caller because decoding needs the GUI toolkit, which the core library does not
+// link.
+class ThumbnailCache {
+  public:
+    // Width tiers, in pixels: tree avatars, list avatars, detail view
+    static constexpr std::array<int, 3> kSizes = {64, 128, 500};
+
+    // Smallest tier at least `requested` pixels wide (the largest tier above that).
+    static int SizeTier(int requested);
+
+    using Bytes = std::shared_ptr<const std::string>;
+    // Returns the encoded thumbnail of `source` at most `width` pixels wide, or an empty
+    // string if the image cannot be read. May run on any thread.
+    using Encoder = std::function<std::string(const std::filesystem::path& source, int width)>;
+
+    // Stored under PathManager::cache_dir()/thumbnails.
+    static ThumbnailCache& instance();
+
+    static constexpr uint64_t kDefaultDiskBudget = 256ULL * 1024 * 1024;
+
+    ThumbnailCache(std::filesystem::path dir, size_t memoryBudgetBytes,
+                   uint64_t diskBudgetBytes = kDefaultDiskBudget);
+
+    // The thumbnail of `source` for the tier covering `width`; nullptr if the source does
+    // not exist or the encoder fails. A hit costs a stat of the source and, past the
+    // memory tier, one file read.
+    Bytes Get(const std::filesystem::path& source, int width, const Encoder& encode);
+
+    // Drops every cached thumbnail, in memory and on disk.
+    void Clear();
+
+    struct Stats {
+        uint64_t memory_hits = 0;
+        uint64_t disk_hits = 0;
+        uint64_t misses = 0;
+        uint64_t disk_bytes = 0;  // files under the cache dir
+    };
+    Stats stats() const;
+
+  private:
+    Bytes ReadFile(const std::filesystem::path& path) const;
+    bool WriteFile(const std::filesystem::path& path, const std::string& bytes);
+    // Removes the files of other versions of a source next to `current`
+    void RemoveStaleVersions(const std::filesystem::path& current);
+    // Removes least recently used files until the disk tier is well under budget
+    void PruneDisk();
+
+    std::filesystem::path dir_;
+    uint64_t disk_budget_;
+    std::atomic<uint64_t> disk_bytes_{0};
+    std::mutex prune_mutex_;  // one PruneDisk at a time
+    LruCache<std::string, Bytes> memory_;
+    std::atomic<uint64_t> memory_hits_{0};
+    std::atomic<uint64_t> disk_hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> temp_serial_{0};  // unique temp names for concurrent writers
+};
+
+}  // namespace clan::core
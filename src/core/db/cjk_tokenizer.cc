@@ -0,0 +1,210 @@
+#include "core/db/cjk_tokenizer.h"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+
+namespace clan::core {
+
+namespace {
+
+enum class CharClass { kSeparator, kWord, kCjk };
+
+struct CodePoint {
+    char32_t value;
+    int length;  // bytes consumed
+};
+
+// Lenient UTF-8 decoding: a malformed or truncated sequence yields U+FFFD for one byte,
+// which classifies as a word character (the byte is kept, never dropped silently).
+CodePoint DecodeUtf8(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    if (c < 0x80) {
+        return {c, 1};
+    }
+    int length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+    if (length == 0 || end - p < length) {
+        return {0xFFFD, 1};
+    }
+    char32_t value = c & (0x7F >> length);
+    for (int i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return {0xFFFD, 1};
+        }
+        value = (value << 6) | (p[i] & 0x3F);
+    }
+    return {value, length};
+}
+
+bool InRange(char32_t cp, char32_t lo, char32_t hi) {
+    return cp >= lo && cp <= hi;
+}
+
+CharClass Classify(char32_t cp) {
+    if (cp < 0x80) {
+        bool alnum = InRange(cp, '0', '9') || InRange(cp, 'a', 'z') || InRange(cp, 'A', 'Z');
+        return alnum ? CharClass::kWord : CharClass::kSeparator;
+    }
+    if (InRange(cp, 0x4E00, 0x9FFF) ||    // CJK unified ideographs
+        InRange(cp, 0x3400, 0x4DBF) ||    // extension A
+        InRange(cp, 0x20000, 0x323AF) ||  // extensions B-H
+        InRange(cp, 0xF900, 0xFAFF) ||    // compatibility ideographs
+        InRange(cp, 0x2E80, 0x2FDF) ||    // radicals
+        InRange(cp, 0x3040, 0x31FF) ||    // kana, bopomofo
+        InRange(cp, 0x1100, 0x11FF) ||    // Hangul jamo
+        InRange(cp, 0xAC00, 0xD7AF)) {    // Hangul syllables
+        return CharClass::kCjk;
+    }
+    if (InRange(cp, 0x80, 0xBF) ||      // Latin-1 controls and punctuation
+        InRange(cp, 0x2000, 0x206F) ||  // general punctuation
+        InRange(cp, 0x3000, 0x303F) ||  // CJK symbols and punctuation (、。「」)
+        InRange(cp, 0xFE30, 0xFE4F) ||  // CJK compatibility forms
+        InRange(cp, 0xFF00, 0xFF0F) ||  // fullwidth punctuation (，！（）)
+        InRange(cp, 0xFF1A, 0xFF20) || InRange(cp, 0xFF3B, 0xFF40) ||
+        InRange(cp, 0xFF5B, 0xFF65)) {
+        return CharClass::kSeparator;
+    }
+    return CharClass::kWord;
+}
+
+// Walks `text` and calls onRun(cls, begin, end) for every maximal run of word or CJK
+// characters; for CJK runs onChar(begin, end) is called for each character first.
+template <typename OnChar, typename OnRun>
+int ForEachRun(const char* text, int length, OnChar&& onChar, OnRun&& onRun) {
+    auto* begin = reinterpret_cast<const unsigned char*>(text);
+    auto* end = begin + length;
+    auto* p = begin;
+    while (p < end) {
+        CodePoint cp = DecodeUtf8(p, end);
+        CharClass cls = Classify(cp.value);
+        if (cls == CharClass::kSeparator) {
+            p += cp.length;
+            continue;
+        }
+        auto* runStart = p;
+        while (p < end) {
+            cp = DecodeUtf8(p, end);
+            if (Classify(cp.value) != cls) {
+                break;
+            }
+            if (cls == CharClass::kCjk) {
+                onChar(static_cast<int>(p - begin), static_cast<int>(p - begin + cp.length));
+            }
+            p += cp.length;
+        }
+        int rc = onRun(cls, static_cast<int>(runStart - begin), static_cast<int>(p - begin));
+        if (rc != SQLITE_OK) {
+            return rc;
+        }
+    }
+    return SQLITE_OK;
+}
+
+struct CharSpan {
+    int begin;
+    int end;
+};
+
+// Per-table tokenizer instance; only holds scratch buffers.
+struct CjkTokenizer {
+    std::string lowered;
+    std::vector<CharSpan> chars;
+};
+
+int CreateTokenizer(void*, const char**, int argCount, Fts5Tokenizer** out) {
+    if (argCount > 0) {
+        return SQLITE_ERROR;  // no options
+    }
+    *out = reinterpret_cast<Fts5Tokenizer*>(new CjkTokenizer());
+    return SQLITE_OK;
+}
+
+void DeleteTokenizer(Fts5Tokenizer* tokenizer) {
+    delete reinterpret_cast<CjkTokenizer*>(tokenizer);
+}
+
+using TokenCallback = int (*)(void*, int, const char*, int, int, int);
+
+int Tokenize(Fts5Tokenizer* tokenizer, void* ctx, int flags, const char* text, int length,
+             TokenCallback emit) {
+    auto& self = *reinterpret_cast<CjkTokenizer*>(tokenizer);
+    const bool query = (flags & FTS5_TOKENIZE_QUERY) != 0;
+    self.chars.clear();
+
+    int rc = ForEachRun(
+        text, length, [&](int begin, int end) { self.chars.push_back({begin, end}); },
+        [&](CharClass cls, int begin, int end) -> int {
+            if (cls == CharClass::kWord) {
+                self.lowered.assign(text + begin, end - begin);
+                for (char& c : self.lowered) {
+                    if (c >= 'A' && c <= 'Z') {
+                        c = static_cast<char>(c - 'A' + 'a');
+                    }
+                }
+                return emit(ctx, 0, self.lowered.data(), static_cast<int>(self.lowered.size()),
+                            begin, end);
+            }
+
+            // CJK run: characters are contiguous, so every n-gram is a slice of `text`
+            const auto& chars = self.chars;
+            const size_t n = chars.size();
+            int rc = SQLITE_OK;
+            if (query && n > 1) {
+                for (size_t i = 0; i + 1 < n && rc == SQLITE_OK; ++i) {
+                    rc = emit(ctx, 0, text + chars[i].begin, chars[i + 1].end - chars[i].begin,
+                              chars[i].begin, chars[i + 1].end);
+                }
+            } else {
+                for (size_t i = 0; i < n && rc == SQLITE_OK; ++i) {
+                    rc = emit(ctx, 0, text + chars[i].begin, chars[i].end - chars[i].begin,
+                              chars[i].begin, chars[i].end);
+                    if (rc == SQLITE_OK && !query && i + 1 < n) {
+                        rc = emit(ctx, FTS5_TOKEN_COLOCATED, text + chars[i].begin,
+                                  chars[i + 1].end - chars[i].begin, chars[i].begin,
+                                  chars[i + 1].end);
+                    }
+                }
+            }
+            self.chars.clear();
+            return rc;
+        });
+    // SQLITE_DONE from the callback only means "stop early"
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
+
+fts5_api* GetFts5Api(sqlite3* db) {
+    fts5_api* api = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT fts5(?1)", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_pointer(stmt, 1, &api, "fts5_api_ptr", nullptr);
+        sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return api;
+}
+
+}  // namespace
+
+bool RegisterCjkTokenizer(sqlite3* db) {
+    fts5_api* api = db ? GetFts5Api(db) : nullptr;
+    if (!api) {
+        return false;
+    }
+    static fts5_tokenizer tokenizer = {CreateTokenizer, DeleteTokenizer, Tokenize};
+    return api->xCreateTokenizer(api, kCjkTokenizerName, nullptr, &tokenizer, nullptr) ==
+           SQLITE_OK;
+}
+
+std::vector<KeywordRun> SplitKeywordRuns(std::string_view keyword) {
+    std::vector<KeywordRun> runs;
+    ForEachRun(
+        keyword.data(), static_cast<int>(keyword.size()), [](int, int) {},
+        [&](CharClass cls, int begin, int end) {
+            runs.push_back({std::string(keyword.substr(begin, end - begin)),
+                            cls == CharClass::kCjk});
+            return SQLITE_OK;
+        });
+    return runs;
+}
+
+}  // namespace clan::core
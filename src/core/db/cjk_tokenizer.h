@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct sqlite3;
+
+namespace clan::core {
+
+// FTS5 tokenizer name used by members_fts ("tokenize='cjk'").
+inline constexpr const char* kCjkTokenizerName = "cjk";
+
+// Registers the "cjk" FTS5 tokenizer on a connection. It must be registered on every
+// connection that reads or writes members_fts (the sync triggers run the tokenizer).
+// External writers without it (sqlite3 CLI, scripts/init_db.py) must drop the sync
+// triggers first; EnsureMembersFts rebuilds the index and restores them on next launch.
+//
+// Text is split into runs of word characters. Non-CJK runs become one ASCII-lowercased
+// token each, as unicode61 would produce. CJK runs (Han, kana, Hangul) are indexed as
+// overlapping bigrams with each character's unigram colocated at the same position, so
+// any substring of a name or bio is a phrase of consecutive tokens:
+//   document "陈大伯" -> 0:{陈, 陈大} 1:{大, 大伯} 2:{伯}
+//   query    "大伯"   -> 大伯          (single character queries use the unigram)
+//   query    "陈大伯" -> 陈大 + 大伯   (phrase: consecutive positions)
+// Returns false if FTS5 is unavailable on the connection.
+bool RegisterCjkTokenizer(sqlite3* db);
+
+struct KeywordRun {
+    std::string text;
+    bool cjk = false;
+};
+
+// Query-side segmenter: splits one user keyword into runs of the same script (CJK vs
+// other word characters), dropping punctuation and separators. Each run is a single FTS5
+// phrase under the cjk tokenizer; e.g. "陈dabo-2" -> {"陈", "dabo", "2"}.
+std::vector<KeywordRun> SplitKeywordRuns(std::string_view keyword);
+
+}  // namespace clan::core
@@ -0,0 +1,80 @@
+#include "core/db/connection_pool.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+namespace clan::core {
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_),
+      conn_(other.conn_) {
+    other.pool_ = nullptr;
+    other.conn_ = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_ && conn_) {
+        pool_->Release(conn_);
+    }
+}
+
+ConnectionPool::~ConnectionPool() {
+    Close();
+}
+
+void ConnectionPool::Open(const std::string& path, size_t count,
+                          const std::function<void(SQLite::Database&)>& setup) {
+    Close();
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (size_t i = 0; i < count; ++i) {
+        auto conn = std::make_unique<Connection>();
+        conn->db = std::make_unique<SQLite::Database>(path, SQLite::OPEN_READONLY);
+        if (setup) {
+            setup(*conn->db);
+        }
+        conn->statements = std::make_unique<StatementCache>(*conn->db);
+        connections.push_back(std::move(conn));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_ = std::move(connections);
+    for (auto& conn : connections_) {
+        idle_.push_back(conn.get());
+    }
+    open_ = !connections_.empty();
+}
+
+void ConnectionPool::Close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    open_ = false;
+    cv_.notify_all();  // wake waiters in Acquire(); they return empty leases
+    cv_.wait(lock, [this] { return idle_.size() == connections_.size(); });
+    idle_.clear();
+    connections_.clear();
+}
+
+size_t ConnectionPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connections_.size();
+}
+
+ConnectionPool::Lease ConnectionPool::Acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !open_ || !idle_.empty(); });
+    if (!open_) {
+        return {};
+    }
+    Connection* conn = idle_.back();
+    idle_.pop_back();
+    return Lease(this, conn);
+}
+
+void ConnectionPool::Release(Connection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(conn);
+    }
+    cv_.notify_all();
+}
+
+}  // namespace clan::core
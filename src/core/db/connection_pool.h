@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/db/statement_cache.h"
+
+namespace SQLite {
+class Database;
+}
+
+namespace clan::core {
+
+// Fixed set of read-only SQLite connections, each with its own statement cache.
+//
+// With the database in WAL mode, readers never block each other or the writer, so
+// queries that lease a connection here run in parallel with writes on the owner's
+// single writer connection. Acquire() blocks while every connection is leased.
+class ConnectionPool {
+  public:
+    struct Connection {
+        std::unique_ptr<SQLite::Database> db;
+        // Declared after db so cached statements are finalized before the connection closes
+        std::unique_ptr<StatementCache> statements;
+    };
+
+    // Exclusive use of one pooled connection; returned to the pool on destruction.
+    class Lease {
+      public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        explicit operator bool() const { return conn_ != nullptr; }
+        SQLite::Database& db() const { return *conn_->db; }
+        StatementCache& statements() const { return *conn_->statements; }
+
+      private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, Connection* conn) : pool_(pool), conn_(conn) {}
+
+        ConnectionPool* pool_ = nullptr;
+        Connection* conn_ = nullptr;
+    };
+
+    ConnectionPool() = default;
+    ~ConnectionPool();
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Opens `count` read-only connections to `path`; `setup` runs once on each (pragmas,
+    // custom functions). Throws SQLite::Exception if a connection cannot be opened.
+    void Open(const std::string& path, size_t count,
+              const std::function<void(SQLite::Database&)>& setup);
+    // Waits for outstanding leases, then closes every connection.
+    void Close();
+
+    size_t size() const;
+    // An empty lease when the pool is closed (or closing); callers fall back to the writer.
+    Lease Acquire();
+
+  private:
+    void Release(Connection* conn);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> idle_;
+};
+
+}  // namespace clan::core
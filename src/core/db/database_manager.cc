@@ -2,13 +2,21 @@
 
 #include <SQLiteCpp/SQLiteCpp.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <map>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "core/db/cjk_tokenizer.h"
+#include "core/db/member_columns.h"
+#include "core/db/member_diff.h"
+#include "core/db/schema_migrator.h"
 #include "core/log/log.h"
 #include "core/platform/path_manager.h"
 
@@ -16,10 +24,82 @@ namespace clan::core {
 
 namespace fs = std::filesystem;
 
-DatabaseManager::DatabaseManager() {
+namespace {
+
+// Per-connection cache tuning, shared by the writer and the pooled readers
+void ApplyConnectionPragmas(SQLite::Database& db, const DatabaseOptions& options) {
+    db.exec("PRAGMA mmap_size = " + std::to_string(options.mmap_size));
+    // Negative cache_size is in KiB rather than pages
+    db.exec("PRAGMA cache_size = " + std::to_string(-options.cache_size_kib));
+}
+
+// Whitespace-separated search keywords
+std::vector<std::string> SplitKeywords(const std::string& keyword) {
+    std::istringstream iss(keyword);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (iss >> token) {
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+bool IsAsciiToken(const std::string& token) {
+    return std::all_of(token.begin(), token.end(),
+                       [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+// Each keyword becomes a group of phrases, one per script run ("陈dabo" -> ("陈" "dabo"*),
+// runs AND-ed), and keywords are OR-ed like the LIKE path. Word runs are prefix queries;
+// CJK runs already match any substring through bigrams, and a prefix there would only
+// widen the scan. Runs hold only word characters, so nothing the user types is parsed as
+// FTS5 syntax.
+std::string BuildFtsQuery(const std::vector<std::string>& tokens) {
+    std::string query;
+    for (const auto& t : tokens) {
+        auto runs = SplitKeywordRuns(t);
+        if (runs.empty()) {
+            continue;
+        }
+        if (!query.empty()) {
+            query += " OR ";
+        }
+        query += '(';
+        for (size_t i = 0; i < runs.size(); ++i) {
+            if (i > 0) {
+                query += ' ';
+            }
+            query += '"' + runs[i].text + (runs[i].cjk ? "\"" : "\"*");
+        }
+        query += ')';
+    }
+    return query;
+}
+
+// Heap plus inline size of a cached member, for the member cache budget
+size_t ApproxMemberBytes(const Member& m) {
+    size_t bytes = sizeof(Member);
+    for (const std::string* field :
+         {&m.id, &m.name, &m.gender, &m.generation_name, &m.aliases, &m.father_id,
+          &m.father_name, &m.mother_id, &m.spouse_name, &m.birth_date, &m.death_date,
+          &m.birth_place, &m.death_place, &m.portrait_path, &m.bio}) {
+        bytes += field->capacity();
+    }
+    return bytes;
+}
+
+}  // namespace
+
+DatabaseManager::DatabaseManager()
+    : member_cache_(kMemberCacheBytes, [](const Member& m) { return ApproxMemberBytes(m); }),
+      op_logs_([this](const std::vector<OperationLog>& batch) {
+          return WriteOperationLogs(batch);
+      }) {
 }
 
 DatabaseManager::~DatabaseManager() {
+    // Queued operation logs still need the connection
+    op_logs_.Stop();
     // Unique_ptr handles cleanup
 }
 
@@ -28,7 +108,9 @@ DatabaseManager& DatabaseManager::instance() {
     return instance;
 }
 
-void DatabaseManager::Initialize(const std::string& dbPath) {
+void DatabaseManager::Initialize(const std::string& dbPath, const DatabaseOptions& options) {
+    // Entries queued so far belong to the database being replaced
+    op_logs_.Flush();
     std::lock_guard<std::mutex> lock(db_mutex_);
 
     // Ensure directory exists
@@ -38,253 +120,405 @@ void DatabaseManager::Initialize(const std::string& dbPath) {
     }
 
     try {
+        // Readers first (waits for in-flight queries), then the writer's cached statements,
+        // which belong to the old connection and must be finalized before it closes
+        readers_.Close();
+        statements_.reset();
+
         // Open database (Read/Write | Create if missing)
         db_ = std::make_unique<SQLite::Database>(dbPath,
                                                  SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        statements_ = std::make_unique<StatementCache>(*db_);
+
+        // Rows cached from the previous database must not answer for this one
+        member_cache_enabled_ = options.member_cache;
+        DropCachedMembers("");
+
+        // members_fts segments Chinese text with our tokenizer; it must exist on the
+        // connection before the table or its triggers are touched
+        bool cjkTokenizer = RegisterCjkTokenizer(db_->getHandle());
+        if (!cjkTokenizer) {
+            LOGWARN("[DB] CJK tokenizer unavailable; members_fts uses unicode61.");
+        }
 
         LOGINFO("[DB] Database opened at: {}", dbPath);
 
         // Enable Foreign Keys
         db_->exec("PRAGMA foreign_keys = ON;");
 
-        // Create Tables
-        CreateTables();
-
-        // Check and migrate schema (Ensure 'aliases' column exists)
-        CheckAndMigrateSchema();
+        bool wal = false;
+        if (options.wal) {
+            // Persistent: stored in the database file, so readers opened later see it too
+            SQLite::Statement mode(*db_, "PRAGMA journal_mode = WAL");
+            wal = mode.executeStep() && std::string(mode.getColumn(0).getText()) == "wal";
+            if (!wal) {
+                LOGWARN("[DB] WAL unavailable for {}; using a single connection.", dbPath);
+            }
+        }
+        db_->exec("PRAGMA synchronous = " + options.synchronous);
+        ApplyConnectionPragmas(*db_, options);
+
+        // Create or upgrade the schema; up-to-date databases skip every step
+        MigrateSchema();
+
+        // Retention: old audit entries leave the live table before anything reads it
+        if (options.operation_log_retention_days > 0) {
+            int64_t cutoff = std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count() -
+                             int64_t{options.operation_log_retention_days} * 24 * 3600;
+            MoveOperationLogsToArchive(cutoff);
+        }
 
-        // FTS Rebuild removed: We now use standard SQL LIKE queries for robustness.
-        // The FTS table is no longer critical for the main search function.
+        // Load the resident kinship graph used by tree rendering and lineage queries
+        RebuildKinshipIndex();
+
+        // Ranked search uses members_fts when usable, LIKE otherwise
+        CheckFTSSupport(cjkTokenizer);
+
+        // Read-only connections for the query methods; opened after the migrations so
+        // they never observe a half-created schema
+        if (wal && options.read_connections > 0) {
+            readers_.Open(dbPath, static_cast<size_t>(options.read_connections),
+                          [&options](SQLite::Database& reader) {
+                              RegisterCjkTokenizer(reader.getHandle());
+                              ApplyConnectionPragmas(reader, options);
+                          });
+            LOGINFO("[DB] Read pool: {} connection(s)", readers_.size());
+        }
 
     } catch (std::exception& e) {
         LOGERROR("[DB] Initialize failed: {}", e.what());
     }
 }
 
-void DatabaseManager::CheckAndMigrateSchema() {
-    if (!db_)
-        return;
-    try {
-        // Check if aliases column exists in members table
-        bool hasAliases = false;
-        SQLite::Statement query(*db_, "PRAGMA table_info(members)");
-        while (query.executeStep()) {
-            std::string colName = query.getColumn("name").getText();
-            if (colName == "aliases") {
-                hasAliases = true;
-                break;
-            }
-        }
-
-        if (!hasAliases) {
-            LOGINFO("[DB] Migrating: Adding 'aliases' column to members table...");
-            db_->exec("ALTER TABLE members ADD COLUMN aliases TEXT");
-
-            // Rebuild FTS trigger definitions will happen if FTS tables are recreated
-            // But for simple column add, we might need to update triggers if possible
-            // Since triggers are created in CreateTables using IF NOT EXISTS,
-            // we should drop and recreate them to include the new column.
-            db_->exec("DROP TRIGGER IF EXISTS members_ai");
-            db_->exec("DROP TRIGGER IF EXISTS members_ad");
-            db_->exec("DROP TRIGGER IF EXISTS members_au");
-
-            // Note: FTS schema needs update too if we want to search aliases.
-            // FTS5 tables don't support ADD COLUMN easily.
-            // Simpler approach for migration: Drop and recreate FTS table.
-            db_->exec("DROP TABLE IF EXISTS members_fts");
+// ---------------------------------------------------------
+// Schema migrations
+// ---------------------------------------------------------
 
-            // Re-run CreateTables to recreate triggers and FTS
-            CreateTables();
-        }
+namespace {
+
+// v1: base tables and indexes. Also adopts databases created before schema_version
+// existed (every statement is IF NOT EXISTS).
+void CreateCoreTables(SQLite::Database& db) {
+    // 1. Members Table
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS members (
+            id TEXT PRIMARY KEY,
+            name TEXT NOT NULL,
+            gender TEXT,
+            generation INTEGER,
+            generation_name TEXT,
+            father_id TEXT,
+            mother_id TEXT,
+            spouse_name TEXT,
+            birth_date TEXT,
+            death_date TEXT,
+            birth_place TEXT,
+            death_place TEXT,
+            portrait_path TEXT,
+            bio TEXT,
+            aliases TEXT,
+            created_at INTEGER,
+            updated_at INTEGER
+        );
+    )");
+
+    // 2. Media Resources Table
+    // [Added] Table for v0.8 media support
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS media_resources (
+            id TEXT PRIMARY KEY,           -- Unique ID
+            member_id TEXT NOT NULL,       -- Foreign Key to Member
+            resource_type TEXT NOT NULL,   -- 'video', 'photo', 'audio'
+            file_path TEXT NOT NULL,       -- Relative path in resources dir
+            title TEXT,                    -- Display title
+            description TEXT,              -- Optional description
+            file_hash TEXT,                -- SHA256 or unique hash for deduplication
+            file_size INTEGER,             -- File size in bytes
+            created_at INTEGER,            -- Import timestamp
+            is_primary BOOLEAN DEFAULT 0,  -- Is this the primary profile video/photo?
+            FOREIGN KEY(member_id) REFERENCES members(id) ON DELETE CASCADE
+        );
+    )");
+
+    // 3. Settings Table
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS settings (
+            key TEXT PRIMARY KEY,
+            value TEXT NOT NULL,
+            updated_at INTEGER
+        );
+    )");
+
+    // 4. Operation Logs Table
+    db.exec(R"(
+        CREATE TABLE IF NOT EXISTS operation_logs (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            action TEXT NOT NULL,
+            target_type TEXT NOT NULL,
+            target_id TEXT NOT NULL,
+            target_name TEXT,
+            changes TEXT,
+            created_at INTEGER NOT NULL
+        );
+    )");
+
+    // Create Indexes
+    db.exec("CREATE INDEX IF NOT EXISTS idx_members_father ON members(father_id);");
+    db.exec("CREATE INDEX IF NOT EXISTS idx_media_member ON media_resources(member_id);");
+    db.exec(
+        "CREATE INDEX IF NOT EXISTS idx_logs_created ON operation_logs(created_at DESC);");
+
+    // Initialize default generation names if not exist
+    SQLite::Statement checkSetting(
+        db, "SELECT COUNT(*) FROM settings WHERE key = 'generation_names'");
+    if (checkSetting.executeStep() && checkSetting.getColumn(0).getInt() == 0) {
+        db.exec(R"(
+            INSERT INTO settings (key, value, updated_at) VALUES (
+                'generation_names',
+                '["始","定","英","华","富","贵","荣","昌","盛","德","永"]',
+                0
+            );
+        )");
+        LOGINFO("[DB] Initialized default generation names.");
+    }
+}
 
-    } catch (std::exception& e) {
-        LOGERROR("[DB] Schema migration failed: {}", e.what());
+// v2: members.aliases. Databases created before aliases existed lack the column; the
+// probe runs once, as part of this step, instead of on every start.
+void AddMemberAliases(SQLite::Database& db) {
+    SQLite::Statement probe(db,
+                            "SELECT count(*) FROM pragma_table_info('members') "
+                            "WHERE name = 'aliases'");
+    if (probe.executeStep() && probe.getColumn(0).getInt() == 0) {
+        db.exec("ALTER TABLE members ADD COLUMN aliases TEXT");
     }
 }
 
-void DatabaseManager::CreateTables() {
-    if (!db_)
-        return;
+// Sync triggers keeping members_fts in step with members. Bulk loads drop them and
+// rebuild the index once instead of paying the FTS work per row.
+void DropMembersFtsTriggers(SQLite::Database& db) {
+    db.exec(R"(
+        DROP TRIGGER IF EXISTS members_ai;
+        DROP TRIGGER IF EXISTS members_ad;
+        DROP TRIGGER IF EXISTS members_au;
+    )");
+}
 
-    try {
-        SQLite::Transaction transaction(*db_);
+void CreateMembersFtsTriggers(SQLite::Database& db) {
+    db.exec(R"(
+        CREATE TRIGGER members_ai AFTER INSERT ON members BEGIN
+          INSERT INTO members_fts(rowid, name, bio, aliases) VALUES (new.rowid, new.name, new.bio, new.aliases);
+        END;
+        CREATE TRIGGER members_ad AFTER DELETE ON members BEGIN
+          INSERT INTO members_fts(members_fts, rowid, name, bio, aliases) VALUES('delete', old.rowid, old.name, old.bio, old.aliases);
+        END;
+        CREATE TRIGGER members_au AFTER UPDATE ON members BEGIN
+          INSERT INTO members_fts(members_fts, rowid, name, bio, aliases) VALUES('delete', old.rowid, old.name, old.bio, old.aliases);
+          INSERT INTO members_fts(rowid, name, bio, aliases) VALUES (new.rowid, new.name, new.bio, new.aliases);
+        END;
+    )");
+}
 
-        // 1. Members Table
-        db_->exec(R"(
-            CREATE TABLE IF NOT EXISTS members (
-                id TEXT PRIMARY KEY,
-                name TEXT NOT NULL,
-                gender TEXT,
-                generation INTEGER,
-                generation_name TEXT,
-                father_id TEXT,
-                mother_id TEXT,
-                spouse_name TEXT,
-                birth_date TEXT,
-                death_date TEXT,
-                birth_place TEXT,
-                death_place TEXT,
-                portrait_path TEXT,
-                bio TEXT,
-                aliases TEXT,
-                created_at INTEGER,
-                updated_at INTEGER
-            );
-        )");
+// v3 used to create members_fts here. It now lives outside the chain (EnsureMembersFts):
+// a failed step stops every later migration, and FTS5 or the cjk tokenizer may simply be
+// missing from the SQLite build. Kept as a no-op so the version numbers stay as shipped.
+void SkipMembersFts(SQLite::Database&) {}
 
-        // 2. Full Text Search (FTS5) Virtual Table
-        // Note: FTS tables are virtual, they don't support standard ALTER TABLE well.
-        // We link it to members via triggers or manual updates.
-        // Here we use Contentless or External Content FTS if needed,
-        // but for simplicity in v0.5, we populate it manually or via triggers.
-        // 2. Full Text Search (FTS5) Virtual Table
-        // Re-create to ensure schema is up-to-date (simple migration strategy)
-        db_->exec("DROP TABLE IF EXISTS members_fts;");
-        db_->exec(R"(
-            CREATE VIRTUAL TABLE IF NOT EXISTS members_fts USING fts5(
-                name, bio, aliases, content='members', content_rowid='rowid'
-            );
-        )");
+// CREATE statement SQLite stored for members_fts, empty if the table does not exist
+std::string MembersFtsSql(SQLite::Database& db) {
+    SQLite::Statement query(db, "SELECT sql FROM sqlite_master WHERE name = 'members_fts'");
+    return query.executeStep() ? query.getColumn(0).getString() : std::string();
+}
 
-        // Re-populate FTS if empty (or always since we dropped it?)
-        // Since we droppped it, we must re-populate it.
-        db_->exec("INSERT INTO members_fts(members_fts) VALUES('rebuild');");
-
-        // Triggers to keep FTS in sync with Members
-        db_->exec(R"(
-            CREATE TRIGGER IF NOT EXISTS members_ai AFTER INSERT ON members BEGIN
-              INSERT INTO members_fts(rowid, name, bio, aliases) VALUES (new.rowid, new.name, new.bio, new.aliases);
-            END;
-            CREATE TRIGGER IF NOT EXISTS members_ad AFTER DELETE ON members BEGIN
-              INSERT INTO members_fts(members_fts, rowid, name, bio, aliases) VALUES('delete', old.rowid, old.name, old.bio, old.aliases);
-            END;
-            CREATE TRIGGER IF NOT EXISTS members_au AFTER UPDATE ON members BEGIN
-              INSERT INTO members_fts(members_fts, rowid, name, bio, aliases) VALUES('delete', old.rowid, old.name, old.bio, old.aliases);
-              INSERT INTO members_fts(rowid, name, bio, aliases) VALUES (new.rowid, new.name, new.bio, new.aliases);
-            END;
-        )");
+int MembersFtsTriggerCount(SQLite::Database& db) {
+    SQLite::Statement query(db,
+                            "SELECT count(*) FROM sqlite_master WHERE type = 'trigger' AND "
+                            "name IN ('members_ai', 'members_ad', 'members_au')");
+    return query.executeStep() ? query.getColumn(0).getInt() : 0;
+}
 
-        // 3. Media Resources Table
-        // [Added] Table for v0.8 media support
-        db_->exec(R"(
-            CREATE TABLE IF NOT EXISTS media_resources (
-                id TEXT PRIMARY KEY,           -- Unique ID
-                member_id TEXT NOT NULL,       -- Foreign Key to Member
-                resource_type TEXT NOT NULL,   -- 'video', 'photo', 'audio'
-                file_path TEXT NOT NULL,       -- Relative path in resources dir
-                title TEXT,                    -- Display title
-                description TEXT,              -- Optional description
-                file_hash TEXT,                -- SHA256 or unique hash for deduplication
-                file_size INTEGER,             -- File size in bytes
-                created_at INTEGER,            -- Import timestamp
-                is_primary BOOLEAN DEFAULT 0,  -- Is this the primary profile video/photo?
-                FOREIGN KEY(member_id) REFERENCES members(id) ON DELETE CASCADE
-            );
-        )");
+// Creates or repairs members_fts over name/bio/aliases and its sync triggers, with the cjk
+// tokenizer when it is registered and unicode61 otherwise. An up-to-date table costs two
+// sqlite_master lookups; a missing one, or one built with the other tokenizer, is
+// recreated and rebuilt once. Returns the tokenizer in use, or nullptr if members_fts is
+// unusable; its triggers are then dropped so writes to members keep working without it.
+const char* EnsureMembersFts(SQLite::Database& db, bool cjkTokenizer) {
+    const char* tokenizer = cjkTokenizer ? kCjkTokenizerName : "unicode61";
+    std::string wanted = std::string("tokenize='") + tokenizer + "'";
+    try {
+        SQLite::Transaction transaction(db);
+        if (MembersFtsSql(db).find(wanted) == std::string::npos) {
+            LOGINFO("[DB] Building members_fts ({} tokenizer)", tokenizer);
+            DropMembersFtsTriggers(db);
+            db.exec("DROP TABLE IF EXISTS members_fts;");
+            db.exec(R"(
+                CREATE VIRTUAL TABLE members_fts USING fts5(
+                    name, bio, aliases, content='members', content_rowid='rowid', )" +
+                    wanted + ");");
+            db.exec("INSERT INTO members_fts(members_fts) VALUES('rebuild');");
+            CreateMembersFtsTriggers(db);
+        } else if (MembersFtsTriggerCount(db) != 3) {
+            // Triggers went missing (e.g. an interrupted import); resync the index as well
+            DropMembersFtsTriggers(db);
+            db.exec("INSERT INTO members_fts(members_fts) VALUES('rebuild');");
+            CreateMembersFtsTriggers(db);
+        }
+        transaction.commit();
+        return tokenizer;
+    } catch (std::exception& e) {
+        LOGWARN("[DB] members_fts unavailable ({}); search falls back to LIKE.", e.what());
+    }
+    try {
+        DropMembersFtsTriggers(db);
+    } catch (std::exception& e) {
+        LOGERROR("[DB] Failed to drop members_fts triggers: {}", e.what());
+    }
+    return nullptr;
+}
 
-        // 4. Settings Table
-        db_->exec(R"(
-            CREATE TABLE IF NOT EXISTS settings (
-                key TEXT PRIMARY KEY,
-                value TEXT NOT NULL,
-                updated_at INTEGER
-            );
-        )");
+// v4: per-target history lookups (GetMemberAtLog) walk one member's entries by id
+void AddOperationLogTargetIndex(SQLite::Database& db) {
+    db.exec(
+        "CREATE INDEX IF NOT EXISTS idx_logs_target "
+        "ON operation_logs(target_type, target_id, id);");
+}
 
-        // 5. Operation Logs Table
-        db_->exec(R"(
-            CREATE TABLE IF NOT EXISTS operation_logs (
-                id INTEGER PRIMARY KEY AUTOINCREMENT,
-                action TEXT NOT NULL,
-                target_type TEXT NOT NULL,
-                target_id TEXT NOT NULL,
-                target_name TEXT,
-                changes TEXT,
-                created_at INTEGER NOT NULL
-            );
-        )");
+// v5: keyset pages on (created_at, id), alone or behind an action or target filter, and
+// the table retention moves old entries into (same columns, ids kept)
+void AddOperationLogArchive(SQLite::Database& db) {
+    db.exec(R"(
+        DROP INDEX IF EXISTS idx_logs_created;
+        CREATE INDEX IF NOT EXISTS idx_logs_time ON operation_logs(created_at, id);
+        CREATE INDEX IF NOT EXISTS idx_logs_action_time
+            ON operation_logs(action, created_at, id);
+        CREATE INDEX IF NOT EXISTS idx_logs_target_time
+            ON operation_logs(target_type, target_id, created_at, id);
+
+        CREATE TABLE IF NOT EXISTS operation_logs_archive (
+            id INTEGER PRIMARY KEY,
+            action TEXT NOT NULL,
+            target_type TEXT NOT NULL,
+            target_id TEXT NOT NULL,
+            target_name TEXT,
+            changes TEXT,
+            created_at INTEGER NOT NULL
+        );
+        CREATE INDEX IF NOT EXISTS idx_logs_archive_time
+            ON operation_logs_archive(created_at, id);
+        CREATE INDEX IF NOT EXISTS idx_logs_archive_target
+            ON operation_logs_archive(target_type, target_id, id);
+    )");
+}
 
-        // Create Indexes
-        db_->exec("CREATE INDEX IF NOT EXISTS idx_members_father ON members(father_id);");
-        db_->exec("CREATE INDEX IF NOT EXISTS idx_media_member ON media_resources(member_id);");
-        db_->exec(
-            "CREATE INDEX IF NOT EXISTS idx_logs_created ON operation_logs(created_at DESC);");
-
-        // Initialize default generation names if not exist
-        SQLite::Statement checkSetting(
-            *db_, "SELECT COUNT(*) FROM settings WHERE key = 'generation_names'");
-        if (checkSetting.executeStep() && checkSetting.getColumn(0).getInt() == 0) {
-            db_->exec(R"(
-                INSERT INTO settings (key, value, updated_at) VALUES (
-                    'generation_names',
-                    '["始","定","英","华","富","贵","荣","昌","盛","德","永"]',
-                    0
-                );
-            )");
-            LOGINFO("[DB] Initialized default generation names.");
-        }
+}  // namespace
 
-        transaction.commit();
-        LOGINFO("[DB] Tables initialized successfully.");
+// Append new steps at the end with the next version number; never edit a shipped step.
+void DatabaseManager::MigrateSchema() {
+    if (!db_)
+        return;
 
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SchemaMigrator migrator(*db_);
+        auto applied = migrator.Migrate({
+            {1, "core tables", CreateCoreTables},
+            {2, "members.aliases", AddMemberAliases},
+            {3, "members_fts (moved to EnsureMembersFts)", SkipMembersFts},
+            {4, "operation_logs target index", AddOperationLogTargetIndex},
+            {5, "operation_logs keyset indexes and archive", AddOperationLogArchive},
+        });
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        LOGINFO("[DB] Schema at v{} ({} migration(s) applied, {} ms)", migrator.CurrentVersion(),
+                applied.size(), ms);
     } catch (std::exception& e) {
-        LOGERROR("[DB] CreateTables failed: {}", e.what());
+        LOGERROR("[DB] MigrateSchema failed: {}", e.what());
     }
 }
 
-void DatabaseManager::CheckFTSSupport() {
+void DatabaseManager::CheckFTSSupport(bool cjkTokenizer) {
+    fts_available_ = false;
+    fts_cjk_ = false;
     if (!db_)
         return;
+    const char* tokenizer = EnsureMembersFts(*db_, cjkTokenizer);
+    if (!tokenizer)
+        return;
+    fts_cjk_ = tokenizer == kCjkTokenizerName;
     try {
-        // Simple check query
-        SQLite::Statement query(*db_,
-                                "SELECT count(*) FROM members_fts WHERE members_fts MATCH 'test'");
+        // Stepping (not just preparing) exercises the fts5 module and the index itself
+        auto query = statements_->Acquire(
+            "SELECT count(*) FROM members_fts WHERE members_fts MATCH 'test'");
+        query->executeStep();
+        fts_available_ = true;
         LOGINFO("[DB] FTS5 is active.");
     } catch (std::exception& e) {
-        LOGWARN("[DB] FTS5 check failed (Msg: {}). Search might be limited.", e.what());
+        LOGWARN("[DB] FTS5 check failed (Msg: {}). Search falls back to LIKE.", e.what());
     }
 }
 
+// Load every member except the bio into the resident kinship index.
+// Called from Initialize() and after bulk imports; otherwise the write paths patch it.
+void DatabaseManager::RebuildKinshipIndex() {
+    if (!db_)
+        return;
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SQLite::Statement query(
+            *db_, "SELECT " + MemberSelectList({}, /*withBio=*/false) + " FROM members");
+
+        std::vector<Member> members;
+        while (query.executeStep()) {
+            Member m;
+            ReadMember(query, m);
+            members.push_back(std::move(m));
+        }
+
+        size_t count = members.size();
+        kinship_.Build(std::move(members));
+        tree_changes_.Reset();
+        DropCachedMembers({});
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        LOGINFO("[DB] Kinship index built: {} members in {} ms", count, ms);
+    } catch (std::exception& e) {
+        LOGERROR("[DB] RebuildKinshipIndex failed: {}", e.what());
+    }
+}
+
+DatabaseManager::ReadLease DatabaseManager::AcquireReader() {
+    if (auto pooled = readers_.Acquire()) {
+        return ReadLease(std::move(pooled));
+    }
+    // Pool off (single-connection mode, in-memory database) or being reopened
+    std::unique_lock<std::mutex> lock(db_mutex_);
+    StatementCache* statements = statements_.get();
+    return ReadLease(std::move(lock), statements);
+}
+
 // ---------------------------------------------------------
 // Member Operations
 // ---------------------------------------------------------
 
 std::vector<Member> DatabaseManager::GetAllMembers() {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    auto reader = AcquireReader();
     std::vector<Member> result;
-    if (!db_)
+    if (!reader)
         return result;
 
     try {
-        SQLite::Statement query(*db_, "SELECT * FROM members ORDER BY generation ASC");
+        static const std::string sql =
+            "SELECT " + MemberSelectList() + " FROM members ORDER BY generation ASC";
+        auto query = reader->Acquire(sql);
 
-        while (query.executeStep()) {
-            Member m;
-            m.id = query.getColumn("id").getText();
-            m.name = query.getColumn("name").getText();
-            m.gender = query.getColumn("gender").getText();
-            m.generation = query.getColumn("generation").getInt();
-            m.generation_name = query.getColumn("generation_name").getText();
-
-            // Handle nullable fields
-            if (!query.getColumn("father_id").isNull())
-                m.father_id = query.getColumn("father_id").getText();
-            if (!query.getColumn("mother_id").isNull())
-                m.mother_id = query.getColumn("mother_id").getText();
-            if (!query.getColumn("spouse_name").isNull())
-                m.spouse_name = query.getColumn("spouse_name").getText();
-
-            m.birth_date = query.getColumn("birth_date").getText();
-            m.death_date = query.getColumn("death_date").getText();
-            m.birth_place = query.getColumn("birth_place").getText();
-            m.death_place = query.getColumn("death_place").getText();
-
-            m.portrait_path = query.getColumn("portrait_path").getText();
-            m.bio = query.getColumn("bio").getText();
-            if (!query.getColumn("aliases").isNull())
-                m.aliases = query.getColumn("aliases").getText();
-
-            result.push_back(m);
+        while (query->executeStep()) {
+            Member& m = result.emplace_back();
+            ReadMember(*query, m);
         }
     } catch (std::exception& e) {
         LOGERROR("[DB] GetAllMembers failed: {}", e.what());
@@ -293,37 +527,37 @@ std::vector<Member> DatabaseManager::GetAllMembers() {
 }
 
 Member DatabaseManager::GetMemberById(const std::string& id) {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    bool useCache = member_cache_enabled_;
+    if (useCache) {
+        if (auto cached = member_cache_.Get(id)) {
+            ++member_cache_hits_;
+            return std::move(*cached);
+        }
+        ++member_cache_misses_;
+    }
+
+    uint64_t epoch;
+    {
+        std::lock_guard<std::mutex> lock(member_cache_mutex_);
+        epoch = member_cache_epoch_;
+    }
+    auto reader = AcquireReader();
     Member m;
-    if (!db_)
+    if (!reader)
         return m;
 
     try {
-        SQLite::Statement query(*db_, "SELECT * FROM members WHERE id = ?");
-        query.bind(1, id);
-
-        if (query.executeStep()) {
-            m.id = query.getColumn("id").getText();
-            m.name = query.getColumn("name").getText();
-            m.gender = query.getColumn("gender").getText();
-            m.generation = query.getColumn("generation").getInt();
-            m.generation_name = query.getColumn("generation_name").getText();
-
-            if (!query.getColumn("father_id").isNull())
-                m.father_id = query.getColumn("father_id").getText();
-            if (!query.getColumn("mother_id").isNull())
-                m.mother_id = query.getColumn("mother_id").getText();
-            if (!query.getColumn("spouse_name").isNull())
-                m.spouse_name = query.getColumn("spouse_name").getText();
-
-            m.birth_date = query.getColumn("birth_date").getText();
-            m.death_date = query.getColumn("death_date").getText();
-            m.birth_place = query.getColumn("birth_place").getText();
-            m.death_place = query.getColumn("death_place").getText();
-            m.portrait_path = query.getColumn("portrait_path").getText();
-            m.bio = query.getColumn("bio").getText();
-            if (!query.getColumn("aliases").isNull())
-                m.aliases = query.getColumn("aliases").getText();
+        static const std::string sql =
+            "SELECT " + MemberSelectList() + " FROM members WHERE id = ?";
+        auto query = reader->Acquire(sql);
+        query->bind(1, id);
+
+        if (query->executeStep()) {
+            ReadMember(*query, m);
+            std::lock_guard<std::mutex> lock(member_cache_mutex_);
+            if (useCache && member_cache_epoch_ == epoch) {
+                member_cache_.Put(id, m);
+            }
         }
     } catch (std::exception& e) {
         LOGERROR("[DB] GetMemberById failed: {}", e.what());
@@ -331,87 +565,124 @@ Member DatabaseManager::GetMemberById(const std::string& id) {
     return m;
 }
 
-std::vector<Member> DatabaseManager::SearchMembers(const std::string& keyword) {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    std::vector<Member> result;
-    if (!db_)
+MemberCacheStats DatabaseManager::GetMemberCacheStats() const {
+    return {member_cache_hits_.load(), member_cache_misses_.load(), member_cache_.size(),
+            member_cache_.cost()};
+}
+
+size_t DatabaseManager::GetReadConnectionCount() const {
+    return readers_.size();
+}
+
+void DatabaseManager::DropCachedMembers(const std::string& id) {
+    std::lock_guard<std::mutex> lock(member_cache_mutex_);
+    ++member_cache_epoch_;
+    if (id.empty()) {
+        member_cache_.Clear();
+    } else {
+        member_cache_.Erase(id);
+    }
+}
+
+std::vector<Member> DatabaseManager::SearchMembers(const std::string& keyword, int limit) {
+    std::vector<std::string> tokens = SplitKeywords(keyword);
+    if (tokens.empty())
+        return {};
+
+    // Read before querying: a write that races the query tags it with the older revision
+    uint64_t revision = tree_changes_.revision();
+    auto hits = search_cache_.Search(tokens, limit, revision, [&] {
+        SearchCache::Result result;
+        auto reader = AcquireReader();
+        if (!reader)
+            return result;
+
+        // Without the cjk tokenizer, members_fts uses unicode61, which keeps a run of CJK
+        // characters as one token; CJK keywords then stay on the LIKE path.
+        bool useFts = fts_available_ &&
+                      (fts_cjk_ || std::all_of(tokens.begin(), tokens.end(), IsAsciiToken));
+        result.fts = useFts && SearchMembersFts(*reader, tokens, limit, result.members);
+        if (!result.fts) {
+            result.members.clear();
+            SearchMembersLike(*reader, tokens, limit, result.members);
+        }
+
+        // father_name comes from the resident index instead of a self-join
+        for (auto& m : result.members) {
+            if (auto node = kinship_.Find(m.id)) {
+                m.father_name = std::move(node->father_name);
+            }
+        }
         return result;
+    });
+    return hits->members;
+}
 
+// Ranked full-text search: every keyword is a prefix query over name, aliases and bio,
+// ordered by bm25 with name hits weighted above alias hits, and both above bio hits.
+// Returns false if the MATCH failed so the caller can fall back to LIKE.
+bool DatabaseManager::SearchMembersFts(StatementCache& statements,
+                                       const std::vector<std::string>& tokens, int limit,
+                                       std::vector<Member>& result) {
     try {
-        // Tokenize keyword
-        std::istringstream iss(keyword);
-        std::vector<std::string> tokens;
-        std::string token;
-        while (iss >> token) {
-            tokens.push_back(token);
+        // Rank and cut inside FTS5 first, then fetch only the surviving rows from members.
+        // bm25 weights follow the members_fts column order: name, bio, aliases.
+        static const std::string sql = "SELECT " + MemberSelectList("m.") + R"(
+                FROM (SELECT rowid, rank FROM members_fts
+                      WHERE members_fts MATCH ? AND rank MATCH 'bm25(10.0, 1.0, 5.0)'
+                      ORDER BY rank LIMIT ?) hit
+                JOIN members m ON m.rowid = hit.rowid
+                ORDER BY hit.rank)";
+        auto query = statements.Acquire(sql);
+        std::string match = BuildFtsQuery(tokens);
+        if (match.empty()) {
+            return true;  // punctuation only
         }
+        query->bind(1, match);
+        query->bind(2, limit);
 
-        if (tokens.empty())
-            return result;
+        while (query->executeStep()) {
+            Member& m = result.emplace_back();
+            ReadMember(*query, m);
+        }
+        return true;
+    } catch (std::exception& e) {
+        LOGWARN("[DB] SearchMembers (FTS) failed, falling back to LIKE: {}", e.what());
+        return false;
+    }
+}
 
-        // Build SQL Query using LIKE
+void DatabaseManager::SearchMembersLike(StatementCache& statements,
+                                        const std::vector<std::string>& tokens, int limit,
+                                        std::vector<Member>& result) {
+    try {
         // "SELECT ... WHERE (name LIKE ? OR aliases LIKE ?) OR (name LIKE ? OR aliases LIKE ?) ..."
-        std::string sql = R"(
-                SELECT m.*, f.name as father_name
-                FROM members m
-                LEFT JOIN members f ON m.father_id = f.id
-                WHERE 
-            )";
-
+        std::string sql = "SELECT " + MemberSelectList() + " FROM members WHERE ";
         for (size_t i = 0; i < tokens.size(); ++i) {
             if (i > 0)
                 sql += " OR ";
-            sql += " (m.name LIKE ? OR IFNULL(m.aliases, '') LIKE ?) ";
+            sql += "(name LIKE ? OR IFNULL(aliases, '') LIKE ?)";
         }
-
         // Order by generation for a sensible default
-        sql += " ORDER BY m.generation ASC, m.name ASC";
+        sql += " ORDER BY generation ASC, name ASC LIMIT ?";
 
-        SQLite::Statement query(*db_, sql);
+        auto query = statements.Acquire(sql);
 
-        // Bind parameters
         int paramIdx = 1;
         for (const auto& t : tokens) {
             std::string pattern = "%" + t + "%";
-            query.bind(paramIdx++, pattern);
-            query.bind(paramIdx++, pattern);
+            query->bind(paramIdx++, pattern);
+            query->bind(paramIdx++, pattern);
         }
+        query->bind(paramIdx, limit);
 
-        while (query.executeStep()) {
-            Member m;
-            m.id = query.getColumn("id").getText();
-            m.name = query.getColumn("name").getText();
-            m.gender = query.getColumn("gender").getText();
-            m.generation = query.getColumn("generation").getInt();
-            m.generation_name = query.getColumn("generation_name").getText();
-
-            if (!query.getColumn("father_id").isNull()) {
-                m.father_id = query.getColumn("father_id").getText();
-            }
-            if (!query.getColumn("father_name").isNull()) {
-                m.father_name = query.getColumn("father_name").getText();
-            }
-
-            if (!query.getColumn("mother_id").isNull())
-                m.mother_id = query.getColumn("mother_id").getText();
-            if (!query.getColumn("spouse_name").isNull())
-                m.spouse_name = query.getColumn("spouse_name").getText();
-
-            m.birth_date = query.getColumn("birth_date").getText();
-            m.death_date = query.getColumn("death_date").getText();
-            m.birth_place = query.getColumn("birth_place").getText();
-            m.death_place = query.getColumn("death_place").getText();
-            m.portrait_path = query.getColumn("portrait_path").getText();
-            m.bio = query.getColumn("bio").getText();
-            if (!query.getColumn("aliases").isNull())
-                m.aliases = query.getColumn("aliases").getText();
-
-            result.push_back(m);
+        while (query->executeStep()) {
+            Member& m = result.emplace_back();
+            ReadMember(*query, m);
         }
     } catch (std::exception& e) {
         LOGERROR("[DB] SearchMembers (LIKE) failed: {}", e.what());
     }
-    return result;
 }
 
 bool DatabaseManager::UpdateMemberPortrait(const std::string& memberId,
@@ -424,16 +695,30 @@ bool DatabaseManager::UpdateMemberPortrait(const std::string& memberId,
 
     try {
         // 使用参数化查询防止注入
-        SQLite::Statement query(*db_, "UPDATE members SET portrait_path = ? WHERE id = ?");
+        auto query = statements_->Acquire("UPDATE members SET portrait_path = ? WHERE id = ?");
 
         // 绑定参数
-        query.bind(1, portraitPath);
-        query.bind(2, memberId);
+        query->bind(1, portraitPath);
+        query->bind(2, memberId);
 
         // 执行更新
-        int rowsAffected = query.exec();
+        int rowsAffected = query->exec();
 
         if (rowsAffected > 0) {
+            {
+                // Only the portrait changed, so a cached record stays valid once patched
+                std::lock_guard<std::mutex> cacheLock(member_cache_mutex_);
+                ++member_cache_epoch_;
+                if (auto cached = member_cache_.Get(memberId)) {
+                    cached->portrait_path = portraitPath;
+                    member_cache_.Put(memberId, std::move(*cached));
+                }
+            }
+            if (auto summary = kinship_.Find(memberId)) {
+                summary->portrait_path = portraitPath;
+                kinship_.Upsert(*summary);
+                tree_changes_.Record(TreeChangeKind::kUpdate, std::move(*summary));
+            }
             LOGINFO("[DB] Updated portrait for member {}: {}", memberId, portraitPath);
             return true;
         } else {
@@ -450,78 +735,88 @@ bool DatabaseManager::UpdateMemberPortrait(const std::string& memberId,
 
 // Insert a new media resource record
 void DatabaseManager::AddMediaResource(const MediaResource& res) {
+    if (AddMediaResources({res})) {
+        LOGINFO("[DB] Added media resource: {}", res.title);
+    }
+}
+
+// Insert media resource records in one transaction (all or nothing)
+bool DatabaseManager::AddMediaResources(const std::vector<MediaResource>& resources) {
     std::lock_guard<std::mutex> lock(db_mutex_);
     if (!db_)
-        return;
+        return false;
 
     try {
+        SQLite::Transaction transaction(*db_);
         // Using REPLACE to handle potential duplicate IDs if logic changes
-        SQLite::Statement query(*db_, R"(
+        auto query = statements_->Acquire(R"(
             INSERT OR REPLACE INTO media_resources
             (id, member_id, resource_type, file_path, title, description, file_hash, file_size, created_at)
             VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
         )");
 
-        query.bind(1, res.id);
-        query.bind(2, res.member_id);
-        query.bind(3, res.resource_type);
-        query.bind(4, res.file_path);
-        query.bind(5, res.title);
-        query.bind(6, res.description);
-        query.bind(7, res.file_hash);
-
-        //  Explicit cast to int64_t to resolve overload ambiguity
-        query.bind(8, static_cast<int64_t>(res.file_size));
-
         // Use current timestamp if not provided
         // Explicit type int64_t for 'now'
         int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
                           std::chrono::system_clock::now().time_since_epoch())
                           .count();
-        query.bind(9, now);
-
-        query.exec();
-        LOGINFO("[DB] Added media resource: {}", res.title);
+        for (const auto& res : resources) {
+            query->bind(1, res.id);
+            query->bind(2, res.member_id);
+            query->bind(3, res.resource_type);
+            query->bind(4, res.file_path);
+            query->bind(5, res.title);
+            query->bind(6, res.description);
+            query->bind(7, res.file_hash);
+            //  Explicit cast to int64_t to resolve overload ambiguity
+            query->bind(8, static_cast<int64_t>(res.file_size));
+            query->bind(9, now);
+            query->exec();
+            query->reset();
+        }
+        transaction.commit();
+        return true;
     } catch (std::exception& e) {
-        LOGERROR("[DB] AddMediaResource failed: {}", e.what());
+        LOGERROR("[DB] AddMediaResources failed ({} rows): {}", resources.size(), e.what());
+        return false;
     }
 }
 
 // Query resources by member ID and type
 std::vector<MediaResource> DatabaseManager::GetMediaResources(const std::string& memberId,
                                                               const std::string& type) {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    auto reader = AcquireReader();
     std::vector<MediaResource> list;
-    if (!db_)
+    if (!reader)
         return list;
 
     try {
-        SQLite::Statement query(*db_, R"(
+        auto query = reader->Acquire(R"(
             SELECT * FROM media_resources
             WHERE member_id = ? AND resource_type = ?
             ORDER BY created_at DESC
         )");
 
-        query.bind(1, memberId);
-        query.bind(2, type);
+        query->bind(1, memberId);
+        query->bind(2, type);
 
-        while (query.executeStep()) {
+        while (query->executeStep()) {
             MediaResource res;
-            res.id = query.getColumn("id").getText();
-            res.member_id = query.getColumn("member_id").getText();
-            res.resource_type = query.getColumn("resource_type").getText();
-            res.file_path = query.getColumn("file_path").getText();
-            res.title = query.getColumn("title").getText();
+            res.id = query->getColumn("id").getText();
+            res.member_id = query->getColumn("member_id").getText();
+            res.resource_type = query->getColumn("resource_type").getText();
+            res.file_path = query->getColumn("file_path").getText();
+            res.title = query->getColumn("title").getText();
 
             // Handle nullable columns safely
-            if (!query.getColumn("description").isNull())
-                res.description = query.getColumn("description").getText();
+            if (!query->getColumn("description").isNull())
+                res.description = query->getColumn("description").getText();
 
-            if (!query.getColumn("file_hash").isNull())
-                res.file_hash = query.getColumn("file_hash").getText();
+            if (!query->getColumn("file_hash").isNull())
+                res.file_hash = query->getColumn("file_hash").getText();
 
-            res.file_size = query.getColumn("file_size").getInt64();
-            res.created_at = query.getColumn("created_at").getInt64();
+            res.file_size = query->getColumn("file_size").getInt64();
+            res.created_at = query->getColumn("created_at").getInt64();
 
             list.push_back(res);
         }
@@ -537,9 +832,9 @@ bool DatabaseManager::DeleteMediaResource(const std::string& resourceId) {
         return false;
 
     try {
-        SQLite::Statement query(*db_, "DELETE FROM media_resources WHERE id = ?");
-        query.bind(1, resourceId);
-        query.exec();
+        auto query = statements_->Acquire("DELETE FROM media_resources WHERE id = ?");
+        query->bind(1, resourceId);
+        query->exec();
         return true;
     } catch (std::exception& e) {
         LOGERROR("[DB] DeleteMediaResource failed: {}", e.what());
@@ -555,9 +850,12 @@ void DatabaseManager::SaveMember(const Member& m) {
 
     try {
         // Check if member exists
-        SQLite::Statement checkQuery(*db_, "SELECT id FROM members WHERE id = ?");
-        checkQuery.bind(1, m.id);
-        bool exists = checkQuery.executeStep();
+        bool exists = false;
+        {
+            auto checkQuery = statements_->Acquire("SELECT id FROM members WHERE id = ?");
+            checkQuery->bind(1, m.id);
+            exists = checkQuery->executeStep();
+        }
 
         int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
                           std::chrono::system_clock::now().time_since_epoch())
@@ -565,7 +863,7 @@ void DatabaseManager::SaveMember(const Member& m) {
 
         if (exists) {
             // Update existing member
-            SQLite::Statement query(*db_, R"(
+            auto query = statements_->Acquire(R"(
                 UPDATE members SET
                     name = ?, gender = ?, generation = ?, generation_name = ?,
                     father_id = ?, spouse_name = ?, mother_id = ?,
@@ -573,73 +871,298 @@ void DatabaseManager::SaveMember(const Member& m) {
                     portrait_path = ?, bio = ?, aliases = ?, updated_at = ?
                 WHERE id = ?
             )");
-            query.bind(1, m.name);
-            query.bind(2, m.gender);
-            query.bind(3, m.generation);
-            query.bind(4, m.generation_name);
-            query.bind(5, m.father_id);
-            query.bind(6, m.spouse_name);
-            query.bind(7, m.mother_id);
-            query.bind(8, m.birth_date);
-            query.bind(9, m.death_date);
-            query.bind(10, m.birth_place);
-            query.bind(11, m.death_place);
-            query.bind(12, m.portrait_path);
-            query.bind(13, m.bio);
-            query.bind(14, m.aliases);
-            query.bind(15, now);
-            query.bind(16, m.id);
-            query.exec();
+            query->bind(1, m.name);
+            query->bind(2, m.gender);
+            query->bind(3, m.generation);
+            query->bind(4, m.generation_name);
+            query->bind(5, m.father_id);
+            query->bind(6, m.spouse_name);
+            query->bind(7, m.mother_id);
+            query->bind(8, m.birth_date);
+            query->bind(9, m.death_date);
+            query->bind(10, m.birth_place);
+            query->bind(11, m.death_place);
+            query->bind(12, m.portrait_path);
+            query->bind(13, m.bio);
+            query->bind(14, m.aliases);
+            query->bind(15, now);
+            query->bind(16, m.id);
+            query->exec();
             LOGINFO("[DB] Updated member: {} (id={})", m.name, m.id);
         } else {
             // Insert new member
-            SQLite::Statement query(*db_, R"(
+            auto query = statements_->Acquire(R"(
                 INSERT INTO members (id, name, gender, generation, generation_name,
                     father_id, spouse_name, mother_id, birth_date, death_date,
                     birth_place, death_place, portrait_path, bio, aliases, created_at, updated_at)
                 VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
             )");
-            query.bind(1, m.id);
-            query.bind(2, m.name);
-            query.bind(3, m.gender);
-            query.bind(4, m.generation);
-            query.bind(5, m.generation_name);
-            query.bind(6, m.father_id);
-            query.bind(7, m.spouse_name);
-            query.bind(8, m.mother_id);
-            query.bind(9, m.birth_date);
-            query.bind(10, m.death_date);
-            query.bind(11, m.birth_place);
-            query.bind(12, m.death_place);
-            query.bind(13, m.portrait_path);
-            query.bind(14, m.bio);
-            query.bind(15, m.aliases);
-            query.bind(16, now);
-            query.bind(17, now);
-            query.exec();
+            query->bind(1, m.id);
+            query->bind(2, m.name);
+            query->bind(3, m.gender);
+            query->bind(4, m.generation);
+            query->bind(5, m.generation_name);
+            query->bind(6, m.father_id);
+            query->bind(7, m.spouse_name);
+            query->bind(8, m.mother_id);
+            query->bind(9, m.birth_date);
+            query->bind(10, m.death_date);
+            query->bind(11, m.birth_place);
+            query->bind(12, m.death_place);
+            query->bind(13, m.portrait_path);
+            query->bind(14, m.bio);
+            query->bind(15, m.aliases);
+            query->bind(16, now);
+            query->bind(17, now);
+            query->exec();
             LOGINFO("[DB] Inserted new member: {} (id={})", m.name, m.id);
         }
+        DropCachedMembers(m.id);
+        kinship_.Upsert(m);
+        tree_changes_.Record(exists ? TreeChangeKind::kUpdate : TreeChangeKind::kAdd,
+                             kinship_.Find(m.id).value_or(m));
     } catch (std::exception& e) {
         LOGERROR("[DB] SaveMember failed: {}", e.what());
     }
 }
 
-// Check if a member has children
-bool DatabaseManager::HasChildren(const std::string& memberId) {
+// ---------------------------------------------------------
+// Batch Import
+// ---------------------------------------------------------
+
+ImportResult DatabaseManager::ImportMembers(MemberSource& source,
+                                            const ImportProgressFn& onProgress) {
+    constexpr size_t kProgressInterval = 10000;
+
     std::lock_guard<std::mutex> lock(db_mutex_);
-    if (!db_)
-        return false;
+    ImportResult result;
+    if (!db_) {
+        result.error = "Database is not open";
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    };
 
     try {
-        SQLite::Statement query(*db_, "SELECT COUNT(*) FROM members WHERE father_id = ?");
-        query.bind(1, memberId);
-        if (query.executeStep()) {
-            return query.getColumn(0).getInt() > 0;
+        SQLite::Transaction transaction(*db_);
+        bool fts = fts_available_;
+        if (fts) {
+            DropMembersFtsTriggers(*db_);  // restored by the rollback if the import fails
+        }
+
+        // FatherName -> id. Existing members first, so rows can attach to them; within the
+        // file the latest row with a name wins, i.e. the nearest preceding namesake.
+        std::unordered_map<std::string, std::string> idsByName;
+        // (name, father id) -> id of an existing member. Rows without an Id column are
+        // matched on it, so re-importing the same file updates members instead of adding
+        // a second copy of each.
+        std::unordered_map<std::string, std::string> idsByNaturalKey;
+        auto naturalKey = [](const std::string& name, const std::string& fatherId) {
+            return name + '\x1f' + fatherId;
+        };
+        {
+            SQLite::Statement names(*db_, "SELECT id, name, IFNULL(father_id, '') FROM members");
+            while (names.executeStep()) {
+                std::string id = names.getColumn(0).getString();
+                std::string name = names.getColumn(1).getString();
+                idsByNaturalKey.insert_or_assign(naturalKey(name, names.getColumn(2).getString()),
+                                                 id);
+                idsByName.insert_or_assign(std::move(name), std::move(id));
+            }
         }
+        // Existing ids already claimed by a row, so two rows never merge into one member
+        std::unordered_set<std::string> matchedIds;
+        // Children listed before their father: (child id, father name)
+        std::vector<std::pair<std::string, std::string>> pending;
+
+        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+
+        // One statement for both cases: UPSERT keeps created_at and, unlike INSERT OR
+        // REPLACE, never deletes the row (which would cascade to media_resources). An
+        // update only takes the columns the source supplies (?18, ImportColumn bits); the
+        // others keep what the app stored, e.g. portraits and aliases.
+        static const std::string upsertSql = [] {
+            std::string sql = R"(
+            INSERT INTO members (id, name, gender, generation, generation_name,
+                father_id, spouse_name, mother_id, birth_date, death_date,
+                birth_place, death_place, portrait_path, bio, aliases, created_at, updated_at)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+            ON CONFLICT(id) DO UPDATE SET name = excluded.name, updated_at = excluded.updated_at)";
+            static constexpr std::pair<const char*, ImportColumn> kColumns[] = {
+                {"gender", kImportGender},
+                {"generation", kImportGeneration},
+                {"generation_name", kImportGenerationName},
+                {"father_id", kImportFather},
+                {"spouse_name", kImportSpouse},
+                {"mother_id", kImportMother},
+                {"birth_date", kImportBirthDate},
+                {"death_date", kImportDeathDate},
+                {"birth_place", kImportBirthPlace},
+                {"death_place", kImportDeathPlace},
+                {"portrait_path", kImportPortrait},
+                {"bio", kImportBio},
+                {"aliases", kImportAliases},
+            };
+            for (const auto& [column, bit] : kColumns) {
+                sql += std::string(",\n                ") + column + " = CASE WHEN ?18 & " +
+                       std::to_string(bit) + " THEN excluded." + column + " ELSE " + column +
+                       " END";
+            }
+            return sql;
+        }();
+        auto upsert = statements_->Acquire(upsertSql);
+
+        ImportRecord record;
+        while (source.Next(record)) {
+            Member& m = record.member;
+            if (m.name.empty()) {
+                ++result.skipped;
+                continue;
+            }
+            bool fatherPending = false;
+            if (m.father_id.empty() && !record.father_name.empty()) {
+                auto it = idsByName.find(record.father_name);
+                if (it != idsByName.end()) {
+                    m.father_id = it->second;
+                } else {
+                    fatherPending = true;
+                }
+            }
+            if (m.id.empty()) {
+                // Until a pending father resolves, the row is stored without one, which is
+                // also how an earlier import of it was stored
+                auto it = idsByNaturalKey.find(naturalKey(m.name, m.father_id));
+                if (it != idsByNaturalKey.end() && matchedIds.insert(it->second).second) {
+                    m.id = it->second;
+                    ++result.matched;
+                } else {
+                    m.id = GenerateMemberId();
+                }
+            } else {
+                matchedIds.insert(m.id);
+            }
+            if (fatherPending) {
+                pending.emplace_back(m.id, std::move(record.father_name));
+            }
+            idsByName.insert_or_assign(m.name, m.id);
+
+            upsert->bind(1, m.id);
+            upsert->bind(2, m.name);
+            upsert->bind(3, m.gender);
+            upsert->bind(4, m.generation);
+            upsert->bind(5, m.generation_name);
+            upsert->bind(6, m.father_id);
+            upsert->bind(7, m.spouse_name);
+            upsert->bind(8, m.mother_id);
+            upsert->bind(9, m.birth_date);
+            upsert->bind(10, m.death_date);
+            upsert->bind(11, m.birth_place);
+            upsert->bind(12, m.death_place);
+            upsert->bind(13, m.portrait_path);
+            upsert->bind(14, m.bio);
+            upsert->bind(15, m.aliases);
+            upsert->bind(16, now);
+            upsert->bind(17, now);
+            upsert->bind(18, static_cast<int64_t>(record.columns));
+            upsert->exec();
+            upsert->reset();
+
+            if (++result.imported % kProgressInterval == 0 && onProgress) {
+                onProgress({result.imported, false});
+            }
+        }
+
+        // Forward references, resolved against the complete name map
+        if (!pending.empty()) {
+            auto link = statements_->Acquire("UPDATE members SET father_id = ? WHERE id = ?");
+            for (const auto& [childId, fatherName] : pending) {
+                auto it = idsByName.find(fatherName);
+                if (it == idsByName.end()) {
+                    ++result.unresolved_fathers;
+                    continue;
+                }
+                link->bind(1, it->second);
+                link->bind(2, childId);
+                link->exec();
+                link->reset();
+            }
+        }
+
+        if (fts) {
+            if (onProgress) {
+                onProgress({result.imported, true});
+            }
+            db_->exec("INSERT INTO members_fts(members_fts) VALUES('rebuild');");
+            CreateMembersFtsTriggers(*db_);
+        }
+        transaction.commit();
     } catch (std::exception& e) {
-        LOGERROR("[DB] HasChildren failed: {}", e.what());
+        result.error = e.what();
+        result.elapsed_ms = elapsedMs();
+        LOGERROR("[DB] ImportMembers failed after {} rows: {}", result.imported, e.what());
+        return result;
     }
-    return false;
+
+    // The index and change feed restart from the new contents; clients resync
+    RebuildKinshipIndex();
+
+    result.ok = true;
+    result.elapsed_ms = elapsedMs();
+    LOGINFO("[DB] Imported {} members ({} matched by name and father, {} skipped, {} "
+            "unresolved fathers) in {} ms",
+            result.imported, result.matched, result.skipped, result.unresolved_fathers,
+            result.elapsed_ms);
+    return result;
+}
+
+// Check if a member has children (father or mother link), served from the kinship index
+bool DatabaseManager::HasChildren(const std::string& memberId) {
+    return kinship_.HasChildren(memberId);
+}
+
+std::vector<Member> DatabaseManager::GetTreeMembers(std::vector<int32_t>* fatherIndex) {
+    return kinship_.GetAll(fatherIndex);
+}
+
+uint64_t DatabaseManager::GetTreeRevision() {
+    return tree_changes_.revision();
+}
+
+TreeDelta DatabaseManager::GetTreeDelta(uint64_t sinceRevision) {
+    return tree_changes_.Since(sinceRevision);
+}
+
+std::vector<Member> DatabaseManager::GetChildren(const std::string& memberId) {
+    return kinship_.GetChildren(memberId);
+}
+
+std::vector<Member> DatabaseManager::GetAncestors(const std::string& memberId, int maxDepth) {
+    return kinship_.GetAncestors(memberId, maxDepth);
+}
+
+std::vector<Member> DatabaseManager::GetDescendants(const std::string& memberId, int maxDepth) {
+    return kinship_.GetDescendants(memberId, maxDepth);
+}
+
+TreePage DatabaseManager::GetSubtree(const std::string& rootId, int depth, size_t limit) {
+    return kinship_.GetSubtree(rootId, depth, limit);
+}
+
+TreePage DatabaseManager::GetChildPage(const std::string& memberId, size_t offset,
+                                       size_t limit) {
+    return kinship_.GetChildPage(memberId, offset, limit);
+}
+
+TreePage DatabaseManager::GetGenerationRange(int minGeneration, int maxGeneration, size_t offset,
+                                             size_t limit) {
+    return kinship_.GetGenerationRange(minGeneration, maxGeneration, offset, limit);
 }
 
 // Delete a member
@@ -649,10 +1172,15 @@ bool DatabaseManager::DeleteMember(const std::string& memberId) {
         return false;
 
     try {
-        SQLite::Statement query(*db_, "DELETE FROM members WHERE id = ?");
-        query.bind(1, memberId);
-        int rows = query.exec();
+        auto query = statements_->Acquire("DELETE FROM members WHERE id = ?");
+        query->bind(1, memberId);
+        int rows = query->exec();
         if (rows > 0) {
+            DropCachedMembers(memberId);
+            kinship_.Remove(memberId);
+            Member removed;
+            removed.id = memberId;
+            tree_changes_.Record(TreeChangeKind::kRemove, std::move(removed));
             LOGINFO("[DB] Deleted member: {}", memberId);
             return true;
         }
@@ -664,15 +1192,15 @@ bool DatabaseManager::DeleteMember(const std::string& memberId) {
 
 // Get a setting value
 std::string DatabaseManager::GetSetting(const std::string& key) {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    if (!db_)
+    auto reader = AcquireReader();
+    if (!reader)
         return "";
 
     try {
-        SQLite::Statement query(*db_, "SELECT value FROM settings WHERE key = ?");
-        query.bind(1, key);
-        if (query.executeStep()) {
-            return query.getColumn(0).getText();
+        auto query = reader->Acquire("SELECT value FROM settings WHERE key = ?");
+        query->bind(1, key);
+        if (query->executeStep()) {
+            return query->getColumn(0).getText();
         }
     } catch (std::exception& e) {
         LOGERROR("[DB] GetSetting failed: {}", e.what());
@@ -691,75 +1219,225 @@ void DatabaseManager::SaveSetting(const std::string& key, const std::string& val
                           std::chrono::system_clock::now().time_since_epoch())
                           .count();
 
-        SQLite::Statement query(*db_, R"(
+        auto query = statements_->Acquire(R"(
             INSERT OR REPLACE INTO settings (key, value, updated_at) VALUES (?, ?, ?)
         )");
-        query.bind(1, key);
-        query.bind(2, value);
-        query.bind(3, now);
-        query.exec();
+        query->bind(1, key);
+        query->bind(2, value);
+        query->bind(3, now);
+        query->exec();
         LOGINFO("[DB] Saved setting: {}", key);
     } catch (std::exception& e) {
         LOGERROR("[DB] SaveSetting failed: {}", e.what());
     }
 }
 
-// Add an operation log entry
+// Queue an operation log entry for the background writer
 void DatabaseManager::AddOperationLog(const std::string& action, const std::string& targetType,
                                       const std::string& targetId, const std::string& targetName,
                                       const std::string& changes) {
+    op_logs_.Append({.action = action,
+                     .target_type = targetType,
+                     .target_id = targetId,
+                     .target_name = targetName,
+                     .changes = changes});
+}
+
+void DatabaseManager::FlushOperationLogs() {
+    op_logs_.Flush();
+}
+
+// Write one batch of queued operation logs (all or nothing)
+bool DatabaseManager::WriteOperationLogs(const std::vector<OperationLog>& batch) {
     std::lock_guard<std::mutex> lock(db_mutex_);
     if (!db_)
-        return;
+        return false;
 
     try {
-        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
-                          std::chrono::system_clock::now().time_since_epoch())
-                          .count();
-
-        SQLite::Statement query(*db_, R"(
+        SQLite::Transaction transaction(*db_);
+        auto query = statements_->Acquire(R"(
             INSERT INTO operation_logs (action, target_type, target_id, target_name, changes, created_at)
             VALUES (?, ?, ?, ?, ?, ?)
         )");
-        query.bind(1, action);
-        query.bind(2, targetType);
-        query.bind(3, targetId);
-        query.bind(4, targetName);
-        query.bind(5, changes);
-        query.bind(6, now);
-        query.exec();
-        LOGINFO("[DB] Added operation log: {} {} {}", action, targetType, targetName);
+        for (const auto& log : batch) {
+            query->bind(1, log.action);
+            query->bind(2, log.target_type);
+            query->bind(3, log.target_id);
+            query->bind(4, log.target_name);
+            query->bind(5, log.changes);
+            query->bind(6, static_cast<int64_t>(log.created_at));
+            query->exec();
+            query->reset();
+        }
+        transaction.commit();
+        LOGDEBUG("[DB] Wrote {} operation log(s)", batch.size());
+        return true;
+    } catch (std::exception& e) {
+        LOGERROR("[DB] WriteOperationLogs failed ({} entries): {}", batch.size(), e.what());
+        return false;
+    }
+}
+
+// Rebuild a member as of a past log entry by undoing the diffs logged after it
+MemberAtLog DatabaseManager::GetMemberAtLog(const std::string& memberId, int64_t logId) {
+    MemberAtLog result;
+    Member current = GetMemberById(memberId);  // before leasing: it may need a reader too
+    result.exists = !current.id.empty();
+    result.member = std::move(current);
+    result.member.father_name.clear();
+
+    op_logs_.Flush();
+    auto reader = AcquireReader();
+    if (!reader) {
+        result.error = "Database not open";
+        return result;
+    }
+
+    try {
+        // Newest first; member imports rewrite rows without per-member entries. Archived
+        // entries count too when logId is older than the retention window.
+        auto query = reader->Acquire(R"(
+            SELECT id, action, target_id, changes FROM operation_logs
+            WHERE target_type = 'member' AND id > :after AND (target_id = :id OR action = 'IMPORT')
+            UNION ALL
+            SELECT id, action, target_id, changes FROM operation_logs_archive
+            WHERE target_type = 'member' AND id > :after AND (target_id = :id OR action = 'IMPORT')
+            ORDER BY id DESC
+        )");
+        query->bind(":after", logId);
+        query->bind(":id", memberId);
+
+        while (query->executeStep()) {
+            const int64_t id = query->getColumn(0).getInt64();
+            const std::string action = query->getColumn(1).getText();
+            if (action == "IMPORT") {
+                result.error = "Member import in log " + std::to_string(id);
+                return result;
+            }
+            auto diff = DecodeMemberDiff(query->getColumn(3).getText());
+            if (!diff) {
+                result.error = "Log " + std::to_string(id) + " has no field diff";
+                return result;
+            }
+
+            Member& m = result.member;
+            if (action == "DELETE") {
+                // The diff leads from the deleted record to an empty one
+                m = Member{.id = memberId};
+                result.exists = true;
+            }
+            if (!ApplyMemberDiff(m, *diff, /*reverse=*/true)) {
+                result.error = "Log " + std::to_string(id) + " does not match the record";
+                return result;
+            }
+            if (action == "CREATE") {
+                m = Member{};
+                result.exists = false;
+            }
+        }
     } catch (std::exception& e) {
-        LOGERROR("[DB] AddOperationLog failed: {}", e.what());
+        LOGERROR("[DB] GetMemberAtLog failed: {}", e.what());
+        result.error = e.what();
+        return result;
     }
+    if (!result.exists) {
+        result.member = Member{};
+    }
+    result.ok = true;
+    return result;
 }
 
+namespace {
+
+constexpr const char* kOperationLogColumns =
+    "id, action, target_type, target_id, target_name, changes, created_at";
+
+OperationLog ReadOperationLog(const SQLite::Statement& row) {
+    OperationLog log;
+    log.id = row.getColumn(0).getInt();
+    log.action = row.getColumn(1).getText();
+    log.target_type = row.getColumn(2).getText();
+    log.target_id = row.getColumn(3).getText();
+    log.target_name = row.getColumn(4).getText();  // NULL reads as ""
+    log.changes = row.getColumn(5).getText();
+    log.created_at = row.getColumn(6).getInt64();
+    return log;
+}
+
+bool HasLogFilter(const OperationLogQuery& q) {
+    return !q.action.empty() || !q.target_type.empty() || q.since > 0 || q.until > 0;
+}
+
+// WHERE clause for a query's filters (and cursor), with named parameters so the SQL text
+// only varies with which filters are set; BindLogFilter fills them in
+std::string LogFilterSql(const OperationLogQuery& q, bool withCursor) {
+    std::string where = " WHERE 1";
+    if (!q.action.empty()) {
+        where += " AND action = :action";
+    }
+    if (!q.target_type.empty()) {
+        where += " AND target_type = :type";
+        if (!q.target_id.empty()) {
+            where += " AND target_id = :target";
+        }
+    }
+    if (q.since > 0) {
+        where += " AND created_at >= :since";
+    }
+    if (q.until > 0) {
+        where += " AND created_at < :until";
+    }
+    if (withCursor && q.cursor_id > 0) {
+        where += " AND (created_at, id) < (:cursor_time, :cursor_id)";
+    }
+    return where;
+}
+
+void BindLogFilter(SQLite::Statement& query, const OperationLogQuery& q, bool withCursor) {
+    if (!q.action.empty()) {
+        query.bind(":action", q.action);
+    }
+    if (!q.target_type.empty()) {
+        query.bind(":type", q.target_type);
+        if (!q.target_id.empty()) {
+            query.bind(":target", q.target_id);
+        }
+    }
+    if (q.since > 0) {
+        query.bind(":since", q.since);
+    }
+    if (q.until > 0) {
+        query.bind(":until", q.until);
+    }
+    if (withCursor && q.cursor_id > 0) {
+        query.bind(":cursor_time", q.cursor_created_at);
+        query.bind(":cursor_id", q.cursor_id);
+    }
+}
+
+const char* LogTable(const OperationLogQuery& q) {
+    return q.archived ? "operation_logs_archive" : "operation_logs";
+}
+
+}  // namespace
+
 // Get operation logs
 std::vector<OperationLog> DatabaseManager::GetOperationLogs(int limit, int offset) {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    op_logs_.Flush();  // read your own writes
+    auto reader = AcquireReader();
     std::vector<OperationLog> logs;
-    if (!db_)
+    if (!reader)
         return logs;
 
     try {
-        SQLite::Statement query(*db_, R"(
-            SELECT * FROM operation_logs ORDER BY created_at DESC LIMIT ? OFFSET ?
-        )");
-        query.bind(1, limit);
-        query.bind(2, offset);
-
-        while (query.executeStep()) {
-            OperationLog log;
-            log.id = query.getColumn("id").getInt();
-            log.action = query.getColumn("action").getText();
-            log.target_type = query.getColumn("target_type").getText();
-            log.target_id = query.getColumn("target_id").getText();
-            if (!query.getColumn("target_name").isNull())
-                log.target_name = query.getColumn("target_name").getText();
-            if (!query.getColumn("changes").isNull())
-                log.changes = query.getColumn("changes").getText();
-            log.created_at = query.getColumn("created_at").getInt64();
-            logs.push_back(log);
+        auto query = reader->Acquire(std::string("SELECT ") + kOperationLogColumns +
+                                     " FROM operation_logs ORDER BY created_at DESC, id DESC"
+                                     " LIMIT ? OFFSET ?");
+        query->bind(1, limit);
+        query->bind(2, offset);
+
+        while (query->executeStep()) {
+            logs.push_back(ReadOperationLog(*query));
         }
     } catch (std::exception& e) {
         LOGERROR("[DB] GetOperationLogs failed: {}", e.what());
@@ -767,4 +1445,103 @@ std::vector<OperationLog> DatabaseManager::GetOperationLogs(int limit, int offse
     return logs;
 }
 
+OperationLogPage DatabaseManager::QueryOperationLogs(const OperationLogQuery& q) {
+    op_logs_.Flush();
+    OperationLogPage page;
+    auto reader = AcquireReader();
+    if (!reader || q.limit <= 0)
+        return page;
+
+    try {
+        auto query = reader->Acquire(std::string("SELECT ") + kOperationLogColumns + " FROM " +
+                                     LogTable(q) + LogFilterSql(q, /*withCursor=*/true) +
+                                     " ORDER BY created_at DESC, id DESC LIMIT :limit");
+        BindLogFilter(*query, q, /*withCursor=*/true);
+        query->bind(":limit", q.limit + 1);  // one extra row answers has_more
+
+        while (query->executeStep()) {
+            if (page.logs.size() == static_cast<size_t>(q.limit)) {
+                page.has_more = true;
+                break;
+            }
+            page.logs.push_back(ReadOperationLog(*query));
+        }
+    } catch (std::exception& e) {
+        LOGERROR("[DB] QueryOperationLogs failed: {}", e.what());
+    }
+    return page;
+}
+
+OperationLogCount DatabaseManager::CountOperationLogs(const OperationLogQuery& filter,
+                                                      int64_t cap) {
+    op_logs_.Flush();
+    OperationLogCount result;
+    auto reader = AcquireReader();
+    if (!reader)
+        return result;
+
+    try {
+        if (!HasLogFilter(filter)) {
+            // Both ends come straight off the rowid b-tree
+            auto query = reader->Acquire(std::string("SELECT min(id), max(id) FROM ") +
+                                         LogTable(filter));
+            if (query->executeStep() && !query->getColumn(0).isNull()) {
+                result.count =
+                    query->getColumn(1).getInt64() - query->getColumn(0).getInt64() + 1;
+            } else {
+                result.exact = true;  // empty
+            }
+            return result;
+        }
+        auto query = reader->Acquire(std::string("SELECT count(*) FROM (SELECT 1 FROM ") +
+                                     LogTable(filter) + LogFilterSql(filter, false) +
+                                     " LIMIT :cap)");
+        BindLogFilter(*query, filter, false);
+        query->bind(":cap", cap);
+        if (query->executeStep()) {
+            result.count = query->getColumn(0).getInt64();
+            result.exact = result.count < cap;
+        }
+    } catch (std::exception& e) {
+        LOGERROR("[DB] CountOperationLogs failed: {}", e.what());
+    }
+    return result;
+}
+
+int64_t DatabaseManager::ArchiveOperationLogs(int64_t olderThan) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    return MoveOperationLogsToArchive(olderThan);
+}
+
+// Caller holds db_mutex_
+int64_t DatabaseManager::MoveOperationLogsToArchive(int64_t olderThan) {
+    if (!db_)
+        return -1;
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SQLite::Transaction transaction(*db_);
+        auto copy = statements_->Acquire(std::string(R"(
+            INSERT OR REPLACE INTO operation_logs_archive ()") + kOperationLogColumns + R"()
+            SELECT )" + kOperationLogColumns + R"( FROM operation_logs WHERE created_at < ?
+        )");
+        copy->bind(1, olderThan);
+        copy->exec();
+        auto remove = statements_->Acquire("DELETE FROM operation_logs WHERE created_at < ?");
+        remove->bind(1, olderThan);
+        int64_t moved = remove->exec();
+        transaction.commit();
+        if (moved > 0) {
+            LOGINFO("[DB] Archived {} operation log(s) in {} ms", moved,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
+        }
+        return moved;
+    } catch (std::exception& e) {
+        LOGERROR("[DB] ArchiveOperationLogs failed: {}", e.what());
+        return -1;
+    }
+}
+
 }  // namespace clan::core
@@ -1,11 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "core/cache/lru_cache.h"
+#include "core/db/connection_pool.h"
+#include "core/db/kinship_index.h"
+#include "core/db/member_import.h"
+#include "core/db/models.h"
+#include "core/db/operation_log_writer.h"
+#include "core/db/search_cache.h"
+#include "core/db/statement_cache.h"
+#include "core/db/tree_change_log.h"
+
 // Forward declaration
 namespace SQLite {
 class Database;
@@ -13,70 +25,109 @@ class Database;
 
 namespace clan::core {
 
-struct MediaResource {
-    std::string id;
-    std::string member_id;
-    std::string resource_type;
-    std::string file_path;
-    std::string title;
-    std::string description;
-    std::string file_hash;
-    long long file_size = 0;
-    long long created_at = 0;
+struct DatabaseOptions {
+    // Read-only connections that serve the query methods concurrently with the writer.
+    // Needs WAL; 0 keeps every call on the single writer connection.
+    int read_connections = 4;
+    bool wal = true;
+    // WAL makes NORMAL durable across application crashes (not power loss)
+    std::string synchronous = "NORMAL";
+    int64_t mmap_size = 256LL * 1024 * 1024;  // bytes mapped per connection, 0 disables
+    int cache_size_kib = 16 * 1024;           // page cache per connection
+    // GetMemberById keeps found rows in an LRU (kMemberCacheBytes); false always queries
+    bool member_cache = true;
+    // Operation logs older than this move to operation_logs_archive at startup; 0 keeps
+    // everything in the live table
+    int operation_log_retention_days = 365;
+};
+
+struct MemberCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    size_t bytes = 0;  // approximate, see kMemberCacheBytes
+};
+
+// Filters and keyset cursor for QueryOperationLogs. Pages run newest first; pass the
+// last entry of a page as the cursor for the next one.
+struct OperationLogQuery {
+    std::string action;       // empty: any
+    std::string target_type;  // empty: any
+    std::string target_id;    // empty: any (only used together with target_type)
+    int64_t since = 0;        // created_at >= since; 0: no lower bound
+    int64_t until = 0;        // created_at < until; 0: no upper bound
+    // Cursor: only entries ordered after (created_at, id) = (cursor_created_at, cursor_id)
+    int64_t cursor_created_at = 0;
+    int64_t cursor_id = 0;  // 0: start from the newest entry
+    int limit = 100;
+    bool archived = false;  // query operation_logs_archive instead
 };
 
-// Operation log for tracking changes
-struct OperationLog {
-    int id = 0;
-    std::string action;       // CREATE, UPDATE, DELETE
-    std::string target_type;  // member, media
-    std::string target_id;
-    std::string target_name;
-    std::string changes;  // JSON string of changes
-    long long created_at = 0;
+struct OperationLogPage {
+    std::vector<OperationLog> logs;
+    bool has_more = false;
 };
-// 产品级结构体：包含完整的家谱信息
-struct Member {
-    std::string id;
-    std::string name;
-    std::string gender;  // "M" or "F"
-    int generation = 1;
-    std::string generation_name;  // 字辈 (如 "定", "英")
-    std::string aliases;          // 别名 (JSON or comma separated)
-
-    // 关系
-    std::string father_id;    // 父亲 ID
-    std::string father_name;  // 父亲姓名 (Query result only)
-    std::string mother_id;    // 母亲 ID系关联
-    std::string spouse_name;  // 配偶姓名
-
-    // 时间与地点 (使用 ISO 8601 字符串 "YYYY-MM-DD")
-    std::string birth_date;
-    std::string death_date;
-    std::string birth_place;
-    std::string death_place;
-
-    // 媒体与描述
-    std::string portrait_path;  // 头像路径
-    std::string bio;            // 生平传记 (支持 FTS 全文检索)
+
+struct OperationLogCount {
+    int64_t count = 0;
+    bool exact = false;  // false: a lower bound (filtered) or an id-range estimate
+};
+
+// A member as of an operation log entry, see GetMemberAtLog
+struct MemberAtLog {
+    bool ok = false;      // the history could be replayed; otherwise see error
+    bool exists = false;  // the member existed right after that entry
+    Member member;        // father_name is not restored
+    std::string error;
 };
 
 class DatabaseManager {
 public:
     static DatabaseManager& instance();
 
-    void Initialize(const std::string& dbPath);
+    // Reads (members, search, settings, media, logs) run on a pool of read-only
+    // connections when options allow it; writes stay serialized on one connection.
+    void Initialize(const std::string& dbPath, const DatabaseOptions& options = {});
 
     std::vector<Member> GetAllMembers();
+    // Full record, bio included. Found rows are kept in an LRU cache that the write paths
+    // below update or invalidate, so repeated detail views skip SQLite.
     Member GetMemberById(const std::string& id);
-    std::vector<Member> SearchMembers(const std::string& keyword);
+    MemberCacheStats GetMemberCacheStats() const;
+    // Pooled read-only connections; 0 when reads share the writer (no WAL, read_connections
+    // = 0, in-memory database)
+    size_t GetReadConnectionCount() const;
+    // Ranked FTS5 search over name, aliases and bio (prefix match per keyword); falls
+    // back to LIKE on name/aliases when FTS5 is unavailable. At most `limit` rows.
+    // Repeated, concurrent and refining (typed-ahead) searches are answered through
+    // SearchCache until the tree revision changes.
+    std::vector<Member> SearchMembers(const std::string& keyword, int limit = 100);
 
     void SaveMember(const Member& m);
     bool DeleteMember(const std::string& memberId);
     bool UpdateMemberPortrait(const std::string& memberId, const std::string& portraitPath);
     bool HasChildren(const std::string& memberId);
 
+    // Kinship graph queries, served from the resident index (no SQLite access).
+    // Returned members carry no bio; use GetMemberById for the full record.
+    std::vector<Member> GetTreeMembers(std::vector<int32_t>* fatherIndex = nullptr);
+    std::vector<Member> GetChildren(const std::string& memberId);
+    std::vector<Member> GetAncestors(const std::string& memberId, int maxDepth = 0);
+    std::vector<Member> GetDescendants(const std::string& memberId, int maxDepth = 0);
+    // Paged tree view for clans too large to send whole; see KinshipIndex::TreePage.
+    TreePage GetSubtree(const std::string& rootId, int depth, size_t limit);
+    TreePage GetChildPage(const std::string& memberId, size_t offset, size_t limit);
+    TreePage GetGenerationRange(int minGeneration, int maxGeneration, size_t offset,
+                                size_t limit);
+
+    // Tree change feed: every member mutation bumps the revision. Read the revision
+    // *before* GetTreeMembers() so a racing write is replayed, not lost.
+    uint64_t GetTreeRevision();
+    TreeDelta GetTreeDelta(uint64_t sinceRevision);
+
     void AddMediaResource(const MediaResource& res);
+    // One transaction for the whole batch; false (nothing written) on failure
+    bool AddMediaResources(const std::vector<MediaResource>& resources);
     bool DeleteMediaResource(const std::string& resourceId);
     std::vector<MediaResource> GetMediaResources(const std::string& memberId,
                                                  const std::string& type);
@@ -85,24 +136,100 @@ public:
     std::string GetSetting(const std::string& key);
     void SaveSetting(const std::string& key, const std::string& value);
 
-    // Operation logs
+    // Operation logs. AddOperationLog only queues the entry; a background writer commits
+    // queued entries in batches (see OperationLogWriter). GetOperationLogs, Initialize and
+    // FlushOperationLogs wait for everything queued before them, and so does shutdown.
     void AddOperationLog(const std::string& action, const std::string& targetType,
                          const std::string& targetId, const std::string& targetName,
                          const std::string& changes);
     std::vector<OperationLog> GetOperationLogs(int limit = 100, int offset = 0);
-
-    // Batch Import
+    // Filtered keyset page: each page costs the same however deep it is, unlike OFFSET
+    OperationLogPage QueryOperationLogs(const OperationLogQuery& query);
+    // Matching entries, counted up to `cap` (cursor and limit are ignored). Without
+    // filters the id range is used, which is O(1) but counts ids lost to failed writes.
+    OperationLogCount CountOperationLogs(const OperationLogQuery& filter, int64_t cap = 10000);
+    // Moves entries created before `olderThan` (epoch seconds) into
+    // operation_logs_archive in one transaction; returns how many moved, -1 on failure.
+    // Initialize runs it with DatabaseOptions::operation_log_retention_days.
+    int64_t ArchiveOperationLogs(int64_t olderThan);
+    void FlushOperationLogs();
+    // Member record right after operation log `logId`: the current record with the field
+    // diffs (see member_diff.h) of every later entry for that member undone. Fails when a
+    // later entry cannot be undone: a member import, or an entry logged before diffs were
+    // (full member JSON).
+    MemberAtLog GetMemberAtLog(const std::string& memberId, int64_t logId);
+
+    // Batch Import: streams every row of `source` into one transaction (UPSERT by id),
+    // resolves FatherName references to ids and rebuilds the search index once at the end.
+    // A row without an id updates the existing member with the same name and father, if
+    // any, and gets a new id otherwise.
+    // All-or-nothing; the kinship index is reloaded afterwards (clients resync the tree).
+    ImportResult ImportMembers(MemberSource& source, const ImportProgressFn& onProgress = {});
 
 private:
     DatabaseManager();
     ~DatabaseManager();
 
-    void CreateTables();
-    void CheckAndMigrateSchema();
-    void CheckFTSSupport();
+    void MigrateSchema();
+    // Creates or repairs members_fts, then probes it
+    void CheckFTSSupport(bool cjkTokenizer);
+    bool SearchMembersFts(StatementCache& statements, const std::vector<std::string>& tokens,
+                          int limit, std::vector<Member>& result);
+    void SearchMembersLike(StatementCache& statements, const std::vector<std::string>& tokens,
+                           int limit, std::vector<Member>& result);
+
+    // Connection for one read-only call: a pooled reader when the pool is open, otherwise
+    // the writer connection held under db_mutex_. Empty when no database is open.
+    class ReadLease {
+      public:
+        explicit operator bool() const { return statements_ != nullptr; }
+        StatementCache* operator->() const { return statements_; }
+        StatementCache& operator*() const { return *statements_; }
+
+      private:
+        friend class DatabaseManager;
+        explicit ReadLease(ConnectionPool::Lease pooled)
+            : pooled_(std::move(pooled)),
+              statements_(&pooled_.statements()) {}
+        ReadLease(std::unique_lock<std::mutex> lock, StatementCache* statements)
+            : lock_(std::move(lock)),
+              statements_(statements) {}
+
+        ConnectionPool::Lease pooled_;
+        std::unique_lock<std::mutex> lock_;
+        StatementCache* statements_ = nullptr;
+    };
+    ReadLease AcquireReader();
+    void RebuildKinshipIndex();
+    // Drops one cached GetMemberById row, or every row for an empty id. Writers call it
+    // after changing the database; the epoch bump stops readers that fetched the old row
+    // from storing it afterwards.
+    void DropCachedMembers(const std::string& id);
+    int64_t MoveOperationLogsToArchive(int64_t olderThan);  // caller holds db_mutex_
+    // OperationLogWriter commit function: one transaction per batch
+    bool WriteOperationLogs(const std::vector<OperationLog>& batch);
 
     std::unique_ptr<SQLite::Database> db_;
-    std::mutex db_mutex_;
+    // Declared after db_ so cached statements are finalized before the connection closes
+    std::unique_ptr<StatementCache> statements_;
+    std::mutex db_mutex_;  // guards the writer connection (db_, statements_)
+    ConnectionPool readers_;
+    std::atomic<bool> fts_available_{false};
+    std::atomic<bool> fts_cjk_{false};  // members_fts uses the cjk tokenizer, not unicode61
+    KinshipIndex kinship_;
+    TreeChangeLog tree_changes_;
+    SearchCache search_cache_;
+
+    static constexpr size_t kMemberCacheBytes = 4 * 1024 * 1024;
+    LruCache<std::string, Member> member_cache_;
+    std::atomic<bool> member_cache_enabled_{true};
+    std::mutex member_cache_mutex_;  // orders cache fills against writer invalidation
+    uint64_t member_cache_epoch_ = 0;
+    std::atomic<uint64_t> member_cache_hits_{0};
+    std::atomic<uint64_t> member_cache_misses_{0};
+
+    // Last, so its thread stops (and flushes) before anything it writes through goes away
+    OperationLogWriter op_logs_;
 };
 
 }  // namespace clan::core
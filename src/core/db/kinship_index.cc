@@ -0,0 +1,629 @@
+#include "core/db/kinship_index.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+namespace clan::core {
+
+// Defined first: every query walks children through it
+template <typename Fn>
+void KinshipIndex::ForEachChildLocked(NodeId parent, Fn&& fn) const {
+    if (parent < base_nodes_) {
+        for (uint32_t i = child_offsets_[parent]; i < child_offsets_[parent + 1]; ++i) {
+            if (IsChildLocked(parent, child_targets_[i])) {
+                fn(child_targets_[i]);
+            }
+        }
+    }
+    auto it = overlay_.find(parent);
+    if (it != overlay_.end()) {
+        for (NodeId child : it->second) {
+            if (IsChildLocked(parent, child)) {
+                fn(child);
+            }
+        }
+    }
+}
+
+void KinshipIndex::Build(std::vector<Member> members) {
+    std::unique_lock lock(mutex_);
+    ids_.clear();
+    nodes_.clear();
+    father_.clear();
+    mother_.clear();
+    alive_.clear();
+    pending_.clear();
+    live_count_ = 0;
+
+    ids_.reserve(members.size());
+    nodes_.reserve(members.size());
+    father_.reserve(members.size());
+    mother_.reserve(members.size());
+    alive_.reserve(members.size());
+
+    for (auto& m : members) {
+        if (m.id.empty() || ids_.count(m.id)) {
+            continue;
+        }
+        m.bio.clear();
+        m.bio.shrink_to_fit();
+        NodeId node = static_cast<NodeId>(nodes_.size());
+        ids_.emplace(m.id, node);
+        nodes_.push_back(std::move(m));
+        father_.push_back(kInvalidNode);
+        mother_.push_back(kInvalidNode);
+        alive_.push_back(1);
+        ++live_count_;
+    }
+    // Link in a second pass so that parent order in the input does not matter.
+    for (NodeId node = 0; node < nodes_.size(); ++node) {
+        father_[node] = ResolveParentLocked(node, nodes_[node].father_id);
+        mother_[node] = ResolveParentLocked(node, nodes_[node].mother_id);
+    }
+
+    order_.resize(nodes_.size());
+    for (NodeId node = 0; node < nodes_.size(); ++node) {
+        order_[node] = node;
+    }
+    std::stable_sort(order_.begin(), order_.end(), [this](NodeId a, NodeId b) {
+        return nodes_[a].generation < nodes_[b].generation;
+    });
+    roots_.clear();
+    for (NodeId node : order_) {
+        if (father_[node] == kInvalidNode) {
+            roots_.push_back(node);
+        }
+    }
+    FoldOverlayLocked();
+}
+
+void KinshipIndex::Upsert(const Member& m) {
+    if (m.id.empty()) {
+        return;
+    }
+    std::unique_lock lock(mutex_);
+
+    NodeId node = LookupLocked(m.id);
+    if (node != kInvalidNode) {
+        Member& cur = nodes_[node];
+        EraseOrderedLocked(order_, node);
+        if (father_[node] == kInvalidNode) {
+            EraseOrderedLocked(roots_, node);
+        }
+        if (cur.father_id != m.father_id) {
+            UnlinkParentLocked(node, cur.father_id);
+        }
+        if (cur.mother_id != m.mother_id) {
+            UnlinkParentLocked(node, cur.mother_id);
+        }
+    } else {
+        node = Intern(m.id);
+    }
+
+    Member& slot = nodes_[node];
+    slot = m;
+    slot.bio.clear();
+    slot.father_name.clear();
+    SetParentLocked(node, true, ResolveParentLocked(node, slot.father_id));
+    SetParentLocked(node, false, ResolveParentLocked(node, slot.mother_id));
+    InsertOrderedLocked(order_, node);
+    if (father_[node] == kInvalidNode) {
+        InsertOrderedLocked(roots_, node);
+    }
+    ResolvePendingLocked(node);
+    MaybeFoldLocked();
+}
+
+bool KinshipIndex::Remove(const std::string& id) {
+    std::unique_lock lock(mutex_);
+    NodeId node = LookupLocked(id);
+    if (node == kInvalidNode) {
+        return false;
+    }
+
+    EraseOrderedLocked(order_, node);
+    if (father_[node] == kInvalidNode) {
+        EraseOrderedLocked(roots_, node);
+    }
+    UnlinkParentLocked(node, nodes_[node].father_id);
+    UnlinkParentLocked(node, nodes_[node].mother_id);
+    SetParentLocked(node, true, kInvalidNode);
+    SetParentLocked(node, false, kInvalidNode);
+
+    // Children of the removed member fall back to the pending list so that they are
+    // re-linked if the id comes back (e.g. delete + re-import).
+    std::vector<NodeId> children;
+    ForEachChildLocked(node, [&](NodeId child) { children.push_back(child); });
+    for (NodeId child : children) {
+        if (father_[child] == node) {
+            SetParentLocked(child, true, kInvalidNode);
+            InsertOrderedLocked(roots_, child);
+            pending_[id].push_back(child);
+        }
+        if (mother_[child] == node) {
+            SetParentLocked(child, false, kInvalidNode);
+            pending_[id].push_back(child);
+        }
+    }
+
+    ids_.erase(id);
+    alive_[node] = 0;
+    nodes_[node] = Member{};
+    --live_count_;
+
+    size_t removed = nodes_.size() - live_count_;
+    if (removed > 1024 && removed > live_count_) {
+        CompactLocked();
+    } else {
+        MaybeFoldLocked();
+    }
+    return true;
+}
+
+void KinshipIndex::Clear() {
+    Build({});
+}
+
+size_t KinshipIndex::size() const {
+    std::shared_lock lock(mutex_);
+    return live_count_;
+}
+
+bool KinshipIndex::Contains(const std::string& id) const {
+    std::shared_lock lock(mutex_);
+    return LookupLocked(id) != kInvalidNode;
+}
+
+std::optional<Member> KinshipIndex::Find(const std::string& id) const {
+    std::shared_lock lock(mutex_);
+    NodeId node = LookupLocked(id);
+    if (node == kInvalidNode) {
+        return std::nullopt;
+    }
+    return SummaryLocked(node);
+}
+
+std::vector<Member> KinshipIndex::GetAll(std::vector<int32_t>* fatherIndex) const {
+    std::shared_lock lock(mutex_);
+    std::vector<Member> result;
+    result.reserve(order_.size());
+    for (NodeId node : order_) {
+        result.push_back(SummaryLocked(node));
+    }
+
+    if (fatherIndex) {
+        std::vector<int32_t> position(nodes_.size(), -1);
+        for (size_t i = 0; i < order_.size(); ++i) {
+            position[order_[i]] = static_cast<int32_t>(i);
+        }
+        fatherIndex->resize(order_.size());
+        for (size_t i = 0; i < order_.size(); ++i) {
+            NodeId father = father_[order_[i]];
+            (*fatherIndex)[i] = father == kInvalidNode ? -1 : position[father];
+        }
+    }
+    return result;
+}
+
+bool KinshipIndex::HasChildren(const std::string& id) const {
+    std::shared_lock lock(mutex_);
+    NodeId node = LookupLocked(id);
+    if (node == kInvalidNode) {
+        return false;
+    }
+    bool found = false;
+    ForEachChildLocked(node, [&](NodeId) { found = true; });
+    return found;
+}
+
+std::vector<Member> KinshipIndex::GetChildren(const std::string& id) const {
+    std::shared_lock lock(mutex_);
+    std::vector<Member> result;
+    NodeId node = LookupLocked(id);
+    if (node == kInvalidNode) {
+        return result;
+    }
+    ForEachChildLocked(node, [&](NodeId child) { result.push_back(SummaryLocked(child)); });
+    return result;
+}
+
+std::vector<Member> KinshipIndex::GetAncestors(const std::string& id, int maxDepth) const {
+    std::shared_lock lock(mutex_);
+    std::vector<Member> result;
+    NodeId start = LookupLocked(id);
+    if (start == kInvalidNode) {
+        return result;
+    }
+
+    std::vector<bool> visited(nodes_.size(), false);
+    visited[start] = true;
+    std::deque<std::pair<NodeId, int>> queue{{start, 0}};
+    while (!queue.empty()) {
+        auto [node, depth] = queue.front();
+        queue.pop_front();
+        if (maxDepth > 0 && depth >= maxDepth) {
+            continue;
+        }
+        for (NodeId parent : {father_[node], mother_[node]}) {
+            if (parent == kInvalidNode || visited[parent]) {
+                continue;
+            }
+            visited[parent] = true;
+            result.push_back(SummaryLocked(parent));
+            queue.emplace_back(parent, depth + 1);
+        }
+    }
+    return result;
+}
+
+std::vector<Member> KinshipIndex::GetDescendants(const std::string& id, int maxDepth) const {
+    std::shared_lock lock(mutex_);
+    std::vector<Member> result;
+    NodeId start = LookupLocked(id);
+    if (start == kInvalidNode) {
+        return result;
+    }
+
+    std::vector<bool> visited(nodes_.size(), false);
+    visited[start] = true;
+    std::deque<std::pair<NodeId, int>> queue{{start, 0}};
+    while (!queue.empty()) {
+        auto [node, depth] = queue.front();
+        queue.pop_front();
+        if (maxDepth > 0 && depth >= maxDepth) {
+            continue;
+        }
+        ForEachChildLocked(node, [&, depth = depth](NodeId child) {
+            if (visited[child]) {
+                return;
+            }
+            visited[child] = true;
+            result.push_back(SummaryLocked(child));
+            queue.emplace_back(child, depth + 1);
+        });
+    }
+    return result;
+}
+
+TreePage KinshipIndex::GetSubtree(const std::string& id, int depth, size_t limit) const {
+    std::shared_lock lock(mutex_);
+    TreePage page;
+    std::deque<std::pair<NodeId, int>> queue;
+    if (id.empty()) {
+        for (NodeId root : roots_) {
+            queue.emplace_back(root, 0);
+        }
+    } else {
+        NodeId start = LookupLocked(id);
+        if (start == kInvalidNode) {
+            return page;
+        }
+        queue.emplace_back(start, 0);
+    }
+
+    // Father links form a forest unless the data has a cycle; the set only guards that
+    // case and grows with the result, never with the index.
+    std::unordered_set<NodeId> seen;
+    while (!queue.empty()) {
+        auto [node, level] = queue.front();
+        queue.pop_front();
+        if (!seen.insert(node).second) {
+            continue;
+        }
+        if (limit > 0 && page.members.size() >= limit) {
+            page.has_more = true;
+            break;
+        }
+        AppendToPageLocked(page, node);
+        if (level >= depth) {
+            continue;
+        }
+        ForEachChildLocked(node, [&, node = node, level = level](NodeId child) {
+            if (father_[child] == node) {
+                queue.emplace_back(child, level + 1);
+            }
+        });
+    }
+    return page;
+}
+
+TreePage KinshipIndex::GetChildPage(const std::string& id, size_t offset, size_t limit) const {
+    std::shared_lock lock(mutex_);
+    TreePage page;
+    NodeId node = LookupLocked(id);
+    if (node == kInvalidNode) {
+        return page;
+    }
+    size_t index = 0;
+    ForEachChildLocked(node, [&](NodeId child) {
+        if (father_[child] != node || index++ < offset || page.has_more) {
+            return;
+        }
+        if (limit > 0 && page.members.size() >= limit) {
+            page.has_more = true;
+            return;
+        }
+        AppendToPageLocked(page, child);
+    });
+    return page;
+}
+
+TreePage KinshipIndex::GetGenerationRange(int minGeneration, int maxGeneration, size_t offset,
+                                          size_t limit) const {
+    std::shared_lock lock(mutex_);
+    TreePage page;
+    auto generationOf = [this](NodeId node) { return nodes_[node].generation; };
+    auto first = std::lower_bound(
+        order_.begin(), order_.end(), minGeneration,
+        [&](NodeId node, int generation) { return generationOf(node) < generation; });
+    auto last = std::upper_bound(
+        first, order_.end(), maxGeneration,
+        [&](int generation, NodeId node) { return generation < generationOf(node); });
+
+    size_t available = static_cast<size_t>(last - first);
+    if (offset >= available) {
+        return page;
+    }
+    size_t count = available - offset;
+    if (limit > 0 && count > limit) {
+        count = limit;
+        page.has_more = true;
+    }
+    page.members.reserve(count);
+    page.child_counts.reserve(count);
+    for (auto it = first + offset; it != first + offset + count; ++it) {
+        AppendToPageLocked(page, *it);
+    }
+    return page;
+}
+
+// ---------------------------------------------------------
+// Internals (callers hold mutex_)
+// ---------------------------------------------------------
+
+KinshipIndex::NodeId KinshipIndex::LookupLocked(const std::string& id) const {
+    if (id.empty()) {
+        return kInvalidNode;
+    }
+    auto it = ids_.find(id);
+    return it == ids_.end() ? kInvalidNode : it->second;
+}
+
+KinshipIndex::NodeId KinshipIndex::Intern(const std::string& id) {
+    NodeId node = static_cast<NodeId>(nodes_.size());
+    ids_.emplace(id, node);
+    nodes_.emplace_back();
+    father_.push_back(kInvalidNode);
+    mother_.push_back(kInvalidNode);
+    alive_.push_back(1);
+    ++live_count_;
+    return node;
+}
+
+KinshipIndex::NodeId KinshipIndex::ResolveParentLocked(NodeId node,
+                                                       const std::string& parentId) {
+    if (parentId.empty()) {
+        return kInvalidNode;
+    }
+    NodeId parent = LookupLocked(parentId);
+    if (parent == kInvalidNode) {
+        auto& waiting = pending_[parentId];
+        if (std::find(waiting.begin(), waiting.end(), node) == waiting.end()) {
+            waiting.push_back(node);
+        }
+    }
+    return parent == node ? kInvalidNode : parent;
+}
+
+void KinshipIndex::UnlinkParentLocked(NodeId node, const std::string& parentId) {
+    if (parentId.empty()) {
+        return;
+    }
+    auto it = pending_.find(parentId);
+    if (it == pending_.end()) {
+        return;
+    }
+    auto& waiting = it->second;
+    waiting.erase(std::remove(waiting.begin(), waiting.end(), node), waiting.end());
+    if (waiting.empty()) {
+        pending_.erase(it);
+    }
+}
+
+void KinshipIndex::ResolvePendingLocked(NodeId node) {
+    auto it = pending_.find(nodes_[node].id);
+    if (it == pending_.end()) {
+        return;
+    }
+    std::vector<NodeId> waiting = std::move(it->second);
+    pending_.erase(it);
+    for (NodeId child : waiting) {
+        if (!alive_[child] || child == node) {
+            continue;
+        }
+        if (nodes_[child].father_id == nodes_[node].id && father_[child] != node) {
+            if (father_[child] == kInvalidNode) {
+                EraseOrderedLocked(roots_, child);
+            }
+            SetParentLocked(child, true, node);
+        }
+        if (nodes_[child].mother_id == nodes_[node].id) {
+            SetParentLocked(child, false, node);
+        }
+    }
+}
+
+void KinshipIndex::SetParentLocked(NodeId child, bool father, NodeId parent) {
+    NodeId& slot = father ? father_[child] : mother_[child];
+    const NodeId other = father ? mother_[child] : father_[child];
+    const NodeId old = slot;
+    if (old == parent) {
+        return;
+    }
+    slot = parent;
+    // A base entry for `old` simply stops being valid; an overlay entry is taken out
+    if (old != kInvalidNode && old != other) {
+        auto it = overlay_.find(old);
+        if (it != overlay_.end()) {
+            auto& children = it->second;
+            children.erase(std::remove(children.begin(), children.end(), child),
+                           children.end());
+            if (children.empty()) {
+                overlay_.erase(it);
+            }
+        }
+        ++overlay_changes_;
+    }
+    if (parent != kInvalidNode && parent != other && !InBaseLocked(parent, child)) {
+        overlay_[parent].push_back(child);
+        ++overlay_changes_;
+    }
+}
+
+bool KinshipIndex::IsChildLocked(NodeId parent, NodeId child) const {
+    return alive_[child] && (father_[child] == parent || mother_[child] == parent);
+}
+
+bool KinshipIndex::InBaseLocked(NodeId parent, NodeId child) const {
+    if (parent >= base_nodes_) {
+        return false;
+    }
+    auto first = child_targets_.begin() + child_offsets_[parent];
+    auto last = child_targets_.begin() + child_offsets_[parent + 1];
+    return std::find(first, last, child) != last;
+}
+
+bool KinshipIndex::OrderLess(NodeId a, NodeId b) const {
+    int ga = nodes_[a].generation, gb = nodes_[b].generation;
+    return ga != gb ? ga < gb : a < b;
+}
+
+void KinshipIndex::InsertOrderedLocked(std::vector<NodeId>& list, NodeId node) {
+    auto it = std::lower_bound(list.begin(), list.end(), node,
+                               [this](NodeId a, NodeId b) { return OrderLess(a, b); });
+    if (it == list.end() || *it != node) {
+        list.insert(it, node);
+    }
+}
+
+void KinshipIndex::EraseOrderedLocked(std::vector<NodeId>& list, NodeId node) {
+    auto it = std::lower_bound(list.begin(), list.end(), node,
+                               [this](NodeId a, NodeId b) { return OrderLess(a, b); });
+    if (it != list.end() && *it == node) {
+        list.erase(it);
+    }
+}
+
+void KinshipIndex::FoldOverlayLocked() {
+    const size_t n = nodes_.size();
+
+    // CSR: count, prefix-sum, scatter. Children keep dense-id (insertion) order.
+    child_offsets_.assign(n + 1, 0);
+    for (NodeId node = 0; node < n; ++node) {
+        if (!alive_[node]) {
+            continue;
+        }
+        if (father_[node] != kInvalidNode) {
+            ++child_offsets_[father_[node] + 1];
+        }
+        if (mother_[node] != kInvalidNode && mother_[node] != father_[node]) {
+            ++child_offsets_[mother_[node] + 1];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        child_offsets_[i + 1] += child_offsets_[i];
+    }
+    child_targets_.resize(child_offsets_[n]);
+    std::vector<uint32_t> cursor(child_offsets_.begin(), child_offsets_.end() - 1);
+    for (NodeId node = 0; node < n; ++node) {
+        if (!alive_[node]) {
+            continue;
+        }
+        if (father_[node] != kInvalidNode) {
+            child_targets_[cursor[father_[node]]++] = node;
+        }
+        if (mother_[node] != kInvalidNode && mother_[node] != father_[node]) {
+            child_targets_[cursor[mother_[node]]++] = node;
+        }
+    }
+    base_nodes_ = n;
+    overlay_.clear();
+    overlay_changes_ = 0;
+}
+
+void KinshipIndex::MaybeFoldLocked() {
+    // Each fold is O(N); waiting for N/16 changes keeps it O(1) amortized per mutation
+    // while bounding the stale base entries and overlay lookups a read can meet
+    if (overlay_changes_ > std::max<size_t>(256, live_count_ / 16)) {
+        FoldOverlayLocked();
+    }
+}
+
+void KinshipIndex::CompactLocked() {
+    std::vector<NodeId> remap(nodes_.size(), kInvalidNode);
+    NodeId next = 0;
+    for (NodeId node = 0; node < nodes_.size(); ++node) {
+        if (alive_[node]) {
+            remap[node] = next++;
+        }
+    }
+    auto mapped = [&](NodeId node) { return node == kInvalidNode ? node : remap[node]; };
+
+    for (NodeId node = 0; node < nodes_.size(); ++node) {
+        NodeId to = remap[node];
+        if (to == kInvalidNode) {
+            continue;
+        }
+        if (to != node) {
+            nodes_[to] = std::move(nodes_[node]);
+        }
+        father_[to] = mapped(father_[node]);
+        mother_[to] = mapped(mother_[node]);
+    }
+    nodes_.resize(next);
+    father_.resize(next);
+    mother_.resize(next);
+    alive_.assign(next, 1);
+    for (auto& [id, node] : ids_) {
+        node = remap[node];
+    }
+    for (auto& [id, waiting] : pending_) {
+        std::vector<NodeId> kept;
+        for (NodeId child : waiting) {
+            if (remap[child] != kInvalidNode) {
+                kept.push_back(remap[child]);
+            }
+        }
+        waiting = std::move(kept);
+    }
+    // The renumbering is monotonic, so (generation, node) order is unchanged
+    for (auto* list : {&order_, &roots_}) {
+        for (NodeId& node : *list) {
+            node = remap[node];
+        }
+    }
+    FoldOverlayLocked();
+}
+
+Member KinshipIndex::SummaryLocked(NodeId node) const {
+    Member m = nodes_[node];
+    if (father_[node] != kInvalidNode) {
+        m.father_name = nodes_[father_[node]].name;
+    }
+    return m;
+}
+
+uint32_t KinshipIndex::FatherChildCountLocked(NodeId node) const {
+    uint32_t count = 0;
+    ForEachChildLocked(node, [&](NodeId child) { count += father_[child] == node; });
+    return count;
+}
+
+void KinshipIndex::AppendToPageLocked(TreePage& page, NodeId node) const {
+    page.members.push_back(SummaryLocked(node));
+    page.child_counts.push_back(FatherChildCountLocked(node));
+}
+
+}  // namespace clan::core
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/db/models.h"
+
+namespace clan::core {
+
+// One window of the tree view. child_counts[i] is how many children members[i] has in the
+// whole index, loaded or not, so the view can draw an expand handle without fetching them.
+struct TreePage {
+    std::vector<Member> members;
+    std::vector<uint32_t> child_counts;
+    bool has_more = false;  // the limit cut the window short
+};
+
+// Resident, contiguous view of the family graph.
+//
+// Member ids are interned to dense integers; father/mother links are kept in flat arrays
+// and the parent -> children adjacency is stored in CSR form (offsets + targets). The
+// index holds a bio-less summary of every member, which is everything the tree view
+// needs, so tree rendering and lineage queries never touch SQLite.
+//
+// Mutations are patched in place. The CSR is a base snapshot plus a per-parent overlay of
+// children linked since; base entries whose link no longer holds are skipped on read, and
+// the overlay is folded into a new base once it outgrows a fraction of the index. The
+// generation order is kept sorted by insert/erase, and removed members' slots are
+// compacted away once they outnumber the live ones. The class is internally
+// synchronized: queries share a reader lock, mutations take the writer lock.
+class KinshipIndex {
+  public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kInvalidNode = UINT32_MAX;
+
+    // Replaces the whole index. Bios are dropped on the way in.
+    void Build(std::vector<Member> members);
+    // Inserts or replaces a member and re-links it to its parents.
+    void Upsert(const Member& m);
+    // Removes a member. Children keep their father_id/mother_id strings and are re-linked
+    // automatically if a member with that id is inserted again.
+    bool Remove(const std::string& id);
+    void Clear();
+
+    size_t size() const;
+    bool Contains(const std::string& id) const;
+    std::optional<Member> Find(const std::string& id) const;
+
+    // Tree view: all members ordered by generation, bios omitted, father_name resolved.
+    // fatherIndex, if given, receives each member's father as a position in the result
+    // (-1 when there is none), which spares callers an id lookup per member.
+    std::vector<Member> GetAll(std::vector<int32_t>* fatherIndex = nullptr) const;
+    bool HasChildren(const std::string& id) const;
+    std::vector<Member> GetChildren(const std::string& id) const;
+    // Breadth-first walks. maxDepth <= 0 means unlimited. The start member is excluded.
+    std::vector<Member> GetAncestors(const std::string& id, int maxDepth = 0) const;
+    std::vector<Member> GetDescendants(const std::string& id, int maxDepth = 0) const;
+
+    // Tree view windows, O(result) apart from one binary search. They follow father links
+    // only, like parentId in the rendered tree. limit == 0 means unlimited.
+    // Breadth-first subtree of `id` (included) down to `depth` levels below it; an empty
+    // id starts from every root (members without a father in the index).
+    TreePage GetSubtree(const std::string& id, int depth, size_t limit) const;
+    TreePage GetChildPage(const std::string& id, size_t offset, size_t limit) const;
+    // Members with minGeneration <= generation <= maxGeneration, in generation order.
+    TreePage GetGenerationRange(int minGeneration, int maxGeneration, size_t offset,
+                                size_t limit) const;
+
+  private:
+    NodeId LookupLocked(const std::string& id) const;
+    NodeId Intern(const std::string& id);
+    // Resolves a parent id, registering `node` in pending_ when the parent is not present
+    NodeId ResolveParentLocked(NodeId node, const std::string& parentId);
+    void UnlinkParentLocked(NodeId node, const std::string& parentId);
+    void ResolvePendingLocked(NodeId node);
+    // Points father_ (or mother_) of `child` at `parent`, patching the child lists
+    void SetParentLocked(NodeId child, bool father, NodeId parent);
+    bool IsChildLocked(NodeId parent, NodeId child) const;
+    bool InBaseLocked(NodeId parent, NodeId child) const;
+    // Calls fn(child) for every current child of `parent`: base entries, then the overlay
+    template <typename Fn>
+    void ForEachChildLocked(NodeId parent, Fn&& fn) const;
+    // order_/roots_ are sorted by (generation, node); erase before changing a generation
+    bool OrderLess(NodeId a, NodeId b) const;
+    void InsertOrderedLocked(std::vector<NodeId>& list, NodeId node);
+    void EraseOrderedLocked(std::vector<NodeId>& list, NodeId node);
+    void FoldOverlayLocked();   // new CSR base from father_/mother_, O(N)
+    void MaybeFoldLocked();
+    void CompactLocked();       // drops removed slots and renumbers, O(N)
+    Member SummaryLocked(NodeId node) const;
+    uint32_t FatherChildCountLocked(NodeId node) const;
+    void AppendToPageLocked(TreePage& page, NodeId node) const;
+
+    mutable std::shared_mutex mutex_;
+
+    std::unordered_map<std::string, NodeId> ids_;
+    std::vector<Member> nodes_;  // bio-less summaries, indexed by NodeId
+    std::vector<NodeId> father_;
+    std::vector<NodeId> mother_;
+    std::vector<uint8_t> alive_;
+    size_t live_count_ = 0;
+
+    // Parent ids referenced by a member but not present (yet): parent id -> children.
+    std::unordered_map<std::string, std::vector<NodeId>> pending_;
+
+    // Children: CSR base over the first base_nodes_ nodes as of the last fold, plus the
+    // links made since. Entries are only valid while IsChildLocked holds.
+    size_t base_nodes_ = 0;
+    std::vector<uint32_t> child_offsets_;  // size base_nodes_ + 1
+    std::vector<NodeId> child_targets_;
+    std::unordered_map<NodeId, std::vector<NodeId>> overlay_;
+    size_t overlay_changes_ = 0;  // links made or broken since the last fold
+
+    std::vector<NodeId> order_;  // live nodes sorted by generation
+    std::vector<NodeId> roots_;  // live nodes without a linked father, same order
+};
+
+}  // namespace clan::core
@@ -0,0 +1,54 @@
+#include "core/db/member_columns.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+namespace clan::core {
+
+namespace {
+
+inline void AssignText(std::string& dst, const SQLite::Column& col) {
+    // getText() must come before getBytes(): it fixes the column's UTF-8 representation
+    const char* text = col.getText();
+    dst.assign(text, static_cast<size_t>(col.getBytes()));
+}
+
+}  // namespace
+
+std::string MemberSelectList(std::string_view tableAlias, bool withBio) {
+    std::string list;
+    list.reserve(256);
+    for (int i = 0; i < kMemberColumnCount; ++i) {
+        if (i > 0) {
+            list += ", ";
+        }
+        if (!withBio && i == static_cast<int>(MemberColumn::kBio)) {
+            list += "NULL";
+            continue;
+        }
+        list += tableAlias;
+        list += kMemberColumnNames[i];
+    }
+    return list;
+}
+
+void ReadMember(const SQLite::Statement& row, Member& m, int firstColumn) {
+    auto col = [&](MemberColumn c) { return row.getColumn(firstColumn + static_cast<int>(c)); };
+
+    AssignText(m.id, col(MemberColumn::kId));
+    AssignText(m.name, col(MemberColumn::kName));
+    AssignText(m.gender, col(MemberColumn::kGender));
+    m.generation = col(MemberColumn::kGeneration).getInt();
+    AssignText(m.generation_name, col(MemberColumn::kGenerationName));
+    AssignText(m.father_id, col(MemberColumn::kFatherId));
+    AssignText(m.mother_id, col(MemberColumn::kMotherId));
+    AssignText(m.spouse_name, col(MemberColumn::kSpouseName));
+    AssignText(m.birth_date, col(MemberColumn::kBirthDate));
+    AssignText(m.death_date, col(MemberColumn::kDeathDate));
+    AssignText(m.birth_place, col(MemberColumn::kBirthPlace));
+    AssignText(m.death_place, col(MemberColumn::kDeathPlace));
+    AssignText(m.portrait_path, col(MemberColumn::kPortraitPath));
+    AssignText(m.bio, col(MemberColumn::kBio));
+    AssignText(m.aliases, col(MemberColumn::kAliases));
+}
+
+}  // namespace clan::core
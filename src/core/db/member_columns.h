@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "core/db/models.h"
+
+namespace SQLite {
+class Statement;
+}
+
+namespace clan::core {
+
+// Compile-time column map for the members table.
+//
+// Every members SELECT uses MemberSelectList() instead of `SELECT *`, so the enum value
+// *is* the result column index and rows are decoded without per-field name lookups.
+enum class MemberColumn : int {
+    kId,
+    kName,
+    kGender,
+    kGeneration,
+    kGenerationName,
+    kFatherId,
+    kMotherId,
+    kSpouseName,
+    kBirthDate,
+    kDeathDate,
+    kBirthPlace,
+    kDeathPlace,
+    kPortraitPath,
+    kBio,
+    kAliases,
+    kCount
+};
+
+inline constexpr int kMemberColumnCount = static_cast<int>(MemberColumn::kCount);
+
+inline constexpr std::array<std::string_view, kMemberColumnCount> kMemberColumnNames = {
+    "id",          "name",        "gender",        "generation", "generation_name",
+    "father_id",   "mother_id",   "spouse_name",   "birth_date", "death_date",
+    "birth_place", "death_place", "portrait_path", "bio",        "aliases",
+};
+static_assert(kMemberColumnNames.size() == kMemberColumnCount,
+              "kMemberColumnNames must list one name per MemberColumn");
+
+// "id, name, ..." in MemberColumn order, optionally qualified ("m.id, m.name, ...").
+// With withBio == false the bio slot is selected as NULL, keeping indexes aligned while
+// skipping the largest column (tree/index loads never need it).
+std::string MemberSelectList(std::string_view tableAlias = {}, bool withBio = true);
+
+// Decodes the current row of a statement selecting MemberSelectList() starting at
+// result column `firstColumn`. Text is copied straight from SQLite's column buffer
+// using the reported byte length (no strlen, no temporaries). NULL reads as "".
+void ReadMember(const SQLite::Statement& row, Member& m, int firstColumn = 0);
+
+}  // namespace clan::core
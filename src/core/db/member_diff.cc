@@ -0,0 +1,351 @@
+#include "core/db/member_diff.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+
+#include "core/json/json_writer.h"
+
+namespace clan::core {
+
+namespace {
+
+// Values at least this long on both sides are stored as a splice
+constexpr size_t kSpliceMinBytes = 64;
+
+// String member behind a column; nullptr for generation (an int)
+template <typename M>
+auto TextField(M& m, MemberColumn column) -> decltype(&m.id) {
+    switch (column) {
+        case MemberColumn::kId:
+            return &m.id;
+        case MemberColumn::kName:
+            return &m.name;
+        case MemberColumn::kGender:
+            return &m.gender;
+        case MemberColumn::kGenerationName:
+            return &m.generation_name;
+        case MemberColumn::kFatherId:
+            return &m.father_id;
+        case MemberColumn::kMotherId:
+            return &m.mother_id;
+        case MemberColumn::kSpouseName:
+            return &m.spouse_name;
+        case MemberColumn::kBirthDate:
+            return &m.birth_date;
+        case MemberColumn::kDeathDate:
+            return &m.death_date;
+        case MemberColumn::kBirthPlace:
+            return &m.birth_place;
+        case MemberColumn::kDeathPlace:
+            return &m.death_place;
+        case MemberColumn::kPortraitPath:
+            return &m.portrait_path;
+        case MemberColumn::kBio:
+            return &m.bio;
+        case MemberColumn::kAliases:
+            return &m.aliases;
+        case MemberColumn::kGeneration:
+        case MemberColumn::kCount:
+            break;
+    }
+    return nullptr;
+}
+
+bool IsContinuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Splice change without the common prefix and suffix of the two values, cut on UTF-8
+// code point boundaries
+FieldChange Splice(MemberColumn column, std::string_view before, std::string_view after) {
+    const size_t shorter = std::min(before.size(), after.size());
+    size_t prefix = 0;
+    while (prefix < shorter && before[prefix] == after[prefix]) {
+        ++prefix;
+    }
+    while (prefix > 0 && ((prefix < before.size() && IsContinuation(before[prefix])) ||
+                          (prefix < after.size() && IsContinuation(after[prefix])))) {
+        --prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < shorter - prefix &&
+           before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    while (suffix > 0 && IsContinuation(before[before.size() - suffix])) {
+        --suffix;
+    }
+
+    FieldChange change;
+    change.column = column;
+    change.splice = true;
+    change.at = prefix;
+    change.before = before.substr(prefix, before.size() - prefix - suffix);
+    change.after = after.substr(prefix, after.size() - prefix - suffix);
+    return change;
+}
+
+// Reader for exactly what EncodeMemberDiff writes (plus any JSON string escape)
+class DiffReader {
+  public:
+    explicit DiffReader(std::string_view text)
+        : text_(text) {}
+
+    std::optional<MemberDiff> Read() {
+        MemberDiff diff;
+        if (!Consume('{')) {
+            return std::nullopt;
+        }
+        if (Consume('}')) {
+            return AtEnd() ? std::optional<MemberDiff>(std::move(diff)) : std::nullopt;
+        }
+        do {
+            std::string key;
+            if (!ReadString(key) || !Consume(':') || !Consume('[')) {
+                return std::nullopt;
+            }
+            auto it = std::find(kMemberColumnNames.begin(), kMemberColumnNames.end(), key);
+            if (it == kMemberColumnNames.end() || it == kMemberColumnNames.begin()) {
+                return std::nullopt;  // unknown column, or the id
+            }
+            FieldChange change;
+            change.column = static_cast<MemberColumn>(it - kMemberColumnNames.begin());
+            SkipSpace();
+            if (pos_ < text_.size() && text_[pos_] != '"') {
+                change.splice = true;
+                if (!ReadSize(change.at) || !Consume(',')) {
+                    return std::nullopt;
+                }
+            }
+            if (!ReadString(change.before) || !Consume(',') || !ReadString(change.after) ||
+                !Consume(']')) {
+                return std::nullopt;
+            }
+            diff.push_back(std::move(change));
+        } while (Consume(','));
+        if (!Consume('}') || !AtEnd()) {
+            return std::nullopt;
+        }
+        return diff;
+    }
+
+  private:
+    void SkipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' ||
+                text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool AtEnd() {
+        SkipSpace();
+        return pos_ == text_.size();
+    }
+
+    bool ReadSize(size_t& value) {
+        const char* begin = text_.data() + pos_;
+        auto [end, ec] = std::from_chars(begin, text_.data() + text_.size(), value);
+        if (ec != std::errc()) {
+            return false;
+        }
+        pos_ = static_cast<size_t>(end - text_.data());
+        return true;
+    }
+
+    bool ReadHex4(uint32_t& value) {
+        if (text_.size() - pos_ < 4) {
+            return false;
+        }
+        const char* begin = text_.data() + pos_;
+        auto [end, ec] = std::from_chars(begin, begin + 4, value, 16);
+        if (ec != std::errc() || end != begin + 4) {
+            return false;
+        }
+        pos_ += 4;
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ReadString(std::string& out) {
+        if (!Consume('"')) {
+            return false;
+        }
+        out.clear();
+        while (pos_ < text_.size()) {
+            // Copy the plain run in one append
+            size_t end = text_.find_first_of("\"\\", pos_);
+            if (end == std::string_view::npos) {
+                return false;
+            }
+            out.append(text_.substr(pos_, end - pos_));
+            pos_ = end + 1;
+            if (text_[end] == '"') {
+                return true;
+            }
+            if (pos_ >= text_.size()) {
+                return false;
+            }
+            char escape = text_[pos_++];
+            switch (escape) {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escape;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!ReadHex4(cp)) {
+                        return false;
+                    }
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        uint32_t low;
+                        if (text_.substr(pos_, 2) != "\\u") {
+                            return false;
+                        }
+                        pos_ += 2;
+                        if (!ReadHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+}  // namespace
+
+std::string GetMemberField(const Member& m, MemberColumn column) {
+    if (column == MemberColumn::kGeneration) {
+        return std::to_string(m.generation);
+    }
+    const std::string* field = TextField(m, column);
+    return field ? *field : std::string();
+}
+
+void SetMemberField(Member& m, MemberColumn column, std::string value) {
+    if (column == MemberColumn::kGeneration) {
+        int generation = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), generation);
+        m.generation = ec == std::errc() ? generation : 0;
+        return;
+    }
+    if (std::string* field = TextField(m, column)) {
+        *field = std::move(value);
+    }
+}
+
+MemberDiff DiffMembers(const Member& before, const Member& after) {
+    MemberDiff diff;
+    for (int i = static_cast<int>(MemberColumn::kId) + 1; i < kMemberColumnCount; ++i) {
+        auto column = static_cast<MemberColumn>(i);
+        std::string old = GetMemberField(before, column);
+        std::string now = GetMemberField(after, column);
+        if (old == now) {
+            continue;
+        }
+        if (old.size() >= kSpliceMinBytes && now.size() >= kSpliceMinBytes) {
+            diff.push_back(Splice(column, old, now));
+        } else {
+            diff.push_back({.column = column, .before = std::move(old), .after = std::move(now)});
+        }
+    }
+    return diff;
+}
+
+bool ApplyMemberDiff(Member& m, const MemberDiff& diff, bool reverse) {
+    for (const auto& change : diff) {
+        const std::string& from = reverse ? change.after : change.before;
+        const std::string& to = reverse ? change.before : change.after;
+        std::string value = GetMemberField(m, change.column);
+        if (change.splice) {
+            if (change.at > value.size() || value.compare(change.at, from.size(), from) != 0) {
+                return false;
+            }
+            value.replace(change.at, from.size(), to);
+        } else {
+            if (value != from) {
+                return false;
+            }
+            value = to;
+        }
+        SetMemberField(m, change.column, std::move(value));
+    }
+    return true;
+}
+
+std::string EncodeMemberDiff(const MemberDiff& diff) {
+    size_t bytes = 2;
+    for (const auto& change : diff) {
+        bytes += change.before.size() + change.after.size() + 32;
+    }
+    JsonWriter out(bytes);
+    out.BeginObject();
+    for (const auto& change : diff) {
+        out.Key(kMemberColumnNames[static_cast<int>(change.column)]).BeginArray();
+        if (change.splice) {
+            out.Int(static_cast<int64_t>(change.at));
+        }
+        out.String(change.before).String(change.after).EndArray();
+    }
+    out.EndObject();
+    return out.str();
+}
+
+std::optional<MemberDiff> DecodeMemberDiff(std::string_view changes) {
+    return DiffReader(changes).Read();
+}
+
+}  // namespace clan::core
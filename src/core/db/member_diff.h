@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/db/member_columns.h"
+#include "core/db/models.h"
+
+namespace clan::core {
+
+// One changed member column. Short values are kept whole. Long text (bios) keeps only
+// the edited span: `before`/`after` are the differing middle parts starting at byte `at`,
+// with the common prefix and suffix left out.
+struct FieldChange {
+    MemberColumn column = MemberColumn::kName;
+    std::string before;
+    std::string after;
+    bool splice = false;
+    size_t at = 0;  // splice offset, in both values
+};
+
+// Changed columns in MemberColumn order. The id is the log target and never part of it.
+using MemberDiff = std::vector<FieldChange>;
+
+MemberDiff DiffMembers(const Member& before, const Member& after);
+
+// Applies `diff` to `m` (before -> after, or after -> before when `reverse`). Returns
+// false, leaving `m` partly updated, when `m` does not hold the values the diff starts
+// from, i.e. the history does not line up with the record.
+bool ApplyMemberDiff(Member& m, const MemberDiff& diff, bool reverse = false);
+
+// operation_logs.changes encoding: a JSON object keyed by column name, with
+// ["old","new"] for whole values and [at,"old","new"] for spliced ones. A CREATE is a
+// diff from an empty Member, a DELETE a diff to one.
+std::string EncodeMemberDiff(const MemberDiff& diff);
+// nullopt for anything else, e.g. the full member JSON older builds logged.
+std::optional<MemberDiff> DecodeMemberDiff(std::string_view changes);
+
+// Column value as text (generation in decimal), and its inverse
+std::string GetMemberField(const Member& m, MemberColumn column);
+void SetMemberField(Member& m, MemberColumn column, std::string value);
+
+}  // namespace clan::core
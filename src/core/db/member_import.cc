@@ -0,0 +1,498 @@
+#include "core/db/member_import.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace clan::core {
+
+namespace {
+
+constexpr std::string_view kUtf8Bom = "\xEF\xBB\xBF";
+
+std::string_view Trim(std::string_view s) {
+    const char* ws = " \t\r\n";
+    size_t begin = s.find_first_not_of(ws);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return s.substr(begin, s.find_last_not_of(ws) - begin + 1);
+}
+
+void StripBom(std::string& s) {
+    if (std::string_view(s).substr(0, kUtf8Bom.size()) == kUtf8Bom) {
+        s.erase(0, kUtf8Bom.size());
+    }
+}
+
+int ParseGeneration(std::string_view text) {
+    text = Trim(text);
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return (ec == std::errc() && value > 0) ? value : 1;
+}
+
+// "1 JAN 1880" -> "1880-01-01", "JAN 1880" -> "1880-01"; anything else (ranges,
+// approximations like "ABT 1880", bare years) is kept as written.
+std::string GedcomDateToIso(std::string_view date) {
+    static constexpr std::string_view kMonths[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                                   "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    std::vector<std::string_view> parts;
+    for (size_t pos = 0; pos < date.size();) {
+        size_t end = date.find(' ', pos);
+        if (end == std::string_view::npos) {
+            end = date.size();
+        }
+        if (end > pos) {
+            parts.push_back(date.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+    auto month = [&](std::string_view m) -> int {
+        for (int i = 0; i < 12; ++i) {
+            if (kMonths[i] == m) {
+                return i + 1;
+            }
+        }
+        return 0;
+    };
+    auto number = [](std::string_view s, int& out) {
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+        return ec == std::errc() && ptr == s.data() + s.size();
+    };
+
+    char buf[16];
+    int day = 0, year = 0, m = 0;
+    if (parts.size() == 3 && number(parts[0], day) && (m = month(parts[1])) &&
+        number(parts[2], year)) {
+        std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, m, day);
+        return buf;
+    }
+    if (parts.size() == 2 && (m = month(parts[0])) && number(parts[1], year)) {
+        std::snprintf(buf, sizeof(buf), "%04d-%02d", year, m);
+        return buf;
+    }
+    return std::string(date);
+}
+
+// "John /Smith/" -> "John Smith", "/陈/大伯" -> "陈大伯"
+std::string GedcomName(std::string_view value) {
+    std::string name;
+    bool space = false;
+    for (char c : value) {
+        if (c == '/') {
+            continue;
+        }
+        if (c == ' ') {
+            space = !name.empty();
+            continue;
+        }
+        if (space) {
+            name += ' ';
+            space = false;
+        }
+        name += c;
+    }
+    return name;
+}
+
+std::string StripXref(std::string_view xref) {
+    xref = Trim(xref);
+    if (xref.size() >= 2 && xref.front() == '@' && xref.back() == '@') {
+        xref = xref.substr(1, xref.size() - 2);
+    }
+    return std::string(xref);
+}
+
+// Keeps the file stream alive for sources that read lazily.
+struct FileHolder {
+    explicit FileHolder(const std::string& path) : file(path, std::ios::binary) {}
+    std::ifstream file;
+};
+
+template <typename Source>
+class FileSource : private FileHolder, public Source {
+  public:
+    template <typename... Args>
+    explicit FileSource(const std::string& path, Args&&... args)
+        : FileHolder(path),
+          Source(file, std::forward<Args>(args)...) {}
+};
+
+}  // namespace
+
+// ---------------------------------------------------------
+// CSV
+// ---------------------------------------------------------
+
+CsvMemberSource::CsvMemberSource(std::istream& in) : in_(in) {
+    columns_.fill(-1);
+    if (!ReadRow()) {
+        throw std::runtime_error("CSV is empty");
+    }
+    if (!row_.empty()) {
+        StripBom(row_[0]);
+    }
+
+    static constexpr std::pair<std::string_view, Field> kHeaders[] = {
+        {"Id", kId},
+        {"Name", kName},
+        {"Gender", kGender},
+        {"Generation", kGeneration},
+        {"FatherName", kFatherName},
+        {"GenerationName", kGenerationName},
+        {"Spouse", kSpouse},
+        {"BirthDate", kBirthDate},
+        {"DeathDate", kDeathDate},
+        {"BirthPlace", kBirthPlace},
+        {"DeathPlace", kDeathPlace},
+        {"Bio", kBio},
+        {"Aliases", kAliases},
+        {"PortraitPath", kPortraitPath},
+    };
+    for (size_t i = 0; i < row_.size(); ++i) {
+        std::string_view header = Trim(row_[i]);
+        for (const auto& [name, field] : kHeaders) {
+            if (header == name) {
+                columns_[field] = static_cast<int>(i);
+            }
+        }
+    }
+    if (columns_[kName] < 0) {
+        throw std::runtime_error("CSV is missing the 'Name' column");
+    }
+
+    static constexpr std::pair<Field, ImportColumn> kColumns[] = {
+        {kGender, kImportGender},
+        {kGeneration, kImportGeneration},
+        {kFatherName, kImportFather},
+        {kGenerationName, kImportGenerationName},
+        {kSpouse, kImportSpouse},
+        {kBirthDate, kImportBirthDate},
+        {kDeathDate, kImportDeathDate},
+        {kBirthPlace, kImportBirthPlace},
+        {kDeathPlace, kImportDeathPlace},
+        {kBio, kImportBio},
+        {kAliases, kImportAliases},
+        {kPortraitPath, kImportPortrait},
+    };
+    for (const auto& [field, column] : kColumns) {
+        if (columns_[field] >= 0) {
+            present_ |= column;
+        }
+    }
+}
+
+// Reads one record into row_ (reusing its strings). A quoted field may span lines.
+bool CsvMemberSource::ReadRow() {
+    if (!std::getline(in_, line_)) {
+        return false;
+    }
+    ++line_number_;
+
+    size_t count = 0;
+    auto nextField = [&]() -> std::string& {
+        if (count == row_.size()) {
+            row_.emplace_back();
+        }
+        std::string& f = row_[count++];
+        f.clear();
+        return f;
+    };
+
+    std::string* field = &nextField();
+    bool quoted = false;
+    size_t i = 0;
+    while (true) {
+        if (i >= line_.size()) {
+            if (!quoted) {
+                break;
+            }
+            if (!std::getline(in_, line_)) {
+                throw std::runtime_error("CSV: unterminated quoted field at line " +
+                                         std::to_string(line_number_));
+            }
+            ++line_number_;
+            field->push_back('\n');
+            i = 0;
+            continue;
+        }
+
+        char c = line_[i++];
+        if (quoted) {
+            if (c != '"') {
+                field->push_back(c);
+            } else if (i < line_.size() && line_[i] == '"') {
+                field->push_back('"');  // "" inside quotes
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == ',') {
+            field = &nextField();
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c != '\r' || i != line_.size()) {
+            field->push_back(c);
+        }
+    }
+    row_.resize(count);
+    return true;
+}
+
+const std::string& CsvMemberSource::FieldText(Field f) const {
+    static const std::string kEmpty;
+    int column = columns_[f];
+    return (column >= 0 && static_cast<size_t>(column) < row_.size()) ? row_[column] : kEmpty;
+}
+
+bool CsvMemberSource::Next(ImportRecord& record) {
+    do {
+        if (!ReadRow()) {
+            return false;
+        }
+    } while (row_.size() == 1 && Trim(row_[0]).empty());  // blank line
+
+    Member& m = record.member;
+    m.id = Trim(FieldText(kId));
+    m.name = Trim(FieldText(kName));
+    m.gender = Trim(FieldText(kGender));
+    m.generation = ParseGeneration(FieldText(kGeneration));
+    m.generation_name = FieldText(kGenerationName);
+    m.aliases = FieldText(kAliases);
+    m.father_id.clear();
+    m.father_name.clear();
+    m.mother_id.clear();
+    m.spouse_name = FieldText(kSpouse);
+    m.birth_date = FieldText(kBirthDate);
+    m.death_date = FieldText(kDeathDate);
+    m.birth_place = FieldText(kBirthPlace);
+    m.death_place = FieldText(kDeathPlace);
+    m.portrait_path = FieldText(kPortraitPath);
+    m.bio = FieldText(kBio);
+    record.father_name = Trim(FieldText(kFatherName));
+    record.columns = present_;
+    return true;
+}
+
+// ---------------------------------------------------------
+// GEDCOM
+// ---------------------------------------------------------
+
+GedcomMemberSource::GedcomMemberSource(std::istream& in, const std::string& idPrefix) {
+    auto memberId = [&idPrefix](std::string_view xref) { return idPrefix + StripXref(xref); };
+    struct Family {
+        std::string husband;
+        std::string wife;
+        std::vector<std::string> children;
+    };
+    std::unordered_map<std::string, Family> families;
+    std::unordered_map<std::string, std::string> childOf;  // FAMC of each individual
+
+    enum class Record { kNone, kIndividual, kFamily } record = Record::kNone;
+    enum class Context { kNone, kBirth, kDeath, kNote } context = Context::kNone;
+    Family* family = nullptr;
+    bool named = false;
+
+    std::string line;
+    bool first = true;
+    while (std::getline(in, line)) {
+        if (first) {
+            StripBom(line);
+            first = false;
+        }
+        std::string_view rest = Trim(line);
+        if (rest.empty()) {
+            continue;
+        }
+
+        // level [@xref@] TAG [value]
+        int level = 0;
+        auto [ptr, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), level);
+        if (ec != std::errc()) {
+            throw std::runtime_error("GEDCOM: malformed line: " + line);
+        }
+        rest = Trim(rest.substr(ptr - rest.data()));
+        std::string_view xref;
+        if (!rest.empty() && rest.front() == '@') {
+            size_t end = rest.find(' ');
+            xref = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view{} : Trim(rest.substr(end));
+        }
+        size_t space = rest.find(' ');
+        std::string_view tag = rest.substr(0, space);
+        // Values keep their inner spacing; only the separator after the tag is dropped
+        std::string_view value =
+            space == std::string_view::npos ? std::string_view{} : rest.substr(space + 1);
+
+        if (level == 0) {
+            context = Context::kNone;
+            if (tag == "INDI") {
+                record = Record::kIndividual;
+                named = false;
+                ImportRecord& r = records_.emplace_back();
+                r.member.id = memberId(xref);
+                r.columns = kImportAllColumns & ~(kImportGenerationName | kImportSpouse |
+                                                  kImportPortrait | kImportAliases);
+            } else if (tag == "FAM") {
+                record = Record::kFamily;
+                family = &families[StripXref(xref)];
+            } else {
+                record = Record::kNone;
+            }
+            continue;
+        }
+
+        if (record == Record::kIndividual) {
+            Member& m = records_.back().member;
+            if (level == 1) {
+                context = Context::kNone;
+                if (tag == "NAME" && !named) {
+                    m.name = GedcomName(value);
+                    named = true;
+                } else if (tag == "SEX") {
+                    m.gender = (value == "M" || value == "F") ? std::string(value) : "";
+                } else if (tag == "BIRT") {
+                    context = Context::kBirth;
+                } else if (tag == "DEAT") {
+                    context = Context::kDeath;
+                } else if (tag == "NOTE") {
+                    m.bio = value;
+                    context = Context::kNote;
+                } else if (tag == "FAMC") {
+                    childOf.emplace(m.id, StripXref(value));
+                }
+            } else if (level == 2) {
+                if (context == Context::kBirth || context == Context::kDeath) {
+                    bool birth = context == Context::kBirth;
+                    if (tag == "DATE") {
+                        (birth ? m.birth_date : m.death_date) = GedcomDateToIso(Trim(value));
+                    } else if (tag == "PLAC") {
+                        (birth ? m.birth_place : m.death_place) = Trim(value);
+                    }
+                } else if (context == Context::kNote) {
+                    if (tag == "CONT") {
+                        m.bio += '\n';
+                        m.bio += value;
+                    } else if (tag == "CONC") {
+                        m.bio += value;
+                    }
+                }
+            }
+        } else if (record == Record::kFamily && level == 1) {
+            if (tag == "HUSB") {
+                family->husband = memberId(value);
+            } else if (tag == "WIFE") {
+                family->wife = memberId(value);
+            } else if (tag == "CHIL") {
+                family->children.push_back(memberId(value));
+            }
+        }
+    }
+
+    std::unordered_map<std::string, size_t> indexById;
+    for (size_t i = 0; i < records_.size(); ++i) {
+        indexById.emplace(records_[i].member.id, i);
+    }
+    auto link = [&](const std::string& childId, const Family& fam) {
+        auto it = indexById.find(childId);
+        if (it == indexById.end()) {
+            return;
+        }
+        Member& child = records_[it->second].member;
+        if (child.father_id.empty()) {
+            child.father_id = fam.husband;
+        }
+        if (child.mother_id.empty()) {
+            child.mother_id = fam.wife;
+        }
+    };
+    for (const auto& [id, fam] : families) {
+        for (const auto& child : fam.children) {
+            link(child, fam);
+        }
+    }
+    for (const auto& [childId, famId] : childOf) {
+        if (auto it = families.find(famId); it != families.end()) {
+            link(childId, it->second);
+        }
+    }
+
+    // Generation = father's generation + 1, resolved iteratively (deep lines, bad cycles)
+    std::vector<int> generation(records_.size(), 0);
+    std::vector<size_t> chain;
+    for (size_t i = 0; i < records_.size(); ++i) {
+        chain.clear();
+        size_t cur = i;
+        while (generation[cur] == 0) {
+            generation[cur] = -1;  // on the current chain
+            chain.push_back(cur);
+            auto it = indexById.find(records_[cur].member.father_id);
+            if (it == indexById.end()) {
+                break;
+            }
+            cur = it->second;
+        }
+        int base = generation[cur] > 0 ? generation[cur] : 0;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            generation[*it] = ++base;
+        }
+    }
+    for (size_t i = 0; i < records_.size(); ++i) {
+        records_[i].member.generation = generation[i];
+    }
+}
+
+bool GedcomMemberSource::Next(ImportRecord& record) {
+    if (next_ >= records_.size()) {
+        return false;
+    }
+    record = std::move(records_[next_++]);
+    return true;
+}
+
+std::unique_ptr<MemberSource> OpenMemberSource(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? std::string() : path.substr(dot);
+    for (char& c : ext) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (ext != ".csv" && ext != ".ged" && ext != ".gedcom") {
+        throw std::runtime_error("Unsupported import format: " + path);
+    }
+    if (!std::ifstream(path, std::ios::binary)) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    if (ext == ".csv") {
+        return std::make_unique<FileSource<CsvMemberSource>>(path);
+    }
+    std::string fileName = std::filesystem::path(path).filename().string();
+    return std::make_unique<FileSource<GedcomMemberSource>>(path, fileName + ":");
+}
+
+std::string GenerateMemberId() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t hi = rng();
+    uint64_t lo = rng();
+    hi = (hi & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;  // version 4
+    lo = (lo & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;  // RFC 4122 variant
+
+    char buf[37];
+    std::snprintf(buf, sizeof(buf), "%08x-%04x-%04x-%04x-%012llx",
+                  static_cast<unsigned>(hi >> 32), static_cast<unsigned>((hi >> 16) & 0xFFFF),
+                  static_cast<unsigned>(hi & 0xFFFF), static_cast<unsigned>(lo >> 48),
+                  static_cast<unsigned long long>(lo & 0xFFFFFFFFFFFFULL));
+    return buf;
+}
+
+}  // namespace clan::core
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/db/models.h"
+
+namespace clan::core {
+
+// Member columns an import source can supply. When a row updates an existing member, the
+// columns its source does not supply keep their stored values (e.g. a CSV without a
+// PortraitPath column leaves portraits set in the app alone).
+enum ImportColumn : uint32_t {
+    kImportGender = 1u << 0,
+    kImportGeneration = 1u << 1,
+    kImportGenerationName = 1u << 2,
+    kImportFather = 1u << 3,  // father_id, from an id or a FatherName
+    kImportMother = 1u << 4,
+    kImportSpouse = 1u << 5,
+    kImportBirthDate = 1u << 6,
+    kImportDeathDate = 1u << 7,
+    kImportBirthPlace = 1u << 8,
+    kImportDeathPlace = 1u << 9,
+    kImportPortrait = 1u << 10,
+    kImportBio = 1u << 11,
+    kImportAliases = 1u << 12,
+    kImportAllColumns = (1u << 13) - 1,
+};
+
+// One parsed input row. The father is referenced either by id (member.father_id, e.g.
+// GEDCOM) or by name (father_name, e.g. the CSV FatherName column).
+struct ImportRecord {
+    Member member;            // member.id may be empty; see DatabaseManager::ImportMembers
+    std::string father_name;  // used only when member.father_id is empty
+    uint32_t columns = kImportAllColumns;  // ImportColumn bits the source supplies
+};
+
+// Random RFC 4122 version 4 id, in the form the UI assigns to new members.
+std::string GenerateMemberId();
+
+// Streaming producer of import rows.
+class MemberSource {
+  public:
+    virtual ~MemberSource() = default;
+    // Overwrites every field of `record` with the next row; false at end of input.
+    // Throws std::runtime_error on malformed input.
+    virtual bool Next(ImportRecord& record) = 0;
+};
+
+// CSV with a header row, in the layout of scripts/clan_data.csv:
+//   Name,Gender,Generation,FatherName,GenerationName,Spouse,BirthDate,DeathDate,
+//   BirthPlace,DeathPlace,Bio
+// plus the optional columns Id, Aliases and PortraitPath. Columns are matched by header
+// name in any order, and only the columns present are supplied (mother_id never is);
+// RFC 4180 quoting (including line breaks inside quotes) is supported.
+class CsvMemberSource : public MemberSource {
+  public:
+    explicit CsvMemberSource(std::istream& in);
+    bool Next(ImportRecord& record) override;
+
+  private:
+    enum Field {
+        kId,
+        kName,
+        kGender,
+        kGeneration,
+        kFatherName,
+        kGenerationName,
+        kSpouse,
+        kBirthDate,
+        kDeathDate,
+        kBirthPlace,
+        kDeathPlace,
+        kBio,
+        kAliases,
+        kPortraitPath,
+        kFieldCount
+    };
+
+    bool ReadRow();
+    const std::string& FieldText(Field f) const;
+
+    std::istream& in_;
+    std::array<int, kFieldCount> columns_;  // field -> column index, -1 if absent
+    std::vector<std::string> row_;
+    std::string line_;
+    size_t line_number_ = 0;
+    uint32_t present_ = 0;  // ImportColumn bits of the header
+};
+
+// GEDCOM 5.5 individuals (INDI) linked through families (FAM: HUSB/WIFE/CHIL). Families
+// usually follow the individuals they reference, so the file is parsed up front; GEDCOM
+// xrefs become member ids behind `idPrefix` ("@I12@" -> "<idPrefix>I12") and generations
+// are derived from the father links (roots are generation 1). Xrefs are only unique within
+// one file, so the prefix keeps two files from overwriting each other's members.
+// Generation name, spouse, portrait and aliases are not supplied.
+class GedcomMemberSource : public MemberSource {
+  public:
+    explicit GedcomMemberSource(std::istream& in, const std::string& idPrefix = {});
+    bool Next(ImportRecord& record) override;
+
+  private:
+    std::vector<ImportRecord> records_;
+    size_t next_ = 0;
+};
+
+// Opens a .csv or .ged file. GEDCOM ids are prefixed with the file name ("family.ged" ->
+// "family.ged:I12"), so re-importing a file updates its members and another file gets
+// its own. Throws std::runtime_error if the file cannot be opened or the format is not
+// recognized.
+std::unique_ptr<MemberSource> OpenMemberSource(const std::string& path);
+
+struct ImportProgress {
+    size_t rows = 0;        // rows written so far
+    bool indexing = false;  // rows done; rebuilding the search index
+};
+using ImportProgressFn = std::function<void(const ImportProgress&)>;
+
+struct ImportResult {
+    bool ok = false;
+    size_t imported = 0;            // rows inserted or updated
+    size_t matched = 0;             // id-less rows that updated an existing member
+    size_t skipped = 0;             // rows without a name
+    size_t unresolved_fathers = 0;  // FatherName matching no member
+    long long elapsed_ms = 0;
+    std::string error;
+};
+
+}  // namespace clan::core
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+namespace clan::core {
+
+struct MediaResource {
+    std::string id;
+    std::string member_id;
+    std::string resource_type;
+    std::string file_path;
+    std::string title;
+    std::string description;
+    std::string file_hash;
+    long long file_size = 0;
+    long long created_at = 0;
+};
+
+// Operation log for tracking changes
+struct OperationLog {
+    int id = 0;
+    std::string action;       // CREATE, UPDATE, DELETE
+    std::string target_type;  // member, media
+    std::string target_id;
+    std::string target_name;
+    std::string changes;  // JSON string of changes
+    long long created_at = 0;
+};
+// 产品级结构体：包含完整的家谱信息
+struct Member {
+    std::string id;
+    std::string name;
+    std::string gender;  // "M" or "F"
+    int generation = 1;
+    std::string generation_name;  // 字辈 (如 "定", "英")
+    std::string aliases;          // 别名 (JSON or comma separated)
+
+    // 关系
+    std::string father_id;    // 父亲 ID
+    std::string father_name;  // 父亲姓名 (Query result only)
+    std::string mother_id;    // 母亲 ID系关联
+    std::string spouse_name;  // 配偶姓名
+
+    // 时间与地点 (使用 ISO 8601 字符串 "YYYY-MM-DD")
+    std::string birth_date;
+    std::string death_date;
+    std::string birth_place;
+    std::string death_place;
+
+    // 媒体与描述
+    std::string portrait_path;  // 头像路径
+    std::string bio;            // 生平传记 (支持 FTS 全文检索)
+};
+
+}  // namespace clan::core
@@ -0,0 +1,143 @@
+#include "core/db/operation_log_writer.h"
+
+#include <utility>
+
+namespace clan::core {
+
+OperationLogWriter::OperationLogWriter(CommitFn commit, OperationLogWriterOptions options)
+    : commit_(std::move(commit)),
+      options_(options) {
+    if (options_.batch_size == 0) {
+        options_.batch_size = 1;
+    }
+    thread_ = std::thread([this] { Run(); });
+}
+
+OperationLogWriter::~OperationLogWriter() {
+    Stop();
+}
+
+void OperationLogWriter::Append(OperationLog entry) {
+    if (entry.created_at == 0) {
+        entry.created_at = std::chrono::duration_cast<std::chrono::seconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+    }
+    queue_.Push(std::move(entry));
+    uint64_t appended = appended_.fetch_add(1) + 1;
+
+    if (stopped_.load(std::memory_order_acquire)) {
+        std::vector<OperationLog> batch;
+        Drain(batch);
+        return;
+    }
+    // Wake the writer when this entry starts a batch (it may be idle) or fills one;
+    // entries in between are picked up by the batch's max_delay wait.
+    uint64_t handled = handled_.load();
+    uint64_t pending = appended > handled ? appended - handled : 0;
+    if (pending == 1 || pending % options_.batch_size == 0) {
+        Wake();
+    }
+}
+
+void OperationLogWriter::Wake() {
+    // Taking the mutex orders the notify after the writer's predicate check, so the
+    // wake-up cannot fall between its check and its wait
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    wake_.notify_one();
+}
+
+void OperationLogWriter::Flush() {
+    const uint64_t target = appended_.load();
+    if (stopped_.load(std::memory_order_acquire)) {
+        std::vector<OperationLog> batch;
+        Drain(batch);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (handled_ >= target) {
+        return;
+    }
+    ++flush_waiters_;
+    wake_.notify_one();
+    done_.wait(lock, [&] { return handled_ >= target || stopped_.load(); });
+    --flush_waiters_;
+}
+
+void OperationLogWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    stopped_.store(true, std::memory_order_release);
+    // Appends that raced with the shutdown
+    std::vector<OperationLog> batch;
+    Drain(batch);
+    done_.notify_all();
+}
+
+OperationLogWriter::Stats OperationLogWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.appended = appended_.load();
+    return stats;
+}
+
+size_t OperationLogWriter::Drain(std::vector<OperationLog>& batch) {
+    std::lock_guard<std::mutex> drain(drain_mutex_);
+    batch.clear();
+    while (auto entry = queue_.Pop()) {
+        batch.push_back(std::move(*entry));
+    }
+    if (batch.empty()) {
+        return 0;
+    }
+    bool ok = false;
+    try {
+        ok = commit_(batch);
+    } catch (...) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handled_.fetch_add(batch.size());
+        ++stats_.batches;
+        (ok ? stats_.committed : stats_.dropped) += batch.size();
+    }
+    done_.notify_all();
+    return batch.size();
+}
+
+void OperationLogWriter::Run() {
+    std::vector<OperationLog> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // The writer can pop an entry before its Append bumps appended_
+            auto pending = [&] {
+                uint64_t appended = appended_.load(), handled = handled_.load();
+                return appended > handled ? appended - handled : 0;
+            };
+            // Idle: sleep until an entry, a flush or shutdown arrives
+            wake_.wait(lock, [&] { return stopping_ || pending() > 0; });
+            // Collecting: give the batch max_delay to fill up
+            wake_.wait_for(lock, options_.max_delay, [&] {
+                return stopping_ || flush_waiters_ > 0 || pending() >= options_.batch_size;
+            });
+        }
+        Drain(batch);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ && appended_.load() <= handled_.load()) {
+            return;
+        }
+    }
+}
+
+}  // namespace clan::core
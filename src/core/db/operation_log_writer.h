@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/db/models.h"
+#include "core/task/mpsc_queue.h"
+
+namespace clan::core {
+
+struct OperationLogWriterOptions {
+    // Commit as soon as this many entries are waiting...
+    size_t batch_size = 256;
+    // ...or once the first of them has waited this long
+    std::chrono::milliseconds max_delay{200};
+};
+
+// Append-only audit trail in front of operation_logs.
+//
+// Callers hand entries to a lock-free queue and return; a background thread commits
+// them in batches, one transaction per batch, so an audited save costs an allocation
+// instead of an INSERT on the save path. Flush() and the destructor wait until
+// everything appended before them is written.
+class OperationLogWriter {
+  public:
+    // Writes one batch (in append order); returns false if it was lost. Runs on the
+    // writer thread, or on the caller's thread once the writer has stopped.
+    using CommitFn = std::function<bool(const std::vector<OperationLog>& batch)>;
+
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t committed = 0;  // entries written
+        uint64_t dropped = 0;    // entries in batches the commit function rejected
+        uint64_t batches = 0;    // commit calls
+    };
+
+    explicit OperationLogWriter(CommitFn commit, OperationLogWriterOptions options = {});
+    ~OperationLogWriter();  // Stop()
+
+    OperationLogWriter(const OperationLogWriter&) = delete;
+    OperationLogWriter& operator=(const OperationLogWriter&) = delete;
+
+    // Never touches the database. created_at is stamped here when left at 0. Lock-free
+    // except for the calls that wake an idle writer or complete a batch, which take the
+    // wake-up mutex briefly.
+    void Append(OperationLog entry);
+
+    // Blocks until every entry appended before the call is committed or dropped.
+    void Flush();
+
+    // Flushes and ends the writer thread. Later appends are committed synchronously.
+    void Stop();
+
+    Stats stats() const;
+
+  private:
+    void Run();
+    // Pops everything currently queued and commits it; returns the number of entries.
+    size_t Drain(std::vector<OperationLog>& batch);
+    void Wake();
+
+    CommitFn commit_;
+    OperationLogWriterOptions options_;
+    MpscQueue<OperationLog> queue_;
+
+    // pending = appended_ - handled_. Both are read without the mutex: a producer whose
+    // entry is the only one pending wakes the writer, any other can rely on it being awake.
+    std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> handled_{0};  // committed + dropped; written under mutex_
+    std::atomic<bool> stopped_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;  // writer: work, flush request or stop
+    std::condition_variable done_;  // flushers: handled_ advanced
+    size_t flush_waiters_ = 0;
+    bool stopping_ = false;
+    Stats stats_;  // committed/dropped/batches, guarded by mutex_
+
+    std::mutex drain_mutex_;  // one consumer at a time (writer thread, or Stop/late appends)
+    std::thread thread_;
+};
+
+}  // namespace clan::core
@@ -0,0 +1,72 @@
+#include "core/db/schema_migrator.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "core/log/log.h"
+
+namespace clan::core {
+
+SchemaMigrator::SchemaMigrator(SQLite::Database& db) : db_(db) {
+    db_.exec(R"(
+        CREATE TABLE IF NOT EXISTS schema_version (
+            version INTEGER PRIMARY KEY,
+            description TEXT,
+            applied_at INTEGER,
+            duration_ms INTEGER
+        );
+    )");
+}
+
+int SchemaMigrator::CurrentVersion() {
+    SQLite::Statement query(db_, "SELECT IFNULL(MAX(version), 0) FROM schema_version");
+    return query.executeStep() ? query.getColumn(0).getInt() : 0;
+}
+
+std::vector<MigrationReport> SchemaMigrator::Migrate(const std::vector<SchemaMigration>& steps) {
+    std::vector<MigrationReport> applied;
+    int current = CurrentVersion();
+
+    for (const auto& step : steps) {
+        if (step.version <= current) {
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            SQLite::Transaction transaction(db_);
+            step.apply(db_);
+
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+            int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+            SQLite::Statement record(db_, R"(
+                INSERT INTO schema_version (version, description, applied_at, duration_ms)
+                VALUES (?, ?, ?, ?)
+            )");
+            record.bind(1, step.version);
+            record.bind(2, step.description);
+            record.bind(3, now);
+            record.bind(4, static_cast<int64_t>(ms));
+            record.exec();
+            transaction.commit();
+
+            LOGINFO("[DB] Migration v{} ({}) applied in {} ms", step.version, step.description,
+                    ms);
+            applied.push_back({step.version, step.description, ms});
+            current = step.version;
+        } catch (std::exception& e) {
+            LOGERROR("[DB] Migration v{} ({}) failed, schema stays at v{}: {}", step.version,
+                     step.description, current, e.what());
+            break;
+        }
+    }
+    return applied;
+}
+
+}  // namespace clan::core
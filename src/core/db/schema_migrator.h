@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SQLite {
+class Database;
+}
+
+namespace clan::core {
+
+struct SchemaMigration {
+    int version = 0;  // strictly increasing, starting at 1
+    std::string description;
+    std::function<void(SQLite::Database&)> apply;  // throws on failure
+};
+
+struct MigrationReport {
+    int version = 0;
+    std::string description;
+    long long duration_ms = 0;
+};
+
+// Versioned schema migrations tracked in a `schema_version` table.
+//
+// Each step whose version is above the recorded one runs in its own transaction together
+// with the row that records it, so a failing step leaves the schema at the previous
+// version and is retried on the next start. Steps that are already applied cost nothing:
+// opening an up-to-date database is a single SELECT.
+class SchemaMigrator {
+  public:
+    explicit SchemaMigrator(SQLite::Database& db);
+
+    // Highest applied version; 0 for a new or pre-versioning database.
+    int CurrentVersion();
+
+    // Applies the pending steps in order and returns what ran. Stops at the first failing
+    // step (logged, not thrown); later steps are skipped until it succeeds.
+    std::vector<MigrationReport> Migrate(const std::vector<SchemaMigration>& steps);
+
+  private:
+    SQLite::Database& db_;
+};
+
+}  // namespace clan::core
@@ -0,0 +1,210 @@
+#include "core/db/search_cache.h"
+
+#include <string_view>
+#include <utility>
+
+#include "core/db/cjk_tokenizer.h"
+
+namespace clan::core {
+
+namespace {
+
+void AsciiLower(std::string& text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+}
+
+// Runs of a keyword or document with word runs lowercased, as the cjk tokenizer sees them
+std::vector<KeywordRun> NormalizedRuns(std::string_view text) {
+    auto runs = SplitKeywordRuns(text);
+    for (auto& run : runs) {
+        if (!run.cjk) {
+            AsciiLower(run.text);
+        }
+    }
+    return runs;
+}
+
+std::vector<KeywordRun> DocumentRuns(const Member& m) {
+    auto runs = NormalizedRuns(m.name);
+    for (const std::string* column : {&m.bio, &m.aliases}) {
+        auto more = NormalizedRuns(*column);
+        runs.insert(runs.end(), std::make_move_iterator(more.begin()),
+                    std::make_move_iterator(more.end()));
+    }
+    return runs;
+}
+
+bool MatchesRuns(const std::vector<KeywordRun>& keywordRuns,
+                 const std::vector<KeywordRun>& docRuns) {
+    if (keywordRuns.empty()) {
+        return false;  // dropped from the FTS query
+    }
+    for (const auto& run : keywordRuns) {
+        bool found = false;
+        for (const auto& doc : docRuns) {
+            if (doc.cjk == run.cjk && (run.cjk ? doc.text.find(run.text) != std::string::npos
+                                               : doc.text.starts_with(run.text))) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// True when every document matching `longer` also matches `shorter`: the same runs, the
+// last one extended (a longer substring or prefix), possibly followed by more runs.
+bool Narrows(const std::vector<KeywordRun>& shorter, const std::vector<KeywordRun>& longer) {
+    if (shorter.empty() || longer.size() < shorter.size()) {
+        return false;
+    }
+    const size_t last = shorter.size() - 1;
+    for (size_t i = 0; i < last; ++i) {
+        if (shorter[i].cjk != longer[i].cjk || shorter[i].text != longer[i].text) {
+            return false;
+        }
+    }
+    return shorter[last].cjk == longer[last].cjk &&
+           longer[last].text.starts_with(shorter[last].text);
+}
+
+std::string CacheKey(const std::vector<std::string>& keywords, int limit, uint64_t revision,
+                     std::string_view lastKeyword) {
+    std::string key = std::to_string(revision) + '/' + std::to_string(limit) + '/';
+    for (size_t i = 0; i + 1 < keywords.size(); ++i) {
+        key += keywords[i];
+        key += ' ';
+    }
+    key += lastKeyword;
+    AsciiLower(key);  // both FTS and LIKE ignore ASCII case
+    return key;
+}
+
+}  // namespace
+
+bool MatchesFtsKeyword(const Member& member, const std::string& keyword) {
+    return MatchesRuns(NormalizedRuns(keyword), DocumentRuns(member));
+}
+
+SearchCache::SearchCache(size_t capacity)
+    : cache_(capacity) {
+}
+
+SearchCache::ResultPtr SearchCache::Search(const std::vector<std::string>& keywords, int limit,
+                                           uint64_t revision, const Query& query) {
+    if (keywords.empty()) {
+        return std::make_shared<Result>();
+    }
+    const std::string key = CacheKey(keywords, limit, revision, keywords.back());
+
+    if (auto cached = cache_.Get(key)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.hits;
+        return *cached;
+    }
+    if (auto refined = Refine(keywords, limit, revision)) {
+        cache_.Put(key, refined);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.refined;
+        return refined;
+    }
+
+    std::promise<ResultPtr> promise;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = inflight_.find(key);
+        if (it != inflight_.end()) {
+            auto pending = it->second;
+            ++stats_.shared;
+            lock.unlock();
+            return pending.get();
+        }
+        // Another thread may have finished the same query since the lookup above
+        if (auto cached = cache_.Get(key)) {
+            ++stats_.hits;
+            return *cached;
+        }
+        inflight_.emplace(key, promise.get_future().share());
+        ++stats_.executed;
+    }
+
+    ResultPtr result;
+    try {
+        result = std::make_shared<const Result>(query());
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflight_.erase(key);
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.Put(key, result);
+        inflight_.erase(key);
+    }
+    promise.set_value(result);
+    return result;
+}
+
+// Looks for the longest cached prefix of the last keyword whose rows are a complete FTS
+// result, and keeps the rows that still match.
+SearchCache::ResultPtr SearchCache::Refine(const std::vector<std::string>& keywords, int limit,
+                                           uint64_t revision) {
+    const std::string& last = keywords.back();
+    if (last.empty()) {
+        return nullptr;
+    }
+    const auto lastRuns = NormalizedRuns(last);
+    for (size_t length = last.size() - 1; length > 0; --length) {
+        if ((static_cast<unsigned char>(last[length]) & 0xC0) == 0x80) {
+            continue;  // inside a UTF-8 sequence
+        }
+        std::string_view prefix(last.data(), length);
+        auto cached = cache_.Get(CacheKey(keywords, limit, revision, prefix));
+        if (!cached) {
+            continue;
+        }
+        const Result& base = **cached;
+        if (!base.fts || base.members.size() >= static_cast<size_t>(limit) ||
+            !Narrows(NormalizedRuns(prefix), lastRuns)) {
+            continue;
+        }
+
+        std::vector<std::vector<KeywordRun>> keywordRuns;
+        keywordRuns.reserve(keywords.size());
+        for (const auto& k : keywords) {
+            keywordRuns.push_back(NormalizedRuns(k));
+        }
+        auto refined = std::make_shared<Result>();
+        refined->fts = true;
+        for (const auto& m : base.members) {
+            auto docRuns = DocumentRuns(m);
+            for (const auto& runs : keywordRuns) {
+                if (MatchesRuns(runs, docRuns)) {
+                    refined->members.push_back(m);
+                    break;
+                }
+            }
+        }
+        return refined;
+    }
+    return nullptr;
+}
+
+void SearchCache::Clear() {
+    cache_.Clear();
+}
+
+SearchCache::Stats SearchCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace clan::core
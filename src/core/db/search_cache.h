@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/cache/lru_cache.h"
+#include "core/db/models.h"
+
+namespace clan::core {
+
+// Coalesces member searches in front of SQLite.
+//
+// Results are cached per (tree revision, limit, keywords), so any member mutation makes
+// older entries unreachable. On a miss the cache tries, in order:
+//   - refining a cached prefix: "陈大" -> "陈大伯" or "dab" -> "dabo" filters the rows of
+//     the shorter query in memory instead of searching again. Only FTS results that were
+//     not cut by the limit qualify (every match of the longer query is among them), and
+//     the rows keep the prefix query's ranking.
+//   - joining an identical query that is already running on another thread.
+//   - running the query.
+class SearchCache {
+  public:
+    struct Result {
+        std::vector<Member> members;
+        bool fts = false;  // rows follow members_fts/cjk tokenizer semantics
+    };
+    using ResultPtr = std::shared_ptr<const Result>;
+    using Query = std::function<Result()>;
+
+    struct Stats {
+        uint64_t executed = 0;  // queries that reached the database
+        uint64_t hits = 0;      // served from an exact cache entry
+        uint64_t refined = 0;   // filtered from a cached prefix
+        uint64_t shared = 0;    // waited for an identical query in flight
+    };
+
+    explicit SearchCache(size_t capacity = 64);
+
+    // `keywords` is the whitespace-split search text; `query` runs it against the database
+    // and is only called when nothing above can answer.
+    ResultPtr Search(const std::vector<std::string>& keywords, int limit, uint64_t revision,
+                     const Query& query);
+
+    void Clear();
+    Stats stats() const;
+
+  private:
+    ResultPtr Refine(const std::vector<std::string>& keywords, int limit, uint64_t revision);
+
+    LruCache<std::string, ResultPtr> cache_;
+    mutable std::mutex mutex_;  // guards inflight_ and stats_
+    std::unordered_map<std::string, std::shared_future<ResultPtr>> inflight_;
+    Stats stats_;
+};
+
+// Whether `member` matches `keyword` the way members_fts does: every script run of the
+// keyword (see SplitKeywordRuns) must occur in name, bio or aliases, CJK runs as a
+// substring of a CJK run and other runs as an ASCII case-insensitive word prefix.
+bool MatchesFtsKeyword(const Member& member, const std::string& keyword);
+
+}  // namespace clan::core
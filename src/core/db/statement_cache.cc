@@ -0,0 +1,87 @@
+#include "core/db/statement_cache.h"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include "core/log/log.h"
+
+namespace clan::core {
+
+StatementCache::Handle::Handle(StatementCache* owner, const std::string* sql,
+                               std::unique_ptr<SQLite::Statement> stmt)
+    : owner_(owner),
+      sql_(sql),
+      stmt_(std::move(stmt)) {
+}
+
+StatementCache::Handle::Handle(Handle&& other) noexcept
+    : owner_(other.owner_),
+      sql_(other.sql_),
+      stmt_(std::move(other.stmt_)) {
+    other.owner_ = nullptr;
+}
+
+StatementCache::Handle::~Handle() {
+    if (owner_ && stmt_) {
+        owner_->Release(sql_, std::move(stmt_));
+    }
+}
+
+StatementCache::StatementCache(SQLite::Database& db, size_t capacity)
+    : db_(db),
+      capacity_(capacity) {
+}
+
+StatementCache::~StatementCache() {
+    Clear();
+}
+
+StatementCache::Handle StatementCache::Acquire(const std::string& sql) {
+    auto it = idle_.find(sql);
+    if (it == idle_.end()) {
+        it = idle_.emplace(sql, std::vector<std::unique_ptr<SQLite::Statement>>{}).first;
+    }
+
+    auto& pool = it->second;
+    if (!pool.empty()) {
+        auto stmt = std::move(pool.back());
+        pool.pop_back();
+        --idle_count_;
+        ++hits_;
+        return Handle(this, &it->first, std::move(stmt));
+    }
+
+    ++misses_;
+    // Throws SQLite::Exception on bad SQL, same as constructing the statement directly
+    return Handle(this, &it->first, std::make_unique<SQLite::Statement>(db_, sql));
+}
+
+void StatementCache::Release(const std::string* sql, std::unique_ptr<SQLite::Statement> stmt) {
+    try {
+        // Reset first: it releases read locks held by a partially stepped SELECT.
+        stmt->reset();
+        stmt->clearBindings();
+    } catch (std::exception& e) {
+        // reset() re-reports the last step error; the statement itself is still usable.
+        LOGDEBUG("[DB] Statement reset reported: {}", e.what());
+    }
+
+    if (idle_count_ >= capacity_) {
+        return;  // over budget: finalize instead of pooling
+    }
+    auto it = idle_.find(*sql);
+    if (it == idle_.end()) {
+        return;  // keys are never erased; defensive only
+    }
+    it->second.push_back(std::move(stmt));
+    ++idle_count_;
+}
+
+void StatementCache::Clear() {
+    // Keep the (cheap) keys: outstanding handles point at them.
+    for (auto& [sql, pool] : idle_) {
+        pool.clear();
+    }
+    idle_count_ = 0;
+}
+
+}  // namespace clan::core
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SQLite {
+class Database;
+class Statement;
+}  // namespace SQLite
+
+namespace clan::core {
+
+// Per-connection cache of prepared statements keyed by SQL text.
+//
+// Acquire() hands out a prepared statement (parsing/planning only on the first use of a
+// given SQL text); when the handle goes out of scope the statement is reset, its bindings
+// are cleared and it goes back to the pool. Not thread-safe: the owner serializes access
+// the same way it serializes use of the connection itself.
+class StatementCache {
+  public:
+    class Handle {
+      public:
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&&) = delete;
+        Handle(const Handle&) = delete;
+        ~Handle();
+
+        SQLite::Statement* operator->() const { return stmt_.get(); }
+        SQLite::Statement& operator*() const { return *stmt_; }
+
+      private:
+        friend class StatementCache;
+        Handle(StatementCache* owner, const std::string* sql,
+               std::unique_ptr<SQLite::Statement> stmt);
+
+        StatementCache* owner_;
+        const std::string* sql_;  // key owned by the cache map
+        std::unique_ptr<SQLite::Statement> stmt_;
+    };
+
+    explicit StatementCache(SQLite::Database& db, size_t capacity = 64);
+    ~StatementCache();
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    Handle Acquire(const std::string& sql);
+    // Finalizes every idle statement (e.g. before closing the connection).
+    void Clear();
+
+    size_t size() const { return idle_count_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+  private:
+    void Release(const std::string* sql, std::unique_ptr<SQLite::Statement> stmt);
+
+    SQLite::Database& db_;
+    size_t capacity_;
+    size_t idle_count_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    // Several idle instances per key allow the same SQL to be in use re-entrantly.
+    std::unordered_map<std::string, std::vector<std::unique_ptr<SQLite::Statement>>> idle_;
+};
+
+}  // namespace clan::core
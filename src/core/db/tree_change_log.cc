@@ -0,0 +1,86 @@
+#include "core/db/tree_change_log.h"
+
+#include <unordered_map>
+
+namespace clan::core {
+
+TreeChangeLog::TreeChangeLog(size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity) {
+}
+
+uint64_t TreeChangeLog::Record(TreeChangeKind kind, Member member) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    member.bio.clear();
+    history_.push_back({++revision_, kind, std::move(member)});
+    while (history_.size() > capacity_) {
+        floor_revision_ = history_.front().revision;
+        history_.pop_front();
+    }
+    return revision_;
+}
+
+void TreeChangeLog::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    history_.clear();
+    // Keep the counter monotonic so stale client revisions can never look current.
+    floor_revision_ = ++revision_;
+}
+
+uint64_t TreeChangeLog::revision() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return revision_;
+}
+
+TreeDelta TreeChangeLog::Since(uint64_t sinceRevision) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TreeDelta delta;
+    delta.revision = revision_;
+    if (sinceRevision == revision_) {
+        return delta;
+    }
+    if (sinceRevision < floor_revision_ || sinceRevision > revision_) {
+        delta.full_resync = true;
+        return delta;
+    }
+
+    // Coalesce per member: the client only needs the net effect since its revision.
+    std::unordered_map<std::string, size_t> slot;
+    std::vector<TreeChangeKind> firstKind;
+    for (const auto& change : history_) {
+        if (change.revision <= sinceRevision) {
+            continue;
+        }
+        auto it = slot.find(change.member.id);
+        if (it == slot.end()) {
+            slot.emplace(change.member.id, delta.changes.size());
+            delta.changes.push_back(change);
+            firstKind.push_back(change.kind);
+            continue;
+        }
+        TreeChange& prev = delta.changes[it->second];
+        TreeChangeKind kind = change.kind;
+        if (firstKind[it->second] == TreeChangeKind::kAdd && kind != TreeChangeKind::kRemove) {
+            kind = TreeChangeKind::kAdd;  // still new to the client
+        } else if (firstKind[it->second] != TreeChangeKind::kAdd &&
+                   kind == TreeChangeKind::kAdd) {
+            kind = TreeChangeKind::kUpdate;  // client still holds an older copy
+        }
+        prev = change;
+        prev.kind = kind;
+    }
+
+    // An add that was removed again never reached the client: drop it entirely.
+    std::vector<TreeChange> net;
+    net.reserve(delta.changes.size());
+    for (size_t i = 0; i < delta.changes.size(); ++i) {
+        if (firstKind[i] == TreeChangeKind::kAdd &&
+            delta.changes[i].kind == TreeChangeKind::kRemove) {
+            continue;
+        }
+        net.push_back(std::move(delta.changes[i]));
+    }
+    delta.changes = std::move(net);
+    return delta;
+}
+
+}  // namespace clan::core
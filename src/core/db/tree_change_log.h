@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "core/db/models.h"
+
+namespace clan::core {
+
+enum class TreeChangeKind { kAdd, kUpdate, kRemove };
+
+struct TreeChange {
+    uint64_t revision = 0;
+    TreeChangeKind kind = TreeChangeKind::kUpdate;
+    Member member;  // bio-less summary; only member.id is meaningful for kRemove
+};
+
+struct TreeDelta {
+    uint64_t revision = 0;     // revision the client is at after applying the delta
+    bool full_resync = false;  // history no longer covers the request; refetch the tree
+    std::vector<TreeChange> changes;
+};
+
+// Versioned change feed for the family tree.
+//
+// Every mutation bumps the tree revision and appends a small add/update/remove record.
+// Clients remember the revision of the snapshot they hold and ask for everything after
+// it, so a one-field edit costs O(changed nodes) instead of a full tree re-push. Only
+// the most recent `capacity` changes are retained; older clients get full_resync.
+class TreeChangeLog {
+  public:
+    explicit TreeChangeLog(size_t capacity = 4096);
+
+    uint64_t Record(TreeChangeKind kind, Member member);
+    // Drops the history (e.g. after a full index rebuild) so every client resyncs.
+    void Reset();
+
+    uint64_t revision() const;
+    // Changes after `sinceRevision`, coalesced to at most one entry per member.
+    TreeDelta Since(uint64_t sinceRevision) const;
+
+  private:
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    uint64_t revision_ = 0;
+    uint64_t floor_revision_ = 0;  // oldest revision a delta can start from
+    std::deque<TreeChange> history_;
+};
+
+}  // namespace clan::core
@@ -0,0 +1,71 @@
+#include "core/json/bridge_json.h"
+
+#include <string>
+
+namespace clan::core {
+
+std::string LifeSpan(const Member& m) {
+    std::string span;
+    if (!m.birth_date.empty()) {
+        span = Utf8PrefixUtf16(m.birth_date, 4);
+        if (!m.death_date.empty()) {
+            span += '-';
+            span += Utf8PrefixUtf16(m.death_date, 4);
+        }
+    }
+    return span;
+}
+
+void WriteTreeNodeFields(JsonWriter& out, const Member& m, std::string_view avatarUrl) {
+    out.Field("id", m.id)
+        .Field("name", m.name)
+        .Field("parentId", m.father_id)
+        .Field("generation", m.generation)
+        .Field("generationName", m.generation_name)
+        .Field("spouseName", m.spouse_name)
+        .Field("gender", m.gender)
+        .Field("portraitPath", m.portrait_path);
+    if (!avatarUrl.empty()) {
+        out.Field("avatarUrl", avatarUrl);
+    }
+    out.Field("lifeSpan", LifeSpan(m));
+}
+
+void WriteSearchHitFields(JsonWriter& out, const Member& m) {
+    out.Field("id", m.id)
+        .Field("name", m.name)
+        .Field("generation", m.generation)
+        .Field("generationName", m.generation_name)
+        .Field("parentId", m.father_id)
+        .Field("fatherName", m.father_name)
+        .Field("spouseName", m.spouse_name)
+        .Field("aliases", m.aliases);
+
+    constexpr size_t kSnippetUnits = 50;
+    std::string_view snippet = Utf8PrefixUtf16(m.bio, kSnippetUnits);
+    if (snippet.size() < m.bio.size()) {
+        out.Field("bioSnippet", std::string(snippet) + "...");
+    } else {
+        out.Field("bioSnippet", m.bio);
+    }
+}
+
+void WriteMediaResourceFields(JsonWriter& out, const MediaResource& r, std::string_view url) {
+    out.Field("id", r.id)
+        .Field("title", r.title)
+        .Field("description", r.description)
+        .Field("url", url)
+        .Field("type", r.resource_type);
+}
+
+void WriteOperationLogFields(JsonWriter& out, const OperationLog& log) {
+    out.Field("id", log.id)
+        .Field("action", log.action)
+        .Field("targetType", log.target_type)
+        .Field("targetId", log.target_id)
+        .Field("targetName", log.target_name)
+        .Field("changes", log.changes)
+        .Field("createdAt", static_cast<int64_t>(log.created_at));
+}
+
+}  // namespace clan::core
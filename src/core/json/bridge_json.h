@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "core/db/models.h"
+#include "core/json/json_writer.h"
+
+namespace clan::core {
+
+// Row shapes sent to the web view (see web/src/types). Each function writes the members
+// of one object without the braces, so callers can append extra fields.
+
+// Tree node: id, name, parentId, generation, generationName, spouseName, gender,
+// portraitPath, lifeSpan, plus avatarUrl when non-empty
+void WriteTreeNodeFields(JsonWriter& out, const Member& m, std::string_view avatarUrl);
+// Search hit: summary fields plus fatherName, aliases and a 50-character bioSnippet
+void WriteSearchHitFields(JsonWriter& out, const Member& m);
+void WriteMediaResourceFields(JsonWriter& out, const MediaResource& r, std::string_view url);
+void WriteOperationLogFields(JsonWriter& out, const OperationLog& log);
+
+// "1910-1985" from ISO dates, the birth year alone while alive, empty without a birth date.
+// Each date is cut to 4 UTF-16 units like QString::left, so "民国二十年" keeps "民国二十".
+std::string LifeSpan(const Member& m);
+
+}  // namespace clan::core
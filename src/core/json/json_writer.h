@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace clan::core {
+
+// Append-only UTF-8 JSON writer. Values go straight into one growing buffer: there is no
+// document tree and no UTF-16 round-trip, and Clear() keeps the capacity so a writer can
+// be reused across calls. Input strings are expected to be UTF-8 and are copied verbatim
+// apart from the escapes JSON requires.
+//
+// The caller is responsible for well-formedness (matching Begin/End, a Key before every
+// value inside an object); commas and colons are inserted automatically.
+class JsonWriter {
+  public:
+    explicit JsonWriter(size_t reserveBytes = 0) { out_.reserve(reserveBytes); }
+
+    void Clear() {
+        out_.clear();
+        need_comma_ = false;
+    }
+    void Reserve(size_t bytes) { out_.reserve(bytes); }
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+
+    JsonWriter& Key(std::string_view key);
+    JsonWriter& String(std::string_view value);
+    JsonWriter& Int(int64_t value);
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+    // Already-serialized JSON, inserted as one value
+    JsonWriter& Raw(std::string_view json);
+
+    // Key + value shorthands for object members
+    JsonWriter& Field(std::string_view key, std::string_view value) {
+        return Key(key).String(value);
+    }
+    JsonWriter& Field(std::string_view key, const char* value) {
+        return Key(key).String(value);
+    }
+    JsonWriter& Field(std::string_view key, int64_t value) { return Key(key).Int(value); }
+    JsonWriter& Field(std::string_view key, int value) { return Key(key).Int(value); }
+    JsonWriter& Field(std::string_view key, bool value) { return Key(key).Bool(value); }
+
+    const std::string& str() const { return out_; }
+    size_t size() const { return out_.size(); }
+    size_t capacity() const { return out_.capacity(); }
+
+  private:
+    void BeforeValue() {
+        if (need_comma_) {
+            out_ += ',';
+        }
+    }
+    void AppendEscaped(std::string_view text);
+
+    std::string out_;
+    bool need_comma_ = false;  // a value was written at the current nesting level
+};
+
+// The first `maxUnits` UTF-16 code units of a UTF-8 string, cut on a code point boundary
+// (the web view measures strings in UTF-16, like QString::left).
+std::string_view Utf8PrefixUtf16(std::string_view text, size_t maxUnits);
+
+}  // namespace clan::core
@@ -0,0 +1,154 @@
+#include "core/json/tree_snapshot.h"
+
+#include <bit>
+#include <string_view>
+#include <unordered_map>
+
+#include "core/json/bridge_json.h"
+
+namespace clan::core {
+
+namespace {
+
+// String table. Low-cardinality columns (names, generation names, spouse names, life
+// spans) are deduplicated; ids and paths are unique anyway and skip the lookup. Keys are
+// views, so deduplicated strings must outlive the table.
+class StringTable {
+  public:
+    StringTable() {
+        index_.emplace(std::string_view(), 0);
+        Append(std::string_view());
+    }
+
+    uint32_t Add(std::string_view text) {
+        auto [it, inserted] = index_.try_emplace(text, size());
+        if (inserted) {
+            Append(text);
+        }
+        return it->second;
+    }
+
+    uint32_t AddUnique(std::string_view text) {
+        if (text.empty()) {
+            return 0;
+        }
+        uint32_t id = size();
+        Append(text);
+        return id;
+    }
+
+    uint32_t size() const { return static_cast<uint32_t>(offsets_.size()); }
+    const std::vector<uint32_t>& offsets() const { return offsets_; }
+    const std::string& blob() const { return blob_; }
+
+  private:
+    void Append(std::string_view text) {
+        offsets_.push_back(static_cast<uint32_t>(blob_.size()));
+        blob_ += text;
+    }
+
+    std::unordered_map<std::string_view, uint32_t> index_;
+    std::vector<uint32_t> offsets_;
+    std::string blob_;
+};
+
+void AppendU32(std::string& out, uint32_t value) {
+    unsigned char bytes[4] = {static_cast<unsigned char>(value),
+                              static_cast<unsigned char>(value >> 8),
+                              static_cast<unsigned char>(value >> 16),
+                              static_cast<unsigned char>(value >> 24)};
+    out.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+// Whole column at once: a plain copy on little-endian hosts
+void AppendU32s(std::string& out, const uint32_t* values, size_t count) {
+    if constexpr (std::endian::native == std::endian::little) {
+        out.append(reinterpret_cast<const char*>(values), count * sizeof(uint32_t));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            AppendU32(out, values[i]);
+        }
+    }
+}
+
+void Pad4(std::string& out) {
+    out.append((4 - out.size() % 4) % 4, '\0');
+}
+
+// Father positions from father_id, for callers without the kinship index
+std::vector<int32_t> FatherPositions(const std::vector<Member>& members) {
+    std::unordered_map<std::string_view, int32_t> indexOf;
+    indexOf.reserve(members.size());
+    for (size_t i = 0; i < members.size(); ++i) {
+        indexOf.emplace(members[i].id, static_cast<int32_t>(i));
+    }
+    std::vector<int32_t> fathers(members.size(), -1);
+    for (size_t i = 0; i < members.size(); ++i) {
+        auto it = indexOf.find(members[i].father_id);
+        if (it != indexOf.end()) {
+            fathers[i] = it->second;
+        }
+    }
+    return fathers;
+}
+
+}  // namespace
+
+std::string EncodeTreeSnapshot(const std::vector<Member>& members,
+                               const std::vector<int32_t>& fatherIndex, uint64_t revision,
+                               const AvatarUrlFn& avatarUrl) {
+    const auto count = static_cast<uint32_t>(members.size());
+    std::vector<int32_t> derived;
+    if (fatherIndex.size() != members.size()) {
+        derived = FatherPositions(members);
+    }
+    const std::vector<int32_t>& fathers = derived.empty() ? fatherIndex : derived;
+
+    std::vector<std::string> lifeSpans(members.size());  // keeps the table's keys alive
+    StringTable strings;
+    // Column-major, so each column is one contiguous Uint32Array on the web side
+    std::vector<uint32_t> columns(static_cast<size_t>(count) * kTreeSnapshotStringColumns);
+    auto column = [&](int c) { return &columns[static_cast<size_t>(c) * count]; };
+    for (uint32_t i = 0; i < count; ++i) {
+        const Member& m = members[i];
+        lifeSpans[i] = LifeSpan(m);
+        column(0)[i] = strings.AddUnique(m.id);
+        column(1)[i] = strings.Add(m.name);
+        column(2)[i] = strings.Add(m.generation_name);
+        column(3)[i] = strings.Add(m.spouse_name);
+        column(4)[i] = strings.AddUnique(m.portrait_path);
+        column(5)[i] = strings.Add(lifeSpans[i]);
+        column(6)[i] =
+            avatarUrl && !m.portrait_path.empty() ? strings.AddUnique(avatarUrl(m)) : 0;
+    }
+
+    std::string out;
+    out.reserve(24 + static_cast<size_t>(count) * (9 + 4 * kTreeSnapshotStringColumns) +
+                4 * (strings.size() + 1) + strings.blob().size() + 4);
+
+    AppendU32(out, kTreeSnapshotMagic);
+    AppendU32(out, kTreeSnapshotVersion);
+    AppendU32(out, count);
+    AppendU32(out, strings.size());
+    AppendU32(out, static_cast<uint32_t>(revision));
+    AppendU32(out, static_cast<uint32_t>(revision >> 32));
+
+    AppendU32s(out, reinterpret_cast<const uint32_t*>(fathers.data()), count);
+    std::vector<uint32_t> scratch(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        scratch[i] = static_cast<uint32_t>(members[i].generation);
+    }
+    AppendU32s(out, scratch.data(), count);
+    for (const Member& m : members) {
+        out += static_cast<char>(m.gender == "M" ? 1 : m.gender == "F" ? 2 : 0);
+    }
+    Pad4(out);
+    AppendU32s(out, columns.data(), columns.size());
+
+    AppendU32s(out, strings.offsets().data(), strings.size());
+    AppendU32(out, static_cast<uint32_t>(strings.blob().size()));
+    out += strings.blob();
+    return out;
+}
+
+}  // namespace clan::core
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/db/models.h"
+
+namespace clan::core {
+
+// Binary, columnar form of the fetchFamilyTree payload for very large trees: the same
+// fields, a fraction of the bytes, and no JSON.parse on the web side (decoder in
+// web/src/hooks/useClanBridge.ts). All integers are little-endian; every section starts
+// on a 4-byte boundary so the decoder can view it as a typed array in place.
+//
+//   header   u32 magic "CTS1", u32 version, u32 count, u32 strings,
+//            u32 revision low, u32 revision high
+//   parent   i32[count]    index of the father in this snapshot, -1 if none/unresolved
+//   gen      i32[count]    generation
+//   gender   u8[count]     0 unknown, 1 "M", 2 "F"; padded to 4 bytes
+//   columns  u32[count] x kTreeSnapshotStringColumns, string table indices in the order
+//            id, name, generationName, spouseName, portraitPath, lifeSpan, avatarUrl
+//   offsets  u32[strings + 1]  byte offsets into the blob
+//   blob     UTF-8 bytes of the deduplicated string table; string 0 is ""
+inline constexpr uint32_t kTreeSnapshotMagic = 0x31535443;  // "CTS1"
+inline constexpr uint32_t kTreeSnapshotVersion = 1;
+inline constexpr int kTreeSnapshotStringColumns = 7;
+
+using AvatarUrlFn = std::function<std::string(const Member&)>;
+
+// fatherIndex holds each member's father as a position in `members` (-1 for none), as
+// produced by DatabaseManager::GetTreeMembers; when empty it is derived from father_id.
+std::string EncodeTreeSnapshot(const std::vector<Member>& members,
+                               const std::vector<int32_t>& fatherIndex, uint64_t revision,
+                               const AvatarUrlFn& avatarUrl = {});
+
+}  // namespace clan::core
@@ -1,6 +1,7 @@
 // log.cpp
 #include "log.h"
 
+#include <algorithm>
 #include <filesystem>
 
 #include "spdlog/spdlog.h"
@@ -12,12 +13,7 @@ Log& Log::instance() {
     return inst;
 }
 
-void Log::init(const LogConfig& config_in) {
-    LogConfig config = config_in;
-#ifdef NDEBUG
-    config.console = true;
-#endif
-
+void Log::init(const LogConfig& config) {
     namespace fs = std::filesystem;
     fs::create_directories(config.log_dir);
 
@@ -43,16 +39,21 @@ void Log::init(const LogConfig& config_in) {
         rotating_sink->set_level(config.level);
         sinks.push_back(rotating_sink);
     }
+    ring_ = config.ring_capacity > 0 ? std::make_shared<LogRing>(config.ring_capacity) : nullptr;
+    if (ring_) {
+        auto ring_sink = std::make_shared<LogRingSink>(ring_);
+        ring_sink->set_level(config.level);
+        sinks.push_back(ring_sink);
+    }
 
     if (config.use_async) {
-        size_t queue_size = 8192;
-        size_t thread_count = 1;
-        spdlog::init_thread_pool(queue_size, thread_count);
+        spdlog::init_thread_pool(std::max<size_t>(config.async_queue_size, 1),
+                                 std::max<size_t>(config.async_threads, 1));
         logger_ = std::make_shared<spdlog::async_logger>(config.log_name,
                                                          sinks.begin(),
                                                          sinks.end(),
                                                          spdlog::thread_pool(),
-                                                         spdlog::async_overflow_policy::block);
+                                                         config.async_overflow);
         spdlog::flush_every(std::chrono::seconds(3));
 
     } else {
@@ -13,6 +13,8 @@
 #include <memory>
 #include <string>
 
+#include "core/log/log_ring.h"
+
 namespace clan::core {
 
 struct LogConfig {
@@ -30,6 +32,16 @@ struct LogConfig {
 
     int daily_hour = 0;
     int daily_minute = 0;
+
+    // Async pipeline (use_async): queued messages, worker threads, and what a full queue
+    // does to the caller: block until there is room, or overrun_oldest (never blocks,
+    // discards the oldest queued message). tests/bench_log.cc measures the combinations.
+    size_t async_queue_size = 8192;
+    size_t async_threads = 1;
+    spdlog::async_overflow_policy async_overflow = spdlog::async_overflow_policy::block;
+
+    // Lines kept for the in-app LogViewer (see LogRing); 0 disables the ring sink
+    size_t ring_capacity = 4096;
 };
 
 class Log {
@@ -41,6 +53,8 @@ public:
     void set_level(spdlog::level::level_enum level);
     void flush();
     std::shared_ptr<spdlog::logger> logger() const { return logger_; }
+    // Ring the LogViewer drains; null before init or when ring_capacity is 0
+    std::shared_ptr<LogRing> ring() const { return ring_; }
 
 private:
     Log() = default;
@@ -49,6 +63,7 @@ private:
     Log& operator=(const Log&) = delete;
 
     std::shared_ptr<spdlog::logger> logger_;
+    std::shared_ptr<LogRing> ring_;
 };
 
 }  // namespace clan::core
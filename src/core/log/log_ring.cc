@@ -0,0 +1,76 @@
+#include "core/log/log_ring.h"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+namespace clan::core {
+
+namespace {
+
+size_t RingSize(size_t capacity) {
+    return std::bit_ceil(capacity < 2 ? size_t{2} : capacity);
+}
+
+}  // namespace
+
+LogRing::LogRing(size_t capacity)
+    : slots_(std::make_unique<Slot[]>(RingSize(capacity))),
+      mask_(RingSize(capacity) - 1) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRing::~LogRing() = default;
+
+bool LogRing::Push(int64_t timeMs, size_t threadId, spdlog::level::level_enum level,
+                   std::string_view text) {
+    uint64_t pos = write_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == pos) {
+            if (write_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (seq < pos) {
+            // Still holds the line from one lap ago: the viewer has not drained it yet
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = write_.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogLine& line = slot->line;
+    line.time_ms = timeMs;
+    line.thread_id = threadId;
+    line.level = level;
+    line.truncated = text.size() > LogLine::kMaxText;
+    size_t length = text.size();
+    if (line.truncated) {
+        length = LogLine::kMaxText;
+        while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+            --length;  // do not split a UTF-8 sequence
+        }
+    }
+    std::memcpy(line.text, text.data(), length);
+    line.length = static_cast<uint16_t>(length);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void LogRingSink::log(const spdlog::details::log_msg& msg) {
+    if (!should_log(msg.level)) {
+        return;
+    }
+    auto timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      msg.time.time_since_epoch())
+                      .count();
+    ring_->Push(timeMs, msg.thread_id, msg.level,
+                std::string_view(msg.payload.data(), msg.payload.size()));
+}
+
+}  // namespace clan::core
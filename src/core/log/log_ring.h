@@ -0,0 +1,99 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace clan::core {
+
+// One log line as the ring stores it: the message text without the pattern (the viewer
+// formats time and level itself), cut at kMaxText bytes on a UTF-8 boundary.
+struct LogLine {
+    static constexpr size_t kMaxText = 480;
+
+    int64_t time_ms = 0;  // system clock, ms since the epoch
+    size_t thread_id = 0;
+    spdlog::level::level_enum level = spdlog::level::info;
+    bool truncated = false;
+    uint16_t length = 0;
+    char text[kMaxText];
+
+    std::string_view view() const { return {text, length}; }
+};
+
+// Fixed-size lock-free ring of log lines for the in-app log viewer.
+//
+// Any number of threads Push; one thread (the viewer) Drains. Slots are preallocated and
+// sequenced per slot (Vyukov's bounded queue), so a push is one CAS and a copy into the
+// slot, with no allocation and no lock. When the viewer falls behind and the ring is
+// full, new lines are dropped and counted rather than blocking the logging thread; the
+// file sinks still have them.
+class LogRing {
+  public:
+    // `capacity` is rounded up to a power of two (at least 2)
+    explicit LogRing(size_t capacity);
+    ~LogRing();
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // False when the ring is full (the line is counted in dropped())
+    bool Push(int64_t timeMs, size_t threadId, spdlog::level::level_enum level,
+              std::string_view text);
+
+    // Consumer only. Calls fn(const LogLine&) for up to `max` lines in push order and
+    // returns how many it delivered. The line is only valid during the call.
+    template <typename Fn>
+    size_t Drain(Fn&& fn, size_t max = SIZE_MAX) {
+        size_t n = 0;
+        while (n < max) {
+            Slot& slot = slots_[read_ & mask_];
+            if (slot.seq.load(std::memory_order_acquire) != read_ + 1) {
+                break;  // empty, or the producer is still copying
+            }
+            const LogLine& line = slot.line;
+            fn(line);
+            slot.seq.store(read_ + mask_ + 1, std::memory_order_release);
+            ++read_;
+            ++n;
+        }
+        return n;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+        LogLine line;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> write_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    alignas(64) uint64_t read_ = 0;  // consumer only
+};
+
+// spdlog sink in front of a LogRing. Unlike the stock sinks it takes no mutex and does
+// not format: set_pattern/set_formatter are ignored.
+class LogRingSink final : public spdlog::sinks::sink {
+  public:
+    explicit LogRingSink(std::shared_ptr<LogRing> ring)
+        : ring_(std::move(ring)) {}
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+  private:
+    std::shared_ptr<LogRing> ring_;
+};
+
+}  // namespace clan::core
@@ -0,0 +1,320 @@
+#include "core/network/media_server.h"
+
+#include <cctype>
+#include <cstdio>
+#include <random>
+#include <system_error>
+#include <utility>
+
+#include "core/log/log.h"
+#include "core/platform/mapped_file.h"
+#include "cpp-httplib/httplib.h"
+
+namespace fs = std::filesystem;
+
+namespace clan::core {
+
+namespace {
+
+// URL path and query strings are UTF-8; std::string paths would use the ANSI code page
+// on Windows
+fs::path Utf8Path(const std::string& text) {
+    return fs::path(std::u8string(text.begin(), text.end()));
+}
+
+std::string UrlEncode(const std::string& text, bool keepSlashes) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(text.size());
+    for (unsigned char c : text) {
+        bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                          (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' ||
+                          c == '~' || (keepSlashes && c == '/');
+        if (unreserved) {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += kHex[c >> 4];
+            out += kHex[c & 0xF];
+        }
+    }
+    return out;
+}
+
+std::string RandomToken() {
+    std::random_device rd;
+    char token[33];
+    for (int i = 0; i < 4; ++i) {
+        std::snprintf(token + i * 8, 9, "%08x", static_cast<unsigned>(rd()));
+    }
+    return token;
+}
+
+const char* MimeType(const fs::path& path) {
+    std::string ext = path.extension().string();
+    for (char& c : ext) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    static const std::pair<const char*, const char*> kTypes[] = {
+        {".png", "image/png"},   {".jpg", "image/jpeg"},  {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},   {".bmp", "image/bmp"},   {".webp", "image/webp"},
+        {".mp4", "video/mp4"},   {".webm", "video/webm"}, {".mov", "video/quicktime"},
+        {".mkv", "video/x-matroska"}, {".avi", "video/x-msvideo"},
+        {".mp3", "audio/mpeg"},  {".wav", "audio/wav"},   {".aac", "audio/aac"},
+        {".m4a", "audio/mp4"},   {".flac", "audio/flac"},
+    };
+    for (const auto& [suffix, type] : kTypes) {
+        if (ext == suffix) {
+            return type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+// Validator for a file version: size and modification time
+std::string FileETag(const fs::path& path, const std::string& suffix = {}) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) {
+        return {};
+    }
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+        return {};
+    }
+    char tag[64];
+    std::snprintf(tag, sizeof(tag), "\"%llx-%llx%s\"", static_cast<unsigned long long>(size),
+                  static_cast<unsigned long long>(mtime.time_since_epoch().count()),
+                  suffix.c_str());
+    return tag;
+}
+
+// 304 if the client already holds this version
+bool NotModified(const httplib::Request& req, httplib::Response& res, const std::string& etag) {
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "no-cache");  // revalidate; a 304 costs one stat
+    if (req.get_header_value("If-None-Match") == etag) {
+        res.status = 304;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+MediaServer& MediaServer::instance() {
+    static MediaServer instance;
+    return instance;
+}
+
+MediaServer::MediaServer() = default;
+
+MediaServer::~MediaServer() {
+    Stop();
+}
+
+bool MediaServer::Start(const fs::path& mediaRoot, ThumbnailCache::Encoder encoder) {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (server_) {
+        return true;
+    }
+
+    std::error_code ec;
+    root_ = fs::weakly_canonical(mediaRoot, ec);
+    if (ec) {
+        root_ = mediaRoot;
+    }
+    encoder_ = std::move(encoder);
+
+    auto server = std::make_unique<httplib::Server>();
+    std::string token = RandomToken();
+    server->Get("/" + token + "/file/(.+)",
+                [this](const httplib::Request& req, httplib::Response& res) {
+                    ServeMedia(req, res);
+                });
+    server->Get("/" + token + "/thumb/([0-9]{1,4})",
+                [this](const httplib::Request& req, httplib::Response& res) {
+                    ServeThumbnail(req, res);
+                });
+    server->Get("/" + token + "/blob/([A-Za-z0-9_-]+)",
+                [this](const httplib::Request& req, httplib::Response& res) {
+                    ServeBlob(req, res);
+                });
+
+    int port = server->bind_to_any_port("127.0.0.1");
+    if (port < 0) {
+        LOGERROR("[MediaServer] Cannot bind a loopback port");
+        return false;
+    }
+
+    server_ = std::move(server);
+    port_ = port;
+    base_url_ = "http://127.0.0.1:" + std::to_string(port) + "/" + token;
+    thread_ = std::thread([server = server_.get()] { server->listen_after_bind(); });
+    server_->wait_until_ready();  // a stop() issued before listening would be lost
+    LOGINFO("[MediaServer] Serving {} on 127.0.0.1:{}", root_.string(), port);
+    return true;
+}
+
+void MediaServer::Stop() {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    std::unique_ptr<httplib::Server> server;
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!server_) {
+            return;
+        }
+        server = std::move(server_);
+        thread = std::move(thread_);
+        blobs_.clear();
+        base_url_.clear();
+        port_ = -1;
+    }
+    // Without mutex_: stop() waits for in-flight handlers, and ServeBlob takes mutex_
+    server->stop();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool MediaServer::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return server_ != nullptr;
+}
+
+int MediaServer::port() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return port_;
+}
+
+std::string MediaServer::MediaUrl(const std::string& relativePath) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_url_.empty()) {
+        return {};
+    }
+    return base_url_ + "/file/" + UrlEncode(relativePath, /*keepSlashes=*/true);
+}
+
+std::string MediaServer::ThumbnailUrl(const std::string& sourcePath, int width) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_url_.empty()) {
+        return {};
+    }
+    return base_url_ + "/thumb/" + std::to_string(ThumbnailCache::SizeTier(width)) +
+           "?path=" + UrlEncode(sourcePath, /*keepSlashes=*/false);
+}
+
+std::string MediaServer::PublishBlob(const std::string& name, uint64_t version, Blob bytes,
+                                     const std::string& contentType) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_url_.empty() || !bytes) {
+        return {};
+    }
+    blobs_[name] = {version, std::move(bytes), contentType};
+    return base_url_ + "/blob/" + UrlEncode(name, /*keepSlashes=*/false) +
+           "?v=" + std::to_string(version);
+}
+
+// Relative paths are taken from the media root; ".." cannot climb out of it.
+fs::path MediaServer::Resolve(const std::string& path) const {
+    fs::path requested = Utf8Path(path);
+    if (requested.is_absolute()) {
+        return requested;
+    }
+    std::error_code ec;
+    fs::path full = fs::weakly_canonical(root_ / requested, ec);
+    if (ec) {
+        return {};
+    }
+    fs::path inside = full.lexically_relative(root_);
+    if (inside.empty() || *inside.begin() == "..") {
+        return {};
+    }
+    return full;
+}
+
+void MediaServer::ServeMedia(const httplib::Request& req, httplib::Response& res) {
+    if (Utf8Path(req.matches[1].str()).is_absolute()) {
+        res.status = 403;  // media URLs only address files under the root
+        return;
+    }
+    fs::path file = Resolve(req.matches[1].str());
+    std::string etag = file.empty() ? std::string() : FileETag(file);
+    if (etag.empty()) {
+        res.status = 404;
+        return;
+    }
+    if (NotModified(req, res, etag)) {
+        return;
+    }
+
+    auto mapped = MappedFile::Open(file);
+    if (!mapped) {
+        res.status = 404;
+        return;
+    }
+    res.set_header("Accept-Ranges", "bytes");
+    if (mapped->size() == 0) {
+        res.set_content("", MimeType(file));
+        return;
+    }
+    // httplib slices the provider for Range requests (206 + Content-Range)
+    res.set_content_provider(
+        mapped->size(), MimeType(file),
+        [mapped](size_t offset, size_t length, httplib::DataSink& sink) {
+            return sink.write(mapped->data() + offset, length);
+        });
+}
+
+void MediaServer::ServeThumbnail(const httplib::Request& req, httplib::Response& res) {
+    int width = std::stoi(req.matches[1].str());
+    fs::path source = Resolve(req.get_param_value("path"));
+    std::string etag =
+        source.empty() ? std::string() : FileETag(source, "-" + req.matches[1].str());
+    if (etag.empty()) {
+        res.status = 404;
+        return;
+    }
+    if (NotModified(req, res, etag)) {
+        return;
+    }
+
+    auto bytes = ThumbnailCache::instance().Get(source, width, encoder_);
+    if (!bytes) {
+        res.status = 404;
+        return;
+    }
+    // Served from the cached buffer itself; the provider keeps it alive
+    res.set_content_provider(bytes->size(), "image/png",
+                             [bytes](size_t offset, size_t length, httplib::DataSink& sink) {
+                                 return sink.write(bytes->data() + offset, length);
+                             });
+}
+
+void MediaServer::ServeBlob(const httplib::Request& req, httplib::Response& res) {
+    PublishedBlob blob;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blobs_.find(req.matches[1].str());
+        if (it == blobs_.end()) {
+            res.status = 404;
+            return;
+        }
+        blob = it->second;
+    }
+    // Blobs are read with fetch(), which is subject to CORS (img/video tags are not); the
+    // token in the path is what keeps other origins out
+    res.set_header("Access-Control-Allow-Origin", "*");
+    if (NotModified(req, res, "\"" + std::to_string(blob.version) + "\"")) {
+        return;
+    }
+    Blob bytes = blob.bytes;
+    res.set_content_provider(bytes->size(), blob.content_type,
+                             [bytes](size_t offset, size_t length, httplib::DataSink& sink) {
+                                 return sink.write(bytes->data() + offset, length);
+                             });
+}
+
+}  // namespace clan::core
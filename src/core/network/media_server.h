@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "core/cache/thumbnail_cache.h"
+
+namespace httplib {
+class Server;
+struct Request;
+struct Response;
+}  // namespace httplib
+
+namespace clan::core {
+
+// Loopback HTTP endpoint that lets the web view load media and thumbnails by URL instead
+// of receiving them as base64 inside executeJavascript calls:
+//   /<token>/file/<path>              file under the media root; Range requests supported
+//   /<token>/thumb/<width>?path=<p>   ThumbnailCache entry for an image (p may be absolute)
+//   /<token>/blob/<name>              in-memory payload published by the app
+// Responses carry an ETag and answer If-None-Match with 304. Files are memory-mapped and
+// written to the socket straight from the mapping. The random token in every URL keeps
+// other local processes and pages from probing the user's files.
+class MediaServer {
+  public:
+    static MediaServer& instance();
+
+    // Binds 127.0.0.1 on a free port and serves from a background thread. The encoder
+    // builds thumbnails on cache misses (it runs on the server's worker threads).
+    bool Start(const std::filesystem::path& mediaRoot, ThumbnailCache::Encoder encoder);
+    void Stop();
+
+    bool running() const;
+    int port() const;
+
+    // URLs for the web view; empty while the server is not running.
+    std::string MediaUrl(const std::string& relativePath) const;
+    std::string ThumbnailUrl(const std::string& sourcePath, int width) const;
+
+    // Serves `bytes` under `name` until replaced, e.g. the binary tree snapshot. The
+    // version is the ETag and part of the returned URL; empty while not running.
+    using Blob = std::shared_ptr<const std::string>;
+    std::string PublishBlob(const std::string& name, uint64_t version, Blob bytes,
+                            const std::string& contentType = "application/octet-stream");
+
+  private:
+    MediaServer();
+    ~MediaServer();
+    MediaServer(const MediaServer&) = delete;
+    MediaServer& operator=(const MediaServer&) = delete;
+
+    void ServeMedia(const httplib::Request& req, httplib::Response& res);
+    void ServeThumbnail(const httplib::Request& req, httplib::Response& res);
+    void ServeBlob(const httplib::Request& req, httplib::Response& res);
+    std::filesystem::path Resolve(const std::string& path) const;
+
+    std::mutex lifecycle_mutex_;  // serializes Start/Stop; handlers never take it
+    mutable std::mutex mutex_;    // guards server_, thread_ and the fields the URL builders
+                                  // and ServeBlob read
+    std::unique_ptr<httplib::Server> server_;
+    std::thread thread_;
+    std::filesystem::path root_;
+    ThumbnailCache::Encoder encoder_;
+    std::string base_url_;  // http://127.0.0.1:<port>/<token>
+    int port_ = -1;
+
+    struct PublishedBlob {
+        uint64_t version = 0;
+        Blob bytes;
+        std::string content_type;
+    };
+    std::unordered_map<std::string, PublishedBlob> blobs_;  // guarded by mutex_
+};
+
+}  // namespace clan::core
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace clan::core {
+
+// Read-only memory mapping of a whole file. Pages are faulted in from the page cache on
+// access, so serving a byte range never copies the file through a read buffer.
+class MappedFile {
+  public:
+    // nullptr if the file cannot be opened or mapped. An empty file maps to size() == 0.
+    static std::shared_ptr<const MappedFile> Open(const std::filesystem::path& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    MappedFile() = default;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;     // HANDLE
+    void* mapping_ = nullptr;  // HANDLE
+#endif
+};
+
+}  // namespace clan::core
@@ -0,0 +1,208 @@
+#include "core/resource/content_hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "core/platform/mapped_file.h"
+
+namespace clan::core {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+// Buffered fallback and file comparison read this much at a time
+constexpr size_t kReadChunk = 1 << 20;
+
+// Little-endian loads (a single unaligned load on little-endian hosts)
+template <typename T>
+T ReadLE(const unsigned char* p) {
+    T v = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&v, p, sizeof(v));
+    } else {
+        for (size_t i = sizeof(T); i-- > 0;) {
+            v = static_cast<T>(v << 8) | p[i];
+        }
+    }
+    return v;
+}
+
+uint64_t Read64(const unsigned char* p) {
+    return ReadLE<uint64_t>(p);
+}
+
+uint32_t Read32(const unsigned char* p) {
+    return ReadLE<uint32_t>(p);
+}
+
+uint64_t Round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+uint64_t MergeRound(uint64_t acc, uint64_t value) {
+    acc ^= Round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+// Consumes whole 32-byte stripes; returns the number of bytes used.
+size_t ConsumeStripes(uint64_t (&acc)[4], const unsigned char* p, size_t size) {
+    const unsigned char* const begin = p;
+    const unsigned char* const limit = p + (size & ~size_t{31});
+    uint64_t v1 = acc[0], v2 = acc[1], v3 = acc[2], v4 = acc[3];
+    for (; p < limit; p += 32) {
+        v1 = Round(v1, Read64(p));
+        v2 = Round(v2, Read64(p + 8));
+        v3 = Round(v3, Read64(p + 16));
+        v4 = Round(v4, Read64(p + 24));
+    }
+    acc[0] = v1, acc[1] = v2, acc[2] = v3, acc[3] = v4;
+    return static_cast<size_t>(p - begin);
+}
+
+// Whole-file read without a mapping, for files the platform refuses to map
+std::optional<uint64_t> HashStream(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+    Xxh64 hash;
+    std::vector<char> chunk(kReadChunk);
+    while (in) {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        hash.Update(chunk.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        return std::nullopt;
+    }
+    return hash.Digest();
+}
+
+}  // namespace
+
+Xxh64::Xxh64(uint64_t seed)
+    : acc_{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1},
+      seed_(seed) {
+}
+
+void Xxh64::Update(const void* data, size_t size) {
+    auto p = static_cast<const unsigned char*>(data);
+    total_ += size;
+
+    if (buffered_ > 0) {
+        size_t fill = std::min(size, sizeof(buffer_) - buffered_);
+        std::memcpy(buffer_ + buffered_, p, fill);
+        buffered_ += fill;
+        p += fill;
+        size -= fill;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        ConsumeStripes(acc_, buffer_, sizeof(buffer_));
+        buffered_ = 0;
+    }
+
+    size_t used = ConsumeStripes(acc_, p, size);
+    std::memcpy(buffer_, p + used, size - used);
+    buffered_ = size - used;
+}
+
+uint64_t Xxh64::Digest() const {
+    uint64_t h;
+    if (total_ >= 32) {
+        h = std::rotl(acc_[0], 1) + std::rotl(acc_[1], 7) + std::rotl(acc_[2], 12) +
+            std::rotl(acc_[3], 18);
+        for (uint64_t v : acc_) {
+            h = MergeRound(h, v);
+        }
+    } else {
+        h = seed_ + kPrime5;
+    }
+    h += total_;
+
+    const unsigned char* p = buffer_;
+    const unsigned char* const end = buffer_ + buffered_;
+    for (; p + 8 <= end; p += 8) {
+        h ^= Round(0, Read64(p));
+        h = std::rotl(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+        h = std::rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= *p * kPrime5;
+        h = std::rotl(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t Xxh64Hash(const void* data, size_t size, uint64_t seed) {
+    Xxh64 hash(seed);
+    hash.Update(data, size);
+    return hash.Digest();
+}
+
+std::optional<uint64_t> HashFile(const std::filesystem::path& path) {
+    if (auto mapped = MappedFile::Open(path)) {
+        return Xxh64Hash(mapped->data(), mapped->size());
+    }
+    return HashStream(path);
+}
+
+std::string ContentHashHex(uint64_t hash) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[i] = kDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return hex;
+}
+
+bool SameFileContents(const std::filesystem::path& a, const std::filesystem::path& b) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(a, ec);
+    if (ec || std::filesystem::file_size(b, ec) != size || ec) {
+        return false;
+    }
+    auto mappedA = MappedFile::Open(a);
+    auto mappedB = MappedFile::Open(b);
+    if (mappedA && mappedB) {
+        return mappedA->size() == mappedB->size() &&
+               std::memcmp(mappedA->data(), mappedB->data(), mappedA->size()) == 0;
+    }
+
+    std::ifstream inA(a, std::ios::binary), inB(b, std::ios::binary);
+    if (!inA || !inB) {
+        return false;
+    }
+    std::vector<char> chunkA(kReadChunk), chunkB(kReadChunk);
+    while (inA && inB) {
+        inA.read(chunkA.data(), static_cast<std::streamsize>(chunkA.size()));
+        inB.read(chunkB.data(), static_cast<std::streamsize>(chunkB.size()));
+        if (inA.gcount() != inB.gcount() ||
+            std::memcmp(chunkA.data(), chunkB.data(), static_cast<size_t>(inA.gcount())) != 0) {
+            return false;
+        }
+    }
+    return inA.eof() && inB.eof();
+}
+
+}  // namespace clan::core
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace clan::core {
+
+// Streaming XXH64 (xxHash, 64-bit variant). Not cryptographic: it names media files by
+// content, and a name match is confirmed byte for byte before a file is treated as a
+// duplicate. Output matches the reference implementation for every split of the input.
+class Xxh64 {
+  public:
+    explicit Xxh64(uint64_t seed = 0);
+
+    void Update(const void* data, size_t size);
+    // Hash of everything passed to Update so far; Update may continue afterwards.
+    uint64_t Digest() const;
+
+  private:
+    uint64_t acc_[4];
+    uint64_t seed_;
+    uint64_t total_ = 0;
+    unsigned char buffer_[32];  // partial stripe
+    size_t buffered_ = 0;
+};
+
+uint64_t Xxh64Hash(const void* data, size_t size, uint64_t seed = 0);
+
+// Hash of a whole file, read through a memory mapping (large buffered reads when the file
+// cannot be mapped); nullopt if it cannot be read.
+std::optional<uint64_t> HashFile(const std::filesystem::path& path);
+
+// 16 lowercase hex digits
+std::string ContentHashHex(uint64_t hash);
+
+// Whether two files have identical contents.
+bool SameFileContents(const std::filesystem::path& a, const std::filesystem::path& b);
+
+}  // namespace clan::core
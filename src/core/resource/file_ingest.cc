@@ -0,0 +1,255 @@
+#include "core/resource/file_ingest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "core/platform/mapped_file.h"
+#include "core/resource/content_hash.h"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>  // FICLONE
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+#endif
+
+namespace clan::core {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Each step copies this much and then hashes the same bytes while they are still in the
+// page cache
+constexpr size_t kCopyChunk = 8 << 20;
+
+std::optional<IngestResult> Fail(std::string* error, std::string why) {
+    if (error) {
+        *error = std::move(why);
+    }
+    return std::nullopt;
+}
+
+#ifndef _WIN32
+
+// errno values meaning "this copy method does not apply here", as opposed to a real I/O
+// failure; the next method is tried from the same offset
+bool Unsupported(int err) {
+    return err == ENOSYS || err == EXDEV || err == EINVAL || err == EOPNOTSUPP ||
+           err == ENOTTY;
+}
+
+// Copies `in` to `out` (at its current offset) and hashes data[0, size), the mapping of
+// `in`, chunk by chunk. Prefers the in-kernel copies and steps down to write() when the
+// filesystems refuse them; `method` starts at the best candidate and ends at the last one
+// used.
+bool CopyHashed(int in, int out, const char* data, size_t size, IngestMethod& method,
+                Xxh64& hash, std::string& error) {
+    size_t off = 0;
+    while (off < size) {
+        const size_t chunk = std::min(kCopyChunk, size - off);
+        ssize_t n = -1;
+#ifdef __linux__
+        if (method == IngestMethod::kCopyRange) {
+            loff_t inOff = static_cast<loff_t>(off);
+            n = ::copy_file_range(in, &inOff, out, nullptr, chunk, 0);
+            if (n < 0 && Unsupported(errno)) {
+                method = IngestMethod::kSendfile;
+                continue;
+            }
+        } else if (method == IngestMethod::kSendfile) {
+            off_t inOff = static_cast<off_t>(off);
+            n = ::sendfile(out, in, &inOff, chunk);
+            if (n < 0 && Unsupported(errno)) {
+                method = IngestMethod::kBuffered;
+                continue;
+            }
+        } else
+#endif
+        {
+            method = IngestMethod::kBuffered;
+            n = ::write(out, data + off, chunk);
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = std::string("Copy failed: ") + std::strerror(errno);
+            return false;
+        }
+        if (n == 0) {
+            error = "Source file shrank during import";
+            return false;
+        }
+        hash.Update(data + off, static_cast<size_t>(n));
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+#endif
+
+}  // namespace
+
+const char* IngestMethodName(IngestMethod method) {
+    switch (method) {
+        case IngestMethod::kReflink:
+            return "reflink";
+        case IngestMethod::kHardlink:
+            return "hardlink";
+        case IngestMethod::kCopyRange:
+            return "copy_range";
+        case IngestMethod::kSendfile:
+            return "sendfile";
+        case IngestMethod::kBuffered:
+            return "buffered";
+    }
+    return "unknown";
+}
+
+#ifdef _WIN32
+
+// Hardlink or a buffered copy from the mapping. Block cloning (ReFS) is not attempted.
+std::optional<IngestResult> IngestFile(const fs::path& source, const fs::path& dest,
+                                       const IngestOptions& options, std::string* error) {
+    auto mapped = MappedFile::Open(source);
+    if (!mapped) {
+        return Fail(error, "Cannot read file");
+    }
+    if (fs::exists(dest)) {
+        return Fail(error, "Destination already exists");
+    }
+    IngestResult result;
+    result.bytes = mapped->size();
+
+    std::error_code ec;
+    if (options.allow_hardlink) {
+        fs::create_hard_link(source, dest, ec);
+        if (!ec) {
+            result.method = IngestMethod::kHardlink;
+            result.hash = Xxh64Hash(mapped->data(), mapped->size());
+            return result;
+        }
+    }
+
+    Xxh64 hash;
+    {
+        std::ofstream out(dest, std::ios::binary);
+        for (size_t off = 0; out && off < mapped->size(); off += kCopyChunk) {
+            const size_t chunk = std::min(kCopyChunk, mapped->size() - off);
+            out.write(mapped->data() + off, static_cast<std::streamsize>(chunk));
+            hash.Update(mapped->data() + off, chunk);
+        }
+        out.close();
+        if (!out) {
+            fs::remove(dest, ec);
+            return Fail(error, "Copy failed: cannot write " + dest.string());
+        }
+    }
+    result.method = IngestMethod::kBuffered;
+    result.hash = hash.Digest();
+    return result;
+}
+
+#else
+
+std::optional<IngestResult> IngestFile(const fs::path& source, const fs::path& dest,
+                                       const IngestOptions& options, std::string* error) {
+    auto mapped = MappedFile::Open(source);
+    if (!mapped) {
+        return Fail(error, "Cannot read file");
+    }
+    IngestResult result;
+    result.bytes = mapped->size();
+    // Clones and links share the source's blocks: hashing the mapping is the only read
+    auto linked = [&](IngestMethod method) {
+        result.method = method;
+        result.hash = Xxh64Hash(mapped->data(), mapped->size());
+        return result;
+    };
+
+#ifdef __APPLE__
+    if (::clonefile(source.c_str(), dest.c_str(), 0) == 0) {
+        return linked(IngestMethod::kReflink);
+    }
+#endif
+
+    int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return Fail(error, std::string("Cannot read file: ") + std::strerror(errno));
+    }
+    int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (out < 0) {
+        int err = errno;
+        ::close(in);
+        return Fail(error, "Cannot create " + dest.string() + ": " + std::strerror(err));
+    }
+    // Only for failures after this call created `dest`
+    auto abandon = [&](std::string why) {
+        ::close(out);
+        ::close(in);
+        ::unlink(dest.c_str());
+        return Fail(error, std::move(why));
+    };
+
+#ifdef __linux__
+    if (mapped->size() > 0 && ::ioctl(out, FICLONE, in) == 0) {
+        ::close(in);
+        if (::close(out) != 0) {
+            int err = errno;
+            ::unlink(dest.c_str());
+            return Fail(error, std::string("Clone failed: ") + std::strerror(err));
+        }
+        return linked(IngestMethod::kReflink);
+    }
+#endif
+
+    if (options.allow_hardlink) {
+        ::close(out);
+        ::unlink(dest.c_str());
+        if (::link(source.c_str(), dest.c_str()) == 0) {
+            ::close(in);
+            return linked(IngestMethod::kHardlink);
+        }
+        out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (out < 0) {
+            int err = errno;
+            ::close(in);
+            return Fail(error, "Cannot create " + dest.string() + ": " + std::strerror(err));
+        }
+    }
+
+#ifdef __linux__
+    result.method = IngestMethod::kCopyRange;
+#else
+    result.method = IngestMethod::kBuffered;
+#endif
+    Xxh64 hash;
+    std::string why;
+    if (!CopyHashed(in, out, mapped->data(), mapped->size(), result.method, hash, why)) {
+        return abandon(std::move(why));
+    }
+    ::close(in);
+    if (::close(out) != 0) {
+        int err = errno;
+        ::unlink(dest.c_str());
+        return Fail(error, std::string("Copy failed: ") + std::strerror(err));
+    }
+    result.hash = hash.Digest();
+    return result;
+}
+
+#endif
+
+}  // namespace clan::core
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace clan::core {
+
+// How IngestFile produced the destination, cheapest first
+enum class IngestMethod {
+    kReflink,    // copy-on-write clone (FICLONE / clonefile): no data written
+    kHardlink,   // second name for the source file: no data written
+    kCopyRange,  // in-kernel copy (copy_file_range)
+    kSendfile,   // in-kernel copy (sendfile), for kernels without copy_file_range
+    kBuffered,   // write() / ofstream from the mapped source
+};
+
+// Short lowercase name ("reflink", "copy_range", ...) for logs and the operation log
+const char* IngestMethodName(IngestMethod method);
+
+struct IngestOptions {
+    // Hardlinks share the inode with the user's original, so later edits to either file
+    // show up in both. Only worth it for imports that move files into the archive.
+    bool allow_hardlink = false;
+};
+
+struct IngestResult {
+    IngestMethod method = IngestMethod::kBuffered;
+    uint64_t bytes = 0;
+    uint64_t hash = 0;  // XXH64 of the content, as HashFile would return
+};
+
+// Creates `dest`, which must not exist yet, with the contents of `source`, hashing the data
+// on the way so the source is read exactly once. Falls back from reflink to hardlink (when
+// allowed) to an in-kernel copy to a buffered copy; the first two only work within one
+// filesystem. On failure nothing is left at `dest` and `error` (if given) says why.
+std::optional<IngestResult> IngestFile(const std::filesystem::path& source,
+                                       const std::filesystem::path& dest,
+                                       const IngestOptions& options = {},
+                                       std::string* error = nullptr);
+
+}  // namespace clan::core
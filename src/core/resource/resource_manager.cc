@@ -1,48 +1,54 @@
 #include "resource_manager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <chrono>
+#include <memory>
+#include <sstream>
 
 #include "core/platform/path_manager.h"
 #include "core/db/database_manager.h"
 #include "core/log/log.h"
+#include "core/resource/content_hash.h"
+#include "core/task/task_manager.h"
 
 namespace clan::core {
 
 namespace fs = std::filesystem;
 
+namespace {
+// Differently-named candidates tried for one content hash before giving up
+constexpr int kMaxNameAttempts = 16;
+}  // namespace
+
 ResourceManager& ResourceManager::instance() {
     static ResourceManager instance;
     return instance;
 }
 
-ResourceManager::ResourceManager() {
-    auto& paths = PathManager::instance();
-    fs::path mediaDir = paths.resources_dir() / "media";
-    if (!fs::exists(mediaDir)) {
-        fs::create_directories(mediaDir);
-        LOGINFO("[ResourceManager] Created media directory: {}", mediaDir.string());
-    }
+ResourceManager::ResourceManager() = default;
+
+void ResourceManager::SetMediaDir(const fs::path& dir) {
+    std::lock_guard<std::mutex> lock(media_dir_mutex_);
+    media_dir_ = dir;
+}
+
+fs::path ResourceManager::media_dir() const {
+    std::lock_guard<std::mutex> lock(media_dir_mutex_);
+    return media_dir_.empty() ? PathManager::instance().resources_dir() / "media" : media_dir_;
 }
 
 std::string ResourceManager::CalculateFileHash(const std::string& filePath) {
-    fs::path p(filePath);
-    if (!fs::exists(p)) return "";
-
-    try {
-        auto fileSize = fs::file_size(p);
-        // [Modified] Use stem() instead of filename() to avoid double extension
-        // e.g. "video.mp4" -> stem is "video"
-        std::stringstream ss;
-        ss << fileSize << "_" << p.stem().string();
-        return ss.str();
-    } catch (const std::exception& e) {
-        LOGERROR("[ResourceManager] Hash calc failed: {}", e.what());
+    auto hash = HashFile(fs::path(filePath));
+    if (!hash) {
+        LOGERROR("[ResourceManager] Hash calc failed: cannot read {}", filePath);
         return "";
     }
+    return ContentHashHex(*hash);
 }
 
 std::string ResourceManager::GetExtension(const std::string& path) {
@@ -51,49 +57,267 @@ std::string ResourceManager::GetExtension(const std::string& path) {
 
 MediaResource ResourceManager::ImportFile(const std::string& originalPath,
                                           const std::string& memberId,
-                                          const std::string& type) {
+                                          const std::string& type,
+                                          MediaIngest* ingest) {
     MediaResource res;
+    res.id = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    res.member_id = memberId;
+    res.resource_type = type;
+
+    std::string error = StoreFile(originalPath, res, IngestOptions{}, ingest);
+    if (!error.empty()) {
+        LOGERROR("[ResourceManager] Import of {} failed: {}", originalPath, error);
+        return {};
+    }
+
+    // 4. Save to Database
+    DatabaseManager::instance().AddMediaResource(res);
+
+    return res;
+}
+
+std::string ResourceManager::StoreFile(const std::string& originalPath, MediaResource& res,
+                                       const IngestOptions& options, MediaIngest* ingest) {
+    auto start = std::chrono::steady_clock::now();
     fs::path srcPath(originalPath);
 
     if (!fs::exists(srcPath)) {
-        LOGERROR("[ResourceManager] Source file not found: {}", originalPath);
-        return res;
+        return "Source file not found";
+    }
+
+    // 1. Copy to a temp name in the media directory, hashing in the same pass. Being on
+    // the media filesystem lets IngestFile clone instead of copy, and makes the rename
+    // below atomic, so a crash or a concurrent import of the same file never leaves a
+    // partial file under a final name.
+    fs::path mediaDir = media_dir();
+    std::error_code ec;
+    if (fs::create_directories(mediaDir, ec)) {
+        LOGINFO("[ResourceManager] Created media directory: {}", mediaDir.string());
     }
+    std::string extension = GetExtension(originalPath);
+    fs::path tempPath = mediaDir / (".ingest" + std::to_string(temp_serial_++) + ".part");
+    fs::remove(tempPath, ec);  // left over from an interrupted run
 
-    // 1. Prepare target path
-    std::string hash = CalculateFileHash(originalPath);
-    std::string newFileName = hash + GetExtension(originalPath);
+    std::string error;
+    auto copied = IngestFile(srcPath, tempPath, options, &error);
+    if (!copied) {
+        return error;
+    }
 
-    auto& paths = PathManager::instance();
-    fs::path mediaDir = paths.resources_dir() / "media";
+    // 2. Name by content, so identical files share one copy whatever they were called
+    std::string hash = ContentHashHex(copied->hash);
+    std::string newFileName = hash + extension;
     fs::path destPath = mediaDir / newFileName;
 
-    // 2. Copy file if it doesn't exist
-    if (!fs::exists(destPath)) {
-        try {
-            fs::copy_file(srcPath, destPath);
-            LOGINFO("[ResourceManager] Copied file to: {}", destPath.string());
-        } catch (const std::exception& e) {
-            LOGERROR("[ResourceManager] Copy failed: {}", e.what());
-            return res;
+    // A stored file under the same name is only reused once its bytes are confirmed; a
+    // 64-bit hash collision (or a corrupted copy) gets the next free "-<n>" name instead.
+    for (int attempt = 1; fs::exists(destPath) && !SameFileContents(tempPath, destPath);
+         ++attempt) {
+        if (attempt > kMaxNameAttempts) {
+            fs::remove(tempPath, ec);
+            return "No free file name for hash " + hash;
         }
+        newFileName = hash + "-" + std::to_string(attempt) + extension;
+        destPath = mediaDir / newFileName;
+    }
+
+    bool deduplicated = fs::exists(destPath);
+    if (deduplicated) {
+        fs::remove(tempPath, ec);
+        LOGINFO("[ResourceManager] Identical file already stored: {}", newFileName);
     } else {
-        LOGINFO("[ResourceManager] File already exists: {}", newFileName);
+        fs::rename(tempPath, destPath, ec);
+        if (ec) {
+            std::string why = "Cannot store " + newFileName + ": " + ec.message();
+            fs::remove(tempPath, ec);
+            return why;
+        }
+        LOGINFO("[ResourceManager] Stored {} ({} bytes, {})", destPath.string(), copied->bytes,
+                IngestMethodName(copied->method));
     }
 
     // 3. Construct Resource Object
-    res.id = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
-    res.member_id = memberId;
-    res.resource_type = type;
     res.file_path = "media/" + newFileName;
     res.title = srcPath.stem().string();
     res.file_hash = hash;
-    res.file_size = fs::file_size(srcPath);
+    res.file_size = static_cast<long long>(copied->bytes);
+    if (ingest) {
+        ingest->stored = destPath;
+        ingest->method = copied->method;
+        ingest->bytes = copied->bytes;
+        ingest->deduplicated = deduplicated;
+        ingest->elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    }
+    return {};
+}
 
-    // 4. Save to Database
-    DatabaseManager::instance().AddMediaResource(res);
+namespace {
 
-    return res;
+// Shared by the pipeline lanes and the collecting caller. Lanes may still be queued when
+// the caller returns, so everything they touch lives here rather than on its stack.
+struct ImportPipeline {
+    struct Finished {
+        size_t index = 0;
+        MediaResource res;
+        MediaIngest ingest;
+        std::string error;
+    };
+
+    std::vector<std::string> paths;
+    std::string member_id;
+    std::string type;
+    MediaImportOptions options;
+    int64_t base_id = 0;
+    std::function<std::string(const std::string&, MediaResource&, MediaIngest*)> store;
+
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Finished> finished;  // guarded by mutex
+
+    // Claims and processes the next file; false once every file has been claimed.
+    bool RunOne(Finished& out) {
+        size_t index = next++;
+        if (index >= paths.size()) {
+            return false;
+        }
+        out.index = index;
+        out.res.id = std::to_string(base_id + static_cast<int64_t>(index));
+        out.res.member_id = member_id;
+        out.res.resource_type = type;
+        try {
+            out.error = store(paths[index], out.res, &out.ingest);
+            if (out.error.empty() && options.after_copy) {
+                options.after_copy(out.res, out.ingest.stored);
+            }
+        } catch (const std::exception& e) {
+            out.error = e.what();
+        }
+        return true;
+    }
+
+    void Lane() {
+        Finished item;
+        while (RunOne(item)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(std::move(item));
+            }
+            ready.notify_one();
+            item = {};
+        }
+    }
+};
+
+}  // namespace
+
+MediaImportResult ResourceManager::ImportFiles(const std::vector<std::string>& originalPaths,
+                                               const std::string& memberId,
+                                               const std::string& type,
+                                               const MediaImportProgressFn& onProgress,
+                                               const MediaImportOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    MediaImportResult result;
+    const size_t total = originalPaths.size();
+    if (total == 0) {
+        return result;
+    }
+
+    auto pipeline = std::make_shared<ImportPipeline>();
+    pipeline->paths = originalPaths;
+    pipeline->member_id = memberId;
+    pipeline->type = type;
+    pipeline->options = options;
+    // Ids keep the timestamp form of ImportFile, one tick apart so they stay unique
+    pipeline->base_id = std::chrono::system_clock::now().time_since_epoch().count();
+    IngestOptions ingestOptions;
+    ingestOptions.allow_hardlink = options.allow_hardlink;
+    pipeline->store = [this, ingestOptions](const std::string& path, MediaResource& res,
+                                            MediaIngest* ingest) {
+        return StoreFile(path, res, ingestOptions, ingest);
+    };
+
+    // Hash/copy stage: bounded lanes on the executor
+    size_t lanes = std::clamp<size_t>(options.io_parallelism, 1, total);
+    for (size_t i = 0; i < lanes; ++i) {
+        TaskManager::instance().enqueue([pipeline] { pipeline->Lane(); });
+    }
+
+    // Commit stage: this thread reports progress and writes rows in batches
+    std::vector<ImportPipeline::Finished> imported;
+    std::vector<MediaResource> batch;
+    const size_t batchSize = std::max<size_t>(options.commit_batch, 1);
+    auto commit = [&] {
+        if (batch.empty()) {
+            return;
+        }
+        if (!DatabaseManager::instance().AddMediaResources(batch)) {
+            // Files stay in the media directory; only the rows are missing
+            for (auto it = imported.end() - static_cast<ptrdiff_t>(batch.size());
+                 it != imported.end(); ++it) {
+                result.failed.push_back({originalPaths[it->index], "Database write failed"});
+            }
+            imported.resize(imported.size() - batch.size());
+        }
+        batch.clear();
+    };
+
+    size_t done = 0;
+    std::deque<ImportPipeline::Finished> ready;
+    while (done < total) {
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->ready.wait_for(lock, std::chrono::milliseconds(50),
+                                     [&] { return !pipeline->finished.empty(); });
+            ready.swap(pipeline->finished);
+        }
+        if (ready.empty()) {
+            // The executor is busy (possibly with this very call): process a file here
+            // so the import always makes progress
+            ImportPipeline::Finished item;
+            if (pipeline->RunOne(item)) {
+                ready.push_back(std::move(item));
+            }
+        }
+        for (auto& item : ready) {
+            ++done;
+            bool ok = item.error.empty();
+            if (onProgress) {
+                onProgress({done, total, originalPaths[item.index], ok});
+            }
+            if (ok) {
+                batch.push_back(item.res);
+                imported.push_back(std::move(item));
+                if (batch.size() >= batchSize) {
+                    commit();
+                }
+            } else {
+                LOGERROR("[ResourceManager] Import of {} failed: {}",
+                         originalPaths[item.index], item.error);
+                result.failed.push_back({originalPaths[item.index], std::move(item.error)});
+            }
+        }
+        ready.clear();
+    }
+    commit();
+
+    std::sort(imported.begin(), imported.end(),
+              [](const auto& a, const auto& b) { return a.index < b.index; });
+    result.imported.reserve(imported.size());
+    for (auto& item : imported) {
+        result.bytes += item.ingest.bytes;
+        result.deduplicated += item.ingest.deduplicated ? 1 : 0;
+        ++result.methods[item.ingest.method];
+        result.imported.push_back(std::move(item.res));
+    }
+    result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    LOGINFO("[ResourceManager] Imported {} of {} files ({} bytes, {} lanes) in {} ms",
+            result.imported.size(), total, result.bytes, lanes, result.elapsed_ms);
+    return result;
 }
 
 std::vector<MediaResource> ResourceManager::GetResourcesForMember(const std::string& memberId,
@@ -1,36 +1,117 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 #include <mutex>
 
-// [Added] Forward declaration
+#include "core/db/models.h"
+#include "core/resource/file_ingest.h"
+
 namespace clan::core {
-struct MediaResource;
+
+struct MediaImportOptions {
+    // Files hashed and copied at the same time. A few lanes keep one disk busy; more mostly
+    // add seeking on spinning disks.
+    size_t io_parallelism = 4;
+    // media_resources rows per transaction
+    size_t commit_batch = 64;
+    // Let files be stored as hardlinks to the originals (see IngestOptions)
+    bool allow_hardlink = false;
+    // Optional extra stage after the copy, on a pool thread (e.g. building thumbnails)
+    std::function<void(const MediaResource& res, const std::filesystem::path& stored)>
+        after_copy;
+};
+
+// How one file reached the media directory
+struct MediaIngest {
+    std::filesystem::path stored;  // the file under resources/media
+    IngestMethod method = IngestMethod::kBuffered;
+    uint64_t bytes = 0;
+    bool deduplicated = false;  // identical content was already stored; the copy was dropped
+    int64_t elapsed_ms = 0;     // ingest and naming, without the database write
+};
+
+struct MediaImportProgress {
+    size_t done = 0;  // files finished so far, imported or failed
+    size_t total = 0;
+    std::string file;  // source path of the file that just finished
+    bool ok = false;
+};
+using MediaImportProgressFn = std::function<void(const MediaImportProgress&)>;
+
+struct MediaImportResult {
+    struct Failure {
+        std::string file;
+        std::string error;
+    };
+    std::vector<MediaResource> imported;  // in input order
+    std::vector<Failure> failed;
+    int64_t elapsed_ms = 0;
+    // Ingest totals over the imported files
+    uint64_t bytes = 0;
+    size_t deduplicated = 0;
+    std::map<IngestMethod, size_t> methods;  // files per ingest method
+};
+
 // [Added] Singleton class to manage physical files and DB mapping
 class ResourceManager {
 public:
     static ResourceManager& instance();
 
-    // [Added] Import a file: Copy -> Rename (Hash) -> Write to DB
-    // Returns the created resource object.
+    // [Added] Import a file: Copy + Hash -> Rename -> Write to DB
+    // Returns the created resource object; `ingest` (optional) receives how it was stored.
     MediaResource ImportFile(const std::string& originalPath,
                              const std::string& memberId,
-                             const std::string& type);
+                             const std::string& type,
+                             MediaIngest* ingest = nullptr);
+
+    // Imports many files as a pipeline on the TaskManager executor: up to
+    // options.io_parallelism files are hashed, copied and passed to after_copy at once,
+    // while the calling thread reports progress (one call per file, in completion order)
+    // and writes the rows in batches. Blocks until every file is done; call it off the UI
+    // thread.
+    MediaImportResult ImportFiles(const std::vector<std::string>& originalPaths,
+                                  const std::string& memberId,
+                                  const std::string& type,
+                                  const MediaImportProgressFn& onProgress = {},
+                                  const MediaImportOptions& options = {});
 
     // [Added] Retrieve all resources associated with a member
     std::vector<MediaResource> GetResourcesForMember(const std::string& memberId,
                                                      const std::string& type);
 
-    // [Added] Calculate unique hash for file content (to prevent duplicates)
+    // Content hash of a file (XXH64, 16 hex digits); empty if it cannot be read.
+    // Stored files are named after it under resources/media.
     std::string CalculateFileHash(const std::string& filePath);
 
+    // Directory imported files are stored in: resources/media unless set, created on the
+    // first import. An empty path restores the default. Rows keep "media/<name>" paths
+    // either way, so tests point it at a scratch directory rather than the real storage.
+    void SetMediaDir(const std::filesystem::path& dir);
+    std::filesystem::path media_dir() const;
+
 private:
     ResourceManager();
     ~ResourceManager() = default;
 
+    // Copy into the media directory while hashing (see IngestFile), name the copy by
+    // content and fill `res`, without touching the database. Returns an error message,
+    // empty on success. Safe to call concurrently.
+    std::string StoreFile(const std::string& originalPath, MediaResource& res,
+                          const IngestOptions& options, MediaIngest* ingest = nullptr);
+
     // [Added] Helper to get file extension
     std::string GetExtension(const std::string& path);
+
+    std::atomic<uint64_t> temp_serial_{0};  // unique temp names for concurrent copies
+    mutable std::mutex media_dir_mutex_;
+    std::filesystem::path media_dir_;  // empty: PathManager resources_dir() / "media"
 };
 
 } // namespace clan::core
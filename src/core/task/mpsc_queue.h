@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace clan::core {
+
+// Unbounded lock-free multi-producer / single-consumer queue (Vyukov's node queue).
+//
+// Push is wait-free: one allocation, one atomic exchange and one store. Pop must only be
+// called from one thread at a time. A Push that has swapped the head but not yet linked
+// its node makes Pop report empty until it finishes, so "Pop returned nothing" means
+// "nothing completed yet", not "no producer is mid-push". Values are delivered in the
+// order their Push calls swapped the head, so each producer's values stay in order.
+// T must be default-constructible (the queue keeps one spare node).
+template <typename T>
+class MpscQueue {
+  public:
+    MpscQueue()
+        : head_(new Node()),
+          tail_(head_.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        while (Pop()) {
+        }
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Consumer only.
+    std::optional<T> Pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(next->value));
+        tail_ = next;  // `next` becomes the spare node
+        delete tail;
+        return value;
+    }
+
+  private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node*> head_;  // last pushed node, swapped by producers
+    Node* tail_;               // spare node before the oldest value, consumer only
+};
+
+}  // namespace clan::core
@@ -1,21 +1,162 @@
 #include "LogViewer.h"
 
-#include "core/Logger.h"
+#include <QAbstractListModel>
+#include <QApplication>
+#include <QBrush>
+#include <QClipboard>
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QScrollBar>
+#include <QShortcut>
+#include <QTimer>
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+
+#include "core/log/log.h"
 #include "ui_LogViewer.h"
 
+// Rows of the log view. Lines are stored raw and only formatted in data(), i.e. for the
+// rows the view actually paints.
+class LogLineModel : public QAbstractListModel {
+public:
+    struct Row {
+        qint64 timeMs = 0;
+        spdlog::level::level_enum level = spdlog::level::info;
+        QString text;
+    };
+
+    explicit LogLineModel(QObject* parent)
+        : QAbstractListModel(parent) {}
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) {
+            return {};
+        }
+        const Row& row = m_rows[index.row()];
+        if (role == Qt::DisplayRole) {
+            auto level = spdlog::level::to_short_c_str(row.level);
+            return QString("%1 [%2] %3")
+                .arg(QDateTime::fromMSecsSinceEpoch(row.timeMs).toString("hh:mm:ss.zzz"),
+                     QLatin1String(level), row.text);
+        }
+        if (role == Qt::ForegroundRole) {
+            if (row.level >= spdlog::level::err) {
+                return QBrush(QColor("#e74c3c"));
+            }
+            if (row.level == spdlog::level::warn) {
+                return QBrush(QColor("#e67e22"));
+            }
+            if (row.level <= spdlog::level::debug) {
+                return QBrush(QColor("#888888"));
+            }
+        }
+        return {};
+    }
+
+    // One insert (and at most one removal) per batch, however many rows it holds
+    void append(std::vector<Row>&& batch, int maxRows) {
+        if (batch.empty()) {
+            return;
+        }
+        if (static_cast<int>(batch.size()) > maxRows) {
+            batch.erase(batch.begin(), batch.end() - maxRows);
+        }
+        int overflow = static_cast<int>(m_rows.size() + batch.size()) - maxRows;
+        if (overflow > 0) {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            m_rows.erase(m_rows.begin(), m_rows.begin() + overflow);
+            endRemoveRows();
+        }
+        int first = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(batch.size()) - 1);
+        std::move(batch.begin(), batch.end(), std::back_inserter(m_rows));
+        endInsertRows();
+    }
+
+private:
+    std::deque<Row> m_rows;
+};
+
 LogViewer::LogViewer(QWidget* parent)
     : QWidget(parent),
       ui(new Ui::LogViewer) {
     ui->setupUi(this);
-    connect(&Logger::instance(), &Logger::newMessage, this, &LogViewer::onNewMessage);
+    m_model = new LogLineModel(this);
+    ui->listView->setModel(m_model);
+    ui->listView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto* copy = new QShortcut(QKeySequence::Copy, ui->listView);
+    copy->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(copy, &QShortcut::activated, this, &LogViewer::copySelection);
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kFrameMs);
+    connect(m_timer, &QTimer::timeout, this, &LogViewer::drainLog);
+    m_timer->start();
 }
 
 LogViewer::~LogViewer() {
     delete ui;
 }
 
-void LogViewer::onNewMessage(const QString& message) {
-    ui->plainTextEdit->appendPlainText(message);
+void LogViewer::drainLog() {
+    // Log::init may have replaced the ring; this viewer is its only consumer
+    auto ring = clan::core::Log::instance().ring();
+    if (ring != m_ring) {
+        m_ring = ring;
+        m_dropped = ring ? ring->dropped() : 0;
+    }
+    if (!m_ring) {
+        return;
+    }
+
+    std::vector<LogLineModel::Row> batch;
+    m_ring->Drain(
+        [&batch](const clan::core::LogLine& line) {
+            auto text = line.view();
+            batch.push_back({line.time_ms, line.level,
+                             QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()))});
+            if (line.truncated) {
+                batch.back().text += QStringLiteral("…");
+            }
+        },
+        kMaxLinesPerFrame);
+
+    uint64_t dropped = m_ring->dropped();
+    if (dropped != m_dropped) {
+        batch.push_back({QDateTime::currentMSecsSinceEpoch(), spdlog::level::warn,
+                         tr("%1 log line(s) not shown, see the log file")
+                             .arg(static_cast<qulonglong>(dropped - m_dropped))});
+        m_dropped = dropped;
+    }
+    if (batch.empty()) {
+        return;
+    }
+
+    QScrollBar* bar = ui->listView->verticalScrollBar();
+    bool follow = bar->value() == bar->maximum();
+    m_model->append(std::move(batch), kMaxRows);
+    if (follow) {
+        ui->listView->scrollToBottom();
+    }
+}
+
+void LogViewer::copySelection() {
+    QModelIndexList rows = ui->listView->selectionModel()->selectedRows();
+    std::sort(rows.begin(), rows.end());
+    QStringList lines;
+    for (const QModelIndex& index : rows) {
+        lines << index.data().toString();
+    }
+    if (!lines.isEmpty()) {
+        QApplication::clipboard()->setText(lines.join('\n'));
+    }
 }
 
 void LogViewer::newFunction(int value, const std::string& name) {
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <QWidget>
@@ -6,16 +8,36 @@
 namespace Ui {
 class LogViewer;
 }
+namespace clan::core {
+class LogRing;
+}
+class LogLineModel;
+class QTimer;
 
+// Dock view of the spdlog output. It does not get a signal per line: a timer drains the
+// Log ring (core/log/log_ring.h) a frame at a time, and the list only paints the rows on
+// screen, so a logging burst costs the GUI thread at most one bounded batch per frame.
 class LogViewer : public QWidget {
     Q_OBJECT
 public:
     explicit    LogViewer(QWidget* parent = nullptr);
     ~LogViewer();
+
+    static constexpr int kFrameMs = 33;             // ~30 refreshes per second at most
+    static constexpr size_t kMaxLinesPerFrame = 2000;  // rest waits for the next frame
+    static constexpr int kMaxRows = 20000;          // oldest rows are discarded beyond this
+
 public slots:
-    void onNewMessage(const QString& message);
     void newFunction(int value, const std::string& name);
 
+private slots:
+    void drainLog();
+    void copySelection();
+
 private:
     Ui::LogViewer* ui;
+    LogLineModel* m_model = nullptr;
+    QTimer* m_timer = nullptr;
+    std::shared_ptr<clan::core::LogRing> m_ring;
+    uint64_t m_dropped = 0;
 };
@@ -0,0 +1,321 @@
+// Micro-benchmarks for the data layer (DatabaseManager and friends).
+// Not registered with CTest; run manually, e.g.:
+//   ./bin/db_benchmarks            (seeds 200k members)
+//   ./bin/db_benchmarks 20000      (smaller members table)
+//   ./bin/db_benchmarks 20000 1e5  (and a 100k-row import instead of 1M)
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/db/cjk_tokenizer.h"
+#include "core/db/database_manager.h"
+#include "core/db/member_import.h"
+#include "core/db/member_columns.h"
+#include "core/log/log.h"
+#include "core/task/task_manager.h"
+
+using namespace clan::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kLookups = 100000;
+
+// Runs fn `iterations` times and prints the mean latency per call.
+void TimeIt(const std::string& name, int iterations, const std::function<void(int)>& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << "  " << name << ": " << (ns / iterations) << " ns/call (" << iterations
+              << " calls, " << ns / 1000000 << " ms)" << std::endl;
+}
+
+// UTF-8 for the k-th CJK unified ideograph (U+4E00 + k)
+std::string Han(int k) {
+    char32_t cp = 0x4E00 + k;
+    return {static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+            static_cast<char>(0x80 | (cp & 0x3F))};
+}
+
+// Bulk-seeds `count` members with realistic field sizes in one transaction.
+void SeedMembers(const std::string& dbPath, int count) {
+    SQLite::Database db(dbPath, SQLite::OPEN_READWRITE);
+    RegisterCjkTokenizer(db.getHandle());  // the members_fts triggers tokenize every insert
+    SQLite::Transaction tx(db);
+    db.exec("DELETE FROM members");
+    SQLite::Statement insert(db, R"(
+        INSERT INTO members (id, name, gender, generation, generation_name, father_id,
+            spouse_name, birth_date, death_date, birth_place, death_place, bio, aliases)
+        VALUES (?, ?, 'M', ?, '定', ?, '王氏', '1910-05-20', '1985-11-15', '台南', '台北', ?, ?)
+    )");
+    // Bios carry one of a few dozen occupation words so full-text queries have realistic
+    // selectivity (~1/40 of the table per word)
+    static const char* kTrades[] = {
+        "farmer", "teacher", "merchant", "carpenter", "fisherman", "tailor", "scholar",
+        "physician", "blacksmith", "potter", "weaver", "boatman", "miller", "brewer",
+        "mason", "painter", "soldier", "clerk", "herbalist", "innkeeper", "jeweler",
+        "tanner", "barber", "baker", "butcher", "cooper", "dyer", "gardener", "hunter",
+        "locksmith", "monk", "musician", "printer", "sailor", "shepherd", "silversmith",
+        "smith", "tea grower", "vintner", "woodcutter"};
+    const std::string filler(360, 'x');
+    for (int i = 0; i < count; ++i) {
+        insert.bind(1, "m" + std::to_string(i));
+        insert.bind(2, "陈" + Han(100 + i % 50) + Han(300 + (i / 50) % 200));
+        insert.bind(3, 1 + i / 1000);
+        insert.bind(4, i == 0 ? std::string() : "m" + std::to_string((i - 1) / 3));
+        insert.bind(5, std::string("Worked as a ") + kTrades[i % std::size(kTrades)] + " " +
+                           filler);
+        insert.bind(6, "别名" + std::to_string(i));
+        insert.exec();
+        insert.reset();
+    }
+    db.exec("INSERT OR REPLACE INTO settings (key, value, updated_at) VALUES ('k', 'v', 0)");
+    tx.commit();
+}
+
+void BenchStatementCache(const std::string& dbPath, int members) {
+    std::cout << "[Prepared statement cache] " << kLookups << " lookups" << std::endl;
+    auto& db = DatabaseManager::instance();
+
+    // Before: what every DatabaseManager method used to do (parse + plan per call). Both
+    // sides run the same query and decode the row; the LRU member cache is off so
+    // GetMemberById reaches SQLite on every call.
+    db.Initialize(dbPath, {.member_cache = false});
+    SQLite::Database raw(dbPath, SQLite::OPEN_READONLY);
+    const std::string byId = "SELECT " + MemberSelectList() + " FROM members WHERE id = ?";
+    TimeIt("GetMemberById, new Statement per call", kLookups, [&](int i) {
+        SQLite::Statement query(raw, byId);
+        query.bind(1, "m" + std::to_string(i % members));
+        Member m;
+        if (query.executeStep()) {
+            ReadMember(query, m);
+        }
+    });
+    TimeIt("GetMemberById, cached statement      ", kLookups, [&](int i) {
+        db.GetMemberById("m" + std::to_string(i % members));
+    });
+
+    TimeIt("GetSetting, new Statement per call   ", kLookups, [&](int) {
+        SQLite::Statement query(raw, "SELECT value FROM settings WHERE key = ?");
+        query.bind(1, "k");
+        query.executeStep();
+    });
+    TimeIt("GetSetting, cached statement         ", kLookups, [&](int) {
+        db.GetSetting("k");
+    });
+
+    // LRU member cache on a warm working set small enough to stay resident
+    constexpr int kHotMembers = 1000;
+    int hot = std::min(members, kHotMembers);
+    db.Initialize(dbPath);
+    for (int i = 0; i < hot; ++i) {
+        db.GetMemberById("m" + std::to_string(i));
+    }
+    auto before = db.GetMemberCacheStats();
+    TimeIt("GetMemberById, LRU member cache hit  ", kLookups, [&](int i) {
+        db.GetMemberById("m" + std::to_string(i % hot));
+    });
+    auto after = db.GetMemberCacheStats();
+    std::cout << "    hits " << after.hits - before.hits << ", misses "
+              << after.misses - before.misses << std::endl;
+}
+
+// Legacy decoder: name-based getColumn() per field per row, as the old SELECT * paths did
+void ReadMemberByName(SQLite::Statement& query, Member& m) {
+    m.id = query.getColumn("id").getText();
+    m.name = query.getColumn("name").getText();
+    m.gender = query.getColumn("gender").getText();
+    m.generation = query.getColumn("generation").getInt();
+    m.generation_name = query.getColumn("generation_name").getText();
+    if (!query.getColumn("father_id").isNull())
+        m.father_id = query.getColumn("father_id").getText();
+    if (!query.getColumn("mother_id").isNull())
+        m.mother_id = query.getColumn("mother_id").getText();
+    if (!query.getColumn("spouse_name").isNull())
+        m.spouse_name = query.getColumn("spouse_name").getText();
+    m.birth_date = query.getColumn("birth_date").getText();
+    m.death_date = query.getColumn("death_date").getText();
+    m.birth_place = query.getColumn("birth_place").getText();
+    m.death_place = query.getColumn("death_place").getText();
+    m.portrait_path = query.getColumn("portrait_path").getText();
+    m.bio = query.getColumn("bio").getText();
+    if (!query.getColumn("aliases").isNull())
+        m.aliases = query.getColumn("aliases").getText();
+}
+
+// Full-table decode, reported as rows/sec
+void BenchRowDecoding(const std::string& dbPath) {
+    std::cout << "[Row decoding] full members table" << std::endl;
+    SQLite::Database raw(dbPath, SQLite::OPEN_READONLY);
+
+    auto run = [&](const std::string& name, const std::string& sql, auto&& decode) {
+        auto start = std::chrono::steady_clock::now();
+        SQLite::Statement query(raw, sql);
+        std::vector<Member> rows;
+        while (query.executeStep()) {
+            decode(query, rows.emplace_back());
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                          .count();
+        std::cout << "  " << name << ": " << static_cast<long long>(rows.size() / secs)
+                  << " rows/sec (" << rows.size() << " rows, " << secs * 1000 << " ms)"
+                  << std::endl;
+    };
+
+    run("SELECT * + getColumn(name)     ", "SELECT * FROM members",
+        [](SQLite::Statement& q, Member& m) { ReadMemberByName(q, m); });
+    run("column list + ReadMember(index)", "SELECT " + MemberSelectList() + " FROM members",
+        [](SQLite::Statement& q, Member& m) { ReadMember(q, m); });
+}
+
+// Keyword search on the full table: the old leading-wildcard LIKE scan + self-join
+// against the ranked FTS5 path
+void BenchSearch(const std::string& dbPath) {
+    constexpr int kSearches = 200;
+    std::cout << "[Search] " << kSearches << " queries" << std::endl;
+    auto& db = DatabaseManager::instance();
+
+    SQLite::Database raw(dbPath, SQLite::OPEN_READONLY);
+    SQLite::Statement like(raw, "SELECT " + MemberSelectList("m.") + R"(, f.name
+        FROM members m LEFT JOIN members f ON m.father_id = f.id
+        WHERE (m.name LIKE ? OR IFNULL(m.aliases, '') LIKE ? OR m.bio LIKE ?)
+        ORDER BY m.generation ASC, m.name ASC)");
+    TimeIt("LIKE '%kw%' scan + self-join         ", kSearches, [&](int) {
+        like.bind(1, "%herbal%");
+        like.bind(2, "%herbal%");
+        like.bind(3, "%herbal%");
+        std::vector<Member> rows;
+        while (like.executeStep()) {
+            ReadMember(like, rows.emplace_back());
+        }
+        like.reset();
+    });
+    TimeIt("FTS5 prefix + bm25 (top 100)         ", kSearches, [&](int) {
+        db.SearchMembers("herbal");
+    });
+    TimeIt("FTS5 two keywords (top 100)          ", kSearches, [&](int) {
+        db.SearchMembers("tanner dyer");
+    });
+    // Names are 陈 + one of 10k given names (~20 members each); search by given name only
+    TimeIt("FTS5 CJK partial name (bigrams)      ", kSearches, [&](int i) {
+        db.SearchMembers(Han(100 + i % 50) + Han(300 + i % 200));
+    });
+}
+
+// Bulk import of a generated clan_data.csv-style file into a fresh database: every row
+// names its father (the row's parent in a 3-ary tree) and carries a short Chinese bio
+void BenchImport(const fs::path& dir, int rows) {
+    std::cout << "[Import] " << rows << " CSV rows" << std::endl;
+    fs::path csvPath = dir / "import.csv";
+    {
+        std::ofstream csv(csvPath, std::ios::binary);
+        csv << "Name,Gender,Generation,FatherName,GenerationName,Spouse,BirthDate,DeathDate,"
+               "BirthPlace,DeathPlace,Bio\n";
+        auto name = [](int i) { return "陈" + Han(i % 3000) + Han(3000 + i / 3000); };
+        for (int i = 0; i < rows; ++i) {
+            csv << name(i) << ",M," << 1 + i / 100000 << ','
+                << (i == 0 ? std::string() : name((i - 1) / 3))
+                << ",定,王氏,1910-05-20,1985-11-15,台南,台北,"
+                << "勤劳耕作，家族长子。早年随父渡海来台，经营茶行数十年。\n";
+        }
+    }
+
+    std::string dbPath = (dir / "import.db").string();
+    fs::remove(dbPath);
+    auto& db = DatabaseManager::instance();
+    db.Initialize(dbPath);
+
+    auto source = OpenMemberSource(csvPath.string());
+    auto result = db.ImportMembers(*source);
+    std::cout << "  ImportMembers: " << result.imported << " rows in " << result.elapsed_ms
+              << " ms (" << static_cast<long long>(result.imported * 1000.0 /
+                                                   std::max<long long>(result.elapsed_ms, 1))
+              << " rows/sec), unresolved fathers: " << result.unresolved_fathers << std::endl;
+}
+
+// Read throughput with N concurrent readers on TaskManager threads: every DatabaseManager
+// call on one mutex-guarded connection vs the WAL read pool
+void BenchConcurrentReads(const std::string& dbPath, int members) {
+    constexpr int kReadsPerTask = 20000;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "[Concurrent reads] GetMemberById + GetSetting, " << cores << " core(s)"
+              << std::endl;
+    auto& db = DatabaseManager::instance();
+
+    std::vector<unsigned> taskCounts;  // 1, 2, 4, ... cores
+    for (unsigned n = 1; n < cores; n *= 2) {
+        taskCounts.push_back(n);
+    }
+    taskCounts.push_back(cores);
+
+    for (int poolSize : {0, static_cast<int>(cores)}) {
+        db.Initialize(dbPath, {.read_connections = poolSize});
+        for (unsigned tasks : taskCounts) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::future<void>> running;
+            for (unsigned t = 0; t < tasks; ++t) {
+                running.push_back(TaskManager::instance().async([&db, members, t] {
+                    for (int i = 0; i < kReadsPerTask; ++i) {
+                        db.GetMemberById("m" + std::to_string((i * 7919 + t) % members));
+                        db.GetSetting("k");
+                    }
+                }));
+            }
+            for (auto& f : running) {
+                f.get();
+            }
+            double secs =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << (poolSize ? "read pool        " : "single connection") << ", "
+                      << tasks << " task(s): "
+                      << static_cast<long long>(tasks * kReadsPerTask * 2 / secs) << " reads/sec"
+                      << std::endl;
+        }
+    }
+    db.Initialize(dbPath);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int members = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int importRows = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    fs::path dir = fs::temp_directory_path() / "clan_db_bench";
+    fs::create_directories(dir);
+    std::string dbPath = (dir / "bench.db").string();
+    fs::remove(dbPath);
+
+    Log::instance().init({.console = true, .rotating = false, .log_dir = dir.string()});
+    Log::instance().set_level(spdlog::level::warn);
+
+    auto& db = DatabaseManager::instance();
+    db.Initialize(dbPath);  // create schema
+    SeedMembers(dbPath, members);
+    std::cout << "Seeded " << members << " members at " << dbPath << std::endl;
+    TimeIt("Initialize on an existing database", 1, [&](int) { db.Initialize(dbPath); });
+
+    BenchStatementCache(dbPath, members);
+    BenchRowDecoding(dbPath);
+    BenchSearch(dbPath);
+    BenchConcurrentReads(dbPath, members);
+    BenchImport(dir, importRows);
+
+    Log::instance().deinit();
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Content hashing throughput (XXH64), in memory and through HashFile.
+// Not registered with CTest; run manually:
+//   ./bin/hash_benchmarks                 (256 MiB synthetic buffer and temp file)
+//   ./bin/hash_benchmarks /path/to/video  (also hashes a real file once; cold cache if it
+//                                          was not read recently)
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/resource/content_hash.h"
+
+using namespace clan::core;
+
+namespace {
+
+constexpr int kRounds = 5;
+
+double Seconds(const std::function<void()>& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Best of kRounds, printed as GB/s (1e9 bytes)
+void Measure(const std::string& name, size_t bytes, const std::function<void()>& fn) {
+    double best = 1e30;
+    for (int round = 0; round < kRounds; ++round) {
+        best = std::min(best, Seconds(fn));
+    }
+    std::cout << "  " << name << ": " << bytes / best / 1e9 << " GB/s" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t kBig = 256u << 20;
+    std::vector<char> data(kBig);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i * 131 + (i >> 12));
+    }
+    uint64_t sink = 0;  // keeps results observable
+
+    std::cout << "[XXH64 in memory]" << std::endl;
+    for (size_t size : {size_t{4} << 10, size_t{1} << 20, kBig}) {
+        size_t repeat = std::max<size_t>(1, kBig / size);
+        Measure(std::to_string(size >> 10) + " KiB x " + std::to_string(repeat), size * repeat,
+                [&] {
+                    for (size_t r = 0; r < repeat; ++r) {
+                        sink += Xxh64Hash(data.data(), size);
+                    }
+                });
+    }
+    Measure("streaming, 64 KiB updates   ", kBig, [&] {
+        Xxh64 hash;
+        for (size_t offset = 0; offset < kBig; offset += 64 << 10) {
+            hash.Update(data.data() + offset, 64 << 10);
+        }
+        sink += hash.Digest();
+    });
+
+    std::cout << "[HashFile, page cache warm]" << std::endl;
+    auto path = std::filesystem::temp_directory_path() / "clan_hash_bench.bin";
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(kBig));
+    Measure("256 MiB file (mmap)         ", kBig, [&] { sink += HashFile(path).value_or(0); });
+    std::filesystem::remove(path);
+
+    if (argc > 1) {
+        std::filesystem::path file(argv[1]);
+        auto bytes = std::filesystem::file_size(file);
+        double seconds = Seconds([&] { sink += HashFile(file).value_or(0); });
+        std::cout << "[HashFile] " << file.string() << ": " << bytes / seconds / 1e9
+                  << " GB/s (single pass)" << std::endl;
+    }
+    return sink == 42 ? 1 : 0;
+}
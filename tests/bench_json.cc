@@ -0,0 +1,151 @@
+// Bridge payload serialization for the fetchFamilyTree payload: the previous
+// QJsonObject-per-row path, the streaming JsonWriter and the binary tree snapshot.
+// Not registered with CTest; run manually:
+//   ./bin/json_benchmarks           (100k members)
+//   ./bin/json_benchmarks 500000
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/db/kinship_index.h"
+#include "core/db/models.h"
+#include "core/json/bridge_json.h"
+#include "core/json/json_writer.h"
+#include "core/json/tree_snapshot.h"
+
+using namespace clan::core;
+
+namespace {
+
+constexpr int kRounds = 5;
+
+// UTF-8 for the k-th CJK unified ideograph (U+4E00 + k)
+std::string Han(int k) {
+    char32_t cp = 0x4E00 + k;
+    return {static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+            static_cast<char>(0x80 | (cp & 0x3F))};
+}
+
+std::vector<Member> MakeMembers(int count) {
+    std::vector<Member> members;
+    members.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Member m;
+        m.id = "m" + std::to_string(i);
+        m.name = "陈" + Han(100 + i % 50) + Han(300 + (i / 50) % 200);
+        m.gender = "M";
+        m.generation = 1 + i / 1000;
+        m.generation_name = "定";
+        m.father_id = i == 0 ? std::string() : "m" + std::to_string((i - 1) / 3);
+        m.spouse_name = "王氏";
+        m.birth_date = "1910-05-20";
+        m.death_date = "1985-11-15";
+        m.portrait_path = i % 4 == 0 ? "media/portrait_" + std::to_string(i) + ".jpg" : "";
+        members.push_back(std::move(m));
+    }
+    return members;
+}
+
+// Serializes kRounds times; prints the best round as MB/s of JSON produced.
+void Measure(const std::string& name, const std::function<size_t()>& serialize) {
+    double best = 1e30;
+    size_t bytes = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        bytes = serialize();
+        best = std::min(
+            best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::cout << "  " << name << ": " << bytes / 1024 << " KiB in " << best * 1000 << " ms, "
+              << bytes / best / 1e6 << " MB/s" << std::endl;
+}
+
+// What JsBridge::fetchFamilyTree did before JsonWriter: a QJsonObject per member, every
+// string converted to UTF-16, the document converted back to UTF-8 and then to QString.
+QString TreeViaQJson(const std::vector<Member>& members) {
+    QJsonArray array;
+    for (const auto& m : members) {
+        QJsonObject jobj;
+        jobj["id"] = QString::fromStdString(m.id);
+        jobj["name"] = QString::fromStdString(m.name);
+        jobj["parentId"] = QString::fromStdString(m.father_id);
+        jobj["generation"] = m.generation;
+        jobj["generationName"] = QString::fromStdString(m.generation_name);
+        jobj["spouseName"] = QString::fromStdString(m.spouse_name);
+        jobj["gender"] = QString::fromStdString(m.gender);
+        jobj["portraitPath"] = QString::fromStdString(m.portrait_path);
+        QString lifeSpan;
+        if (!m.birth_date.empty()) {
+            lifeSpan = QString::fromStdString(m.birth_date).left(4);
+            if (!m.death_date.empty()) {
+                lifeSpan += "-" + QString::fromStdString(m.death_date).left(4);
+            }
+        }
+        jobj["lifeSpan"] = lifeSpan;
+        array.append(jobj);
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
+void TreeViaWriter(JsonWriter& out, const std::vector<Member>& members) {
+    out.Clear();
+    out.Reserve(members.size() * 256);
+    out.BeginArray();
+    for (const auto& m : members) {
+        out.BeginObject();
+        WriteTreeNodeFields(out, m, {});
+        out.EndObject();
+    }
+    out.EndArray();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    auto members = MakeMembers(count);
+    std::cout << "[Tree payload] " << count << " members" << std::endl;
+
+    // Both paths produce the same JSON up to key order; its UTF-8 size is the throughput basis
+    JsonWriter out;
+    TreeViaWriter(out, members);
+    const size_t jsonBytes = out.size();
+    qsizetype sink = 0;  // keeps results observable
+
+    Measure("QJsonObject -> QString     ", [&] {
+        sink += TreeViaQJson(members).size();
+        return jsonBytes;
+    });
+    Measure("JsonWriter (UTF-8 buffer)  ", [&] {
+        TreeViaWriter(out, members);
+        return out.size();
+    });
+    Measure("JsonWriter -> QString      ", [&] {
+        TreeViaWriter(out, members);
+        sink += QString::fromUtf8(out.str().data(), static_cast<qsizetype>(out.size())).size();
+        return out.size();
+    });
+
+    // Same data as fetchTreeSnapshot: members and father positions from the kinship index
+    KinshipIndex index;
+    index.Build(members);
+    std::vector<int32_t> fathers;
+    auto ordered = index.GetAll(&fathers);
+    size_t snapshotBytes = 0;
+    Measure("Tree snapshot (binary)     ", [&] {
+        snapshotBytes = EncodeTreeSnapshot(ordered, fathers, 1).size();
+        return snapshotBytes;
+    });
+    std::cout << "  snapshot / JSON size: " << 100.0 * snapshotBytes / jsonBytes << "%"
+              << std::endl;
+    return sink > 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Logging throughput and caller latency for LogConfig combinations: sync vs async,
+// rotating vs daily file sink, async queue size, overflow policy and worker threads.
+// Not registered with CTest; run manually:
+//   ./bin/log_benchmarks              (4 producer threads x 100k messages per config)
+//   ./bin/log_benchmarks 20000 8      (20k messages on each of 8 producers)
+// "call" columns are the time a LOGINFO takes on the calling thread; "drained" includes
+// waiting for the async workers to write everything out. The console and LogViewer ring
+// sinks are off so that only the file pipeline is measured.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/log/log.h"
+
+using namespace clan::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double callRate = 0;     // messages/s seen by the producers
+    double drainedRate = 0;  // messages/s until the files had everything
+    double p50 = 0, p99 = 0, p999 = 0, max = 0;  // per-call latency, µs
+    size_t overruns = 0;     // messages overrun_oldest discarded
+};
+
+std::string Describe(const LogConfig& config) {
+    std::string text = config.use_async ? "async" : "sync ";
+    text += config.daily ? " daily   " : " rotating";
+    if (config.use_async) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof buffer, " q=%-6zu %-8s thr=%zu", config.async_queue_size,
+                      config.async_overflow == spdlog::async_overflow_policy::block ? "block"
+                                                                                    : "overrun",
+                      config.async_threads);
+        text += buffer;
+    } else {
+        text += std::string(26, ' ');
+    }
+    return text;
+}
+
+Result Run(LogConfig config, const fs::path& dir, int perThread, int producers) {
+    fs::remove_all(dir);
+    config.log_dir = dir.string();
+    Log::instance().init(config);
+
+    std::vector<std::vector<uint32_t>> latencies(producers);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int t = 0; t < producers; ++t) {
+        threads.emplace_back([&, t] {
+            auto& samples = latencies[t];
+            samples.reserve(perThread);
+            for (int i = 0; i < perThread; ++i) {
+                auto before = Clock::now();
+                LOGINFO("[Bench] Saved member m{} ({} field(s)) in {} ms", i, t + 1, i % 7);
+                samples.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before)
+                        .count()));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto called = Clock::now();
+
+    Result result;
+    if (config.use_async) {
+        result.overruns = spdlog::thread_pool()->overrun_counter();
+    }
+    Log::instance().deinit();  // drains the async queue and flushes the files
+    auto drained = Clock::now();
+
+    std::vector<uint32_t> all;
+    for (auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) {
+        return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))] / 1e3;
+    };
+    double messages = static_cast<double>(all.size());
+    result.callRate = messages / std::chrono::duration<double>(called - start).count();
+    result.drainedRate = messages / std::chrono::duration<double>(drained - start).count();
+    result.p50 = percentile(0.50);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    result.max = all.back() / 1e3;
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int perThread = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int producers = argc > 2 ? std::atoi(argv[2]) : 4;
+    if (perThread <= 0 || producers <= 0) {
+        std::cerr << "usage: log_benchmarks [messages per thread] [producer threads]"
+                  << std::endl;
+        return 1;
+    }
+    fs::path dir = fs::temp_directory_path() / "clan_log_bench";
+
+    std::vector<LogConfig> configs;
+    for (bool daily : {false, true}) {
+        LogConfig base{.console = false, .daily = daily, .rotating = !daily, .ring_capacity = 0};
+        configs.push_back(base);
+        for (size_t queue : {1024, 8192, 65536}) {
+            for (auto policy : {spdlog::async_overflow_policy::block,
+                                spdlog::async_overflow_policy::overrun_oldest}) {
+                for (size_t workers : {1, 2}) {
+                    LogConfig config = base;
+                    config.use_async = true;
+                    config.async_queue_size = queue;
+                    config.async_threads = workers;
+                    config.async_overflow = policy;
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+
+    std::cout << producers << " producer thread(s) x " << perThread << " messages" << std::endl;
+    std::printf("%-51s %10s %10s %8s %8s %8s %8s %9s\n", "config", "call/s", "drained/s",
+                "p50 us", "p99 us", "p99.9 us", "max us", "overruns");
+    for (const auto& config : configs) {
+        Result r = Run(config, dir, perThread, producers);
+        std::printf("%-51s %10.0f %10.0f %8.2f %8.2f %8.2f %8.0f %9zu\n",
+                    Describe(config).c_str(), r.callRate, r.drainedRate, r.p50, r.p99, r.p999,
+                    r.max, r.overruns);
+        std::fflush(stdout);
+    }
+    fs::remove_all(dir);
+    return 0;
+}
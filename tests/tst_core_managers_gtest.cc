@@ -1,13 +1,46 @@
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <future>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <thread>
 
+#include "cpp-httplib/httplib.h"
 #include "gtest/gtest.h"
 
 // 引入所有我們要測試的類
+#include "core/cache/lru_cache.h"
+#include "core/cache/thumbnail_cache.h"
 #include "core/config/config_manager.h"
+#include "core/db/cjk_tokenizer.h"
+#include "core/db/connection_pool.h"
+#include "core/db/database_manager.h"
+#include "core/db/kinship_index.h"
+#include "core/db/member_columns.h"
+#include "core/db/member_diff.h"
+#include "core/db/member_import.h"
+#include "core/db/operation_log_writer.h"
+#include "core/db/schema_migrator.h"
+#include "core/db/search_cache.h"
+#include "core/db/statement_cache.h"
+#include "core/db/tree_change_log.h"
+#include "core/json/bridge_json.h"
+#include "core/json/json_writer.h"
+#include "core/json/tree_snapshot.h"
 #include "core/log/log.h"
+#include "core/log/log_ring.h"
+#include "core/network/media_server.h"
 #include "core/network/network_manager.h"
 #include "core/platform/path_manager.h"
+#include "core/resource/content_hash.h"
+#include "core/resource/file_ingest.h"
+#include "core/resource/resource_manager.h"
 #include "core/task/task_manager.h"
 #include "shared/Constants.h"
 // 使用我們的命名空間
@@ -139,3 +172,1255 @@ TEST_F(CoreManagersTest, NetworkManagerPostRequest) {
     ASSERT_TRUE(result_data.contains("json"));
     EXPECT_EQ(result_data["json"].value("user", ""), "test");
 }
+
+// Kinship graph index: CSR children, lineage walks and in-place patching
+TEST(KinshipIndexTest, LineageQueriesAndPatching) {
+    KinshipIndex index;
+    // Child listed before its father on purpose: linking must not depend on input order
+    index.Build({
+        {.id = "3", .name = "grandson", .generation = 3, .father_id = "2", .bio = "long bio"},
+        {.id = "1", .name = "founder", .generation = 1},
+        {.id = "2", .name = "son", .generation = 2, .father_id = "1"},
+        {.id = "4", .name = "daughter", .generation = 2, .father_id = "1"},
+    });
+
+    ASSERT_EQ(index.size(), 4u);
+    EXPECT_TRUE(index.HasChildren("1"));
+    EXPECT_FALSE(index.HasChildren("3"));
+    EXPECT_EQ(index.GetChildren("1").size(), 2u);
+
+    auto all = index.GetAll();
+    ASSERT_EQ(all.size(), 4u);
+    EXPECT_EQ(all.front().id, "1");  // ordered by generation
+    EXPECT_TRUE(all.back().bio.empty());
+
+    auto ancestors = index.GetAncestors("3");
+    ASSERT_EQ(ancestors.size(), 2u);
+    EXPECT_EQ(ancestors[0].id, "2");
+    EXPECT_EQ(ancestors[1].id, "1");
+    EXPECT_EQ(index.GetAncestors("3", 1).size(), 1u);
+    EXPECT_EQ(index.GetDescendants("1").size(), 3u);
+    EXPECT_EQ(index.GetDescendants("1", 1).size(), 2u);
+    EXPECT_EQ(index.Find("3")->father_name, "son");
+
+    // Re-parent the grandson under the daughter
+    index.Upsert({.id = "3", .name = "grandson", .generation = 3, .father_id = "4"});
+    EXPECT_FALSE(index.HasChildren("2"));
+    EXPECT_TRUE(index.HasChildren("4"));
+
+    // Removing a parent detaches children; re-inserting it re-links them
+    EXPECT_TRUE(index.Remove("4"));
+    EXPECT_FALSE(index.Contains("4"));
+    EXPECT_TRUE(index.GetAncestors("3").empty());
+    index.Upsert({.id = "4", .name = "daughter", .generation = 2, .father_id = "1"});
+    EXPECT_EQ(index.GetAncestors("3").size(), 2u);
+}
+
+// Paged tree view: bounded subtrees, child pages and generation slices
+TEST(KinshipIndexTest, PagedTreeWindows) {
+    KinshipIndex index;
+    index.Build({
+        {.id = "1", .name = "founder", .generation = 1},
+        {.id = "2", .name = "son", .generation = 2, .father_id = "1"},
+        {.id = "3", .name = "son", .generation = 2, .father_id = "1"},
+        {.id = "4", .name = "son", .generation = 2, .father_id = "1"},
+        {.id = "5", .name = "grandson", .generation = 3, .father_id = "2", .mother_id = "9"},
+        {.id = "9", .name = "wife", .generation = 2},
+    });
+
+    auto roots = index.GetSubtree("", 0, 0);
+    ASSERT_EQ(roots.members.size(), 2u);  // founder and the in-married wife
+    EXPECT_EQ(roots.members[0].id, "1");
+    EXPECT_EQ(roots.child_counts[0], 3u);
+    EXPECT_EQ(roots.child_counts[1], 0u);  // mother links are not tree edges
+
+    auto top = index.GetSubtree("1", 1, 0);
+    EXPECT_EQ(top.members.size(), 4u);
+    EXPECT_FALSE(top.has_more);
+    auto capped = index.GetSubtree("1", 5, 3);
+    EXPECT_EQ(capped.members.size(), 3u);
+    EXPECT_TRUE(capped.has_more);
+
+    auto first = index.GetChildPage("1", 0, 2);
+    ASSERT_EQ(first.members.size(), 2u);
+    EXPECT_TRUE(first.has_more);
+    auto rest = index.GetChildPage("1", 2, 2);
+    ASSERT_EQ(rest.members.size(), 1u);
+    EXPECT_EQ(rest.members[0].id, "4");
+    EXPECT_FALSE(rest.has_more);
+
+    auto gen2 = index.GetGenerationRange(2, 2, 1, 2);
+    ASSERT_EQ(gen2.members.size(), 2u);
+    EXPECT_TRUE(gen2.has_more);
+    EXPECT_EQ(index.GetGenerationRange(2, 3, 0, 0).members.size(), 5u);
+    EXPECT_TRUE(index.GetGenerationRange(4, 9, 0, 0).members.empty());
+}
+
+// Heavy churn: links patched in place stay consistent through overlay folds and the
+// compaction of removed slots
+TEST(KinshipIndexTest, ChurnFoldsAndCompacts) {
+    KinshipIndex index;
+    std::vector<Member> members;
+    for (int i = 0; i < 3000; ++i) {
+        members.push_back({.id = "m" + std::to_string(i),
+                           .generation = 1 + i / 100,
+                           .father_id = i == 0 ? "" : "m" + std::to_string((i - 1) / 2)});
+    }
+    index.Build(members);
+    // Move every other member under the founder, then drop most of the tree
+    for (int i = 1; i < 3000; i += 2) {
+        index.Upsert({.id = "m" + std::to_string(i), .generation = 2, .father_id = "m0"});
+    }
+    EXPECT_EQ(index.GetChildPage("m0", 0, 0).members.size(), 1501u);  // + m2
+    for (int i = 1000; i < 3000; ++i) {
+        index.Remove("m" + std::to_string(i));
+    }
+    ASSERT_EQ(index.size(), 1000u);
+    EXPECT_EQ(index.GetChildren("m0").size(), 501u);
+    EXPECT_FALSE(index.HasChildren("m998"));  // its children were removed
+    EXPECT_EQ(index.GetAncestors("m998").back().id, "m0");
+
+    // A re-inserted parent picks up the children waiting for it
+    index.Remove("m0");
+    EXPECT_EQ(index.GetSubtree("", 0, 0).members.size(), 501u);  // its children are roots now
+    index.Upsert({.id = "m0", .generation = 1});
+    EXPECT_EQ(index.GetChildren("m0").size(), 501u);
+    EXPECT_EQ(index.GetSubtree("", 0, 0).members.size(), 1u);
+    auto all = index.GetAll();
+    EXPECT_TRUE(std::is_sorted(all.begin(), all.end(), [](const Member& a, const Member& b) {
+        return a.generation < b.generation;
+    }));
+}
+
+// Streaming JSON writer: separators, escaping and the bridge row shapes
+TEST(JsonWriterTest, WritesEscapedUtf8WithoutDom) {
+    JsonWriter out;
+    out.BeginArray();
+    out.BeginObject().Field("s", "a\"b\\c\n\x01").Field("n", int64_t{-42}).Field("ok", true);
+    out.Key("list").BeginArray().Int(1).Null().BeginObject().EndObject().EndArray().EndObject();
+    out.String("陈氏").EndArray();
+    EXPECT_EQ(out.str(),
+              R"([{"s":"a\"b\\c\n\u0001","n":-42,"ok":true,"list":[1,null,{}]},"陈氏"])");
+
+    size_t capacity = out.capacity();
+    out.Clear();
+    EXPECT_EQ(out.size(), 0u);
+    EXPECT_EQ(out.capacity(), capacity);  // buffer kept for reuse
+
+    Member m{.id = "m1", .name = "陈定", .generation = 3, .father_id = "m0",
+             .birth_date = "1910-05-20", .death_date = "1985-11-15",
+             .bio = std::string(60, 'x')};
+    out.BeginObject();
+    WriteTreeNodeFields(out, m, "");
+    out.EndObject();
+    EXPECT_NE(out.str().find(R"("lifeSpan":"1910-1985")"), std::string::npos);
+    EXPECT_EQ(out.str().find("avatarUrl"), std::string::npos);
+    EXPECT_EQ(LifeSpan({.birth_date = "民国二十年", .death_date = "1985-11-15"}),
+              "民国二十-1985");  // cut on characters, not bytes
+
+    out.Clear();
+    out.BeginObject();
+    WriteSearchHitFields(out, m);
+    out.EndObject();
+    EXPECT_NE(out.str().find(std::string(R"("bioSnippet":")") + std::string(50, 'x') + "...\""),
+              std::string::npos);
+
+    // Snippets are cut in UTF-16 units on code point boundaries, like QString::left
+    EXPECT_EQ(Utf8PrefixUtf16("陈氏家", 2), "陈氏");
+    EXPECT_EQ(Utf8PrefixUtf16("a\xF0\x9F\x98\x80b", 2), "a");
+    EXPECT_EQ(Utf8PrefixUtf16("ab", 5), "ab");
+}
+
+// Binary tree snapshot: header, father positions, columns and the shared string table
+TEST(TreeSnapshotTest, EncodesColumnsAndDedupedStrings) {
+    std::vector<Member> members = {
+        {.id = "a", .name = "陈祖", .gender = "M", .generation = 1, .generation_name = "定"},
+        {.id = "b", .name = "陈子", .gender = "F", .generation = 2, .generation_name = "定",
+         .father_id = "a"},
+        {.id = "c", .name = "陈子", .generation = 2, .father_id = "missing"},
+    };
+    std::string bytes = EncodeTreeSnapshot(members, {}, (uint64_t{1} << 32) + 5);
+    auto u32 = [&](size_t word) {
+        uint32_t value;
+        std::memcpy(&value, bytes.data() + word * 4, 4);
+        return value;
+    };
+
+    EXPECT_EQ(u32(0), kTreeSnapshotMagic);
+    EXPECT_EQ(u32(1), kTreeSnapshotVersion);
+    EXPECT_EQ(u32(2), 3u);
+    EXPECT_EQ(u32(4), 5u);  // revision, low then high word
+    EXPECT_EQ(u32(5), 1u);
+
+    // parent i32[3] at word 6, generation at 9, gender bytes at 12 (one padded word)
+    EXPECT_EQ(static_cast<int32_t>(u32(6)), -1);
+    EXPECT_EQ(u32(7), 0u);
+    EXPECT_EQ(static_cast<int32_t>(u32(8)), -1);  // unresolved father
+    EXPECT_EQ(u32(10), 2u);
+    EXPECT_EQ(bytes[12 * 4], 1);
+    EXPECT_EQ(bytes[12 * 4 + 1], 2);
+    EXPECT_EQ(bytes[12 * 4 + 2], 0);
+
+    // columns start at word 13: id, then name; equal names share one string
+    size_t names = 13 + 3;
+    EXPECT_EQ(u32(names + 1), u32(names + 2));
+    EXPECT_NE(u32(names), u32(names + 1));
+    // ids, names (2 distinct), generation name and "" make 7 strings
+    EXPECT_EQ(u32(3), 7u);
+    size_t offsets = 13 + 3 * kTreeSnapshotStringColumns;
+    size_t blob = (offsets + u32(3) + 1) * 4;
+    EXPECT_EQ(bytes.size(), blob + u32(offsets + u32(3)));
+    uint32_t id = u32(13 + 1);  // member b
+    EXPECT_EQ(bytes.substr(blob + u32(offsets + id), u32(offsets + id + 1) - u32(offsets + id)),
+              "b");
+}
+
+// Tree change feed: revisions, per-member coalescing and resync when history is gone
+TEST(TreeChangeLogTest, CoalescesDeltasSinceRevision) {
+    TreeChangeLog feed(/*capacity=*/4);
+    uint64_t base = feed.revision();
+
+    feed.Record(TreeChangeKind::kAdd, {.id = "a", .name = "v1"});
+    feed.Record(TreeChangeKind::kUpdate, {.id = "a", .name = "v2"});
+    feed.Record(TreeChangeKind::kAdd, {.id = "b"});
+    feed.Record(TreeChangeKind::kRemove, {.id = "b"});
+
+    auto delta = feed.Since(base);
+    EXPECT_FALSE(delta.full_resync);
+    EXPECT_EQ(delta.revision, feed.revision());
+    ASSERT_EQ(delta.changes.size(), 1u);  // b was added and removed: net nothing
+    EXPECT_EQ(delta.changes[0].kind, TreeChangeKind::kAdd);
+    EXPECT_EQ(delta.changes[0].member.name, "v2");
+
+    EXPECT_TRUE(feed.Since(feed.revision()).changes.empty());
+
+    // Overflow the history window: the original base is no longer servable
+    feed.Record(TreeChangeKind::kUpdate, {.id = "a"});
+    EXPECT_TRUE(feed.Since(base).full_resync);
+
+    feed.Reset();
+    EXPECT_TRUE(feed.Since(delta.revision).full_resync);
+}
+
+// Statement cache: same SQL text reuses the prepared statement, reset between uses
+TEST(StatementCacheTest, ReusesAndResetsStatements) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE t (k TEXT PRIMARY KEY, v TEXT)");
+    db.exec("INSERT INTO t VALUES ('a', '1'), ('b', '2')");
+
+    StatementCache cache(db);
+    const std::string sql = "SELECT v FROM t WHERE k = ?";
+    for (const char* key : {"a", "b", "a"}) {
+        auto query = cache.Acquire(sql);
+        query->bind(1, key);
+        ASSERT_TRUE(query->executeStep());
+        EXPECT_EQ(query->getColumn(0).getString(), key == std::string("a") ? "1" : "2");
+    }
+    EXPECT_EQ(cache.misses(), 1u);
+    EXPECT_EQ(cache.hits(), 2u);
+
+    // Re-entrant use of the same SQL gets a second instance
+    {
+        auto outer = cache.Acquire(sql);
+        auto inner = cache.Acquire(sql);
+        EXPECT_NE(&*outer, &*inner);
+    }
+    EXPECT_EQ(cache.size(), 2u);
+    cache.Clear();
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+// Read pool over a WAL database: leased readers see committed writes, never block on an
+// open write transaction, and run side by side; Acquire waits while every one is leased
+TEST(ConnectionPoolTest, PooledReadersRunBesideTheWriter) {
+    auto dir = std::filesystem::temp_directory_path() / "clan_pool_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto path = (dir / "pool.db").string();
+    SQLite::Database writer(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    writer.exec("PRAGMA journal_mode = WAL");
+    writer.exec("CREATE TABLE t (x INTEGER)");
+    writer.exec("INSERT INTO t VALUES (1)");
+
+    auto count = [](const ConnectionPool::Lease& lease) {
+        auto query = lease.statements().Acquire("SELECT count(*) FROM t");
+        return query->executeStep() ? query->getColumn(0).getInt() : -1;
+    };
+
+    ConnectionPool pool;
+    pool.Open(path, 2, nullptr);
+    ASSERT_EQ(pool.size(), 2u);
+    {
+        std::optional<ConnectionPool::Lease> a(pool.Acquire());
+        auto b = pool.Acquire();
+        ASSERT_TRUE(*a && b);
+        EXPECT_NE(&a->db(), &b.db());
+
+        SQLite::Transaction write(writer);
+        writer.exec("INSERT INTO t VALUES (2)");
+        EXPECT_EQ(count(*a), 1);  // uncommitted row invisible, and no SQLITE_BUSY
+        EXPECT_EQ(count(b), 1);
+        write.commit();
+        EXPECT_EQ(count(*a), 2);
+        EXPECT_EQ(count(b), 2);
+
+        // Both connections are leased: a third reader waits for one to come back
+        auto third = std::async(std::launch::async, [&] { return count(pool.Acquire()); });
+        EXPECT_EQ(third.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+        a.reset();
+        EXPECT_EQ(third.get(), 2);
+    }
+
+    pool.Close();
+    EXPECT_FALSE(pool.Acquire());  // closed pool: callers fall back to the writer
+    std::filesystem::remove_all(dir);
+}
+
+// Member column map: explicit select list decoded by index, NULLs read as empty
+TEST(MemberColumnsTest, DecodesExplicitSelectList) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.exec(R"(CREATE TABLE members (id TEXT, name TEXT, gender TEXT, generation INTEGER,
+        generation_name TEXT, father_id TEXT, mother_id TEXT, spouse_name TEXT,
+        birth_date TEXT, death_date TEXT, birth_place TEXT, death_place TEXT,
+        portrait_path TEXT, bio TEXT, aliases TEXT, created_at INTEGER))");
+    db.exec(R"(INSERT INTO members (id, name, generation, father_id, bio, aliases)
+               VALUES ('2', '陈大伯', 2, '1', 'bio text', NULL))");
+
+    SQLite::Statement full(db, "SELECT " + MemberSelectList("m.") + " FROM members m");
+    ASSERT_TRUE(full.executeStep());
+    Member m;
+    ReadMember(full, m);
+    EXPECT_EQ(m.id, "2");
+    EXPECT_EQ(m.name, "陈大伯");
+    EXPECT_EQ(m.generation, 2);
+    EXPECT_EQ(m.father_id, "1");
+    EXPECT_EQ(m.bio, "bio text");
+    EXPECT_TRUE(m.aliases.empty());
+    EXPECT_TRUE(m.gender.empty());
+
+    SQLite::Statement summary(db, "SELECT " + MemberSelectList({}, false) + " FROM members");
+    ASSERT_TRUE(summary.executeStep());
+    Member s;
+    ReadMember(summary, s);
+    EXPECT_EQ(s.name, "陈大伯");
+    EXPECT_TRUE(s.bio.empty());
+}
+
+// Data-layer tests log through LOG*; the fixture above is not used by them
+static void EnsureTestLog() {
+    if (!Log::instance().logger()) {
+        Log::instance().init({.rotating = false});
+    }
+}
+
+// Data-layer tests: each gets an empty directory under the temp dir, holding a fresh
+// database that DatabaseManager has open, and both are removed afterwards
+class DatabaseManagerTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        EnsureTestLog();
+        const auto* info = testing::UnitTest::GetInstance()->current_test_info();
+        dir_ = std::filesystem::temp_directory_path() /
+               (std::string("clan_") + info->test_suite_name() + "_" + info->name());
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+        db_.Initialize((dir_ / "clan.db").string());
+    }
+
+    void TearDown() override {
+        db_.Initialize(":memory:");  // releases the file so the directory can go
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    std::filesystem::path dir_;
+    DatabaseManager& db_ = DatabaseManager::instance();
+};
+
+// Suites whose tests end with a database round trip share the fixture
+using OperationLogWriterTest = DatabaseManagerTest;
+using MemberDiffTest = DatabaseManagerTest;
+
+// Media imports also store files under the test directory instead of resources/media
+class MediaStorageTest : public DatabaseManagerTest {
+  protected:
+    void SetUp() override {
+        DatabaseManagerTest::SetUp();
+        ResourceManager::instance().SetMediaDir(dir_ / "media");
+    }
+
+    void TearDown() override {
+        ResourceManager::instance().SetMediaDir({});
+        DatabaseManagerTest::TearDown();
+    }
+};
+
+using ResourceManagerTest = MediaStorageTest;
+using ContentHashTest = MediaStorageTest;
+using FileIngestTest = MediaStorageTest;
+
+// Schema migrations: pending steps run once, in order; a failing step rolls back and halts
+TEST(SchemaMigratorTest, AppliesPendingStepsOnce) {
+    EnsureTestLog();
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    int runs = 0;
+    std::vector<SchemaMigration> steps = {
+        {1, "t1", [&](SQLite::Database& d) { d.exec("CREATE TABLE t1 (x)"); ++runs; }},
+        {2, "t2", [&](SQLite::Database& d) { d.exec("CREATE TABLE t2 (x)"); ++runs; }},
+    };
+
+    SchemaMigrator migrator(db);
+    EXPECT_EQ(migrator.CurrentVersion(), 0);
+    EXPECT_EQ(migrator.Migrate(steps).size(), 2u);
+    EXPECT_EQ(migrator.CurrentVersion(), 2);
+    EXPECT_TRUE(SchemaMigrator(db).Migrate(steps).empty());
+    EXPECT_EQ(runs, 2);
+
+    steps.push_back({3, "broken", [](SQLite::Database& d) {
+                         d.exec("CREATE TABLE t3 (x)");
+                         d.exec("no such statement");
+                     }});
+    steps.push_back({4, "after", [&](SQLite::Database&) { ++runs; }});
+    EXPECT_TRUE(migrator.Migrate(steps).empty());
+    EXPECT_EQ(migrator.CurrentVersion(), 2);
+    EXPECT_FALSE(db.tableExists("t3"));
+    EXPECT_EQ(runs, 2);
+}
+
+// CJK tokenizer: any substring of a Chinese name is a bigram phrase; script runs split
+TEST(CjkTokenizerTest, MatchesChineseSubstrings) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    ASSERT_TRUE(RegisterCjkTokenizer(db.getHandle()));
+    db.exec("CREATE VIRTUAL TABLE t USING fts5(name, tokenize='cjk')");
+    db.exec("INSERT INTO t(rowid, name) VALUES (1, '陈大伯'), (2, '王大妈，Chen'), (3, '大')");
+
+    auto count = [&](const std::string& match) {
+        SQLite::Statement q(db, "SELECT count(*) FROM t WHERE t MATCH ?");
+        q.bind(1, match);
+        q.executeStep();
+        return q.getColumn(0).getInt();
+    };
+    EXPECT_EQ(count("\"大伯\""), 1);
+    EXPECT_EQ(count("\"陈大伯\""), 1);
+    EXPECT_EQ(count("\"大\""), 3);
+    EXPECT_EQ(count("\"伯\""), 1);
+    EXPECT_EQ(count("\"陈伯\""), 0);  // not contiguous
+    EXPECT_EQ(count("\"妈\" \"chen\""), 1);
+
+    auto runs = SplitKeywordRuns("陈dabo-2，王大妈");
+    ASSERT_EQ(runs.size(), 4u);
+    EXPECT_EQ(runs[0].text, "陈");
+    EXPECT_TRUE(runs[0].cjk);
+    EXPECT_EQ(runs[1].text, "dabo");
+    EXPECT_FALSE(runs[1].cjk);
+    EXPECT_EQ(runs[2].text, "2");
+    EXPECT_EQ(runs[3].text, "王大妈");
+    EXPECT_TRUE(SplitKeywordRuns("，。!").empty());
+}
+
+// Search: FTS5 prefix match over name/aliases/bio ranked by bm25, CJK substrings included
+TEST_F(DatabaseManagerTest, SearchMembersRanksFullTextMatches) {
+    db_.SaveMember({.id = "1", .name = "Lin Mazu", .generation = 1});
+    db_.SaveMember({.id = "2", .name = "Wang", .generation = 2, .father_id = "1",
+                    .bio = "Kept the Mazu temple records"});
+    db_.SaveMember({.id = "3", .name = "Chen", .generation = 2, .aliases = "mazu-keeper",
+                    .father_id = "1"});
+    db_.SaveMember({.id = "4", .name = "陈大伯", .generation = 3, .father_id = "2"});
+
+    auto hits = db_.SearchMembers("maz");
+    ASSERT_EQ(hits.size(), 3u);
+    EXPECT_EQ(hits[0].id, "1");  // name hit outranks alias and bio hits
+    EXPECT_EQ(hits[1].id, "3");
+    EXPECT_EQ(hits[2].id, "2");
+    EXPECT_EQ(hits[2].father_name, "Lin Mazu");
+
+    EXPECT_EQ(db_.SearchMembers("temple").size(), 1u);
+    EXPECT_EQ(db_.SearchMembers("mazu", 1).size(), 1u);
+    EXPECT_TRUE(db_.SearchMembers("ma\"zu OR").empty());  // user input is never FTS syntax
+
+    auto cjk = db_.SearchMembers("大伯");
+    ASSERT_EQ(cjk.size(), 1u);
+    EXPECT_EQ(cjk[0].father_name, "Wang");
+    EXPECT_EQ(db_.SearchMembers("陈伯").size(), 0u);
+}
+
+// members_fts is not part of the migration chain: a database whose index was dropped gets
+// it rebuilt (triggers included) on the next Initialize
+TEST_F(DatabaseManagerTest, InitializeRepairsMembersFts) {
+    auto path = (dir_ / "fts.db").string();
+    db_.Initialize(path);
+    db_.SaveMember({.id = "1", .name = "陈大伯", .generation = 1});
+    db_.Initialize((dir_ / "other.db").string());  // releases fts.db
+
+    {
+        SQLite::Database raw(path, SQLite::OPEN_READWRITE);
+        ASSERT_TRUE(RegisterCjkTokenizer(raw.getHandle()));
+        raw.exec("DROP TRIGGER members_ai; DROP TRIGGER members_ad; DROP TRIGGER members_au;");
+        raw.exec("DROP TABLE members_fts;");
+    }
+
+    db_.Initialize(path);
+    EXPECT_EQ(db_.SearchMembers("大伯").size(), 1u);
+    db_.SaveMember({.id = "2", .name = "陈小妹", .generation = 2, .father_id = "1"});
+    EXPECT_EQ(db_.SearchMembers("小妹").size(), 1u);  // sync triggers are back
+}
+
+// Writers without the cjk tokenizer (sqlite3 CLI, scripts/init_db.py) drop the sync
+// triggers first; the next Initialize indexes what they wrote
+TEST_F(DatabaseManagerTest, ExternalWriterDropsFtsTriggers) {
+    auto path = (dir_ / "external.db").string();
+    db_.Initialize(path);
+    db_.SaveMember({.id = "1", .name = "陈大伯", .generation = 1});
+    db_.Initialize((dir_ / "other.db").string());
+
+    {
+        SQLite::Database raw(path, SQLite::OPEN_READWRITE);
+        EXPECT_THROW(raw.exec("UPDATE members SET bio = '勤劳' WHERE id = '1'"), SQLite::Exception);
+        raw.exec("DROP TRIGGER members_ai; DROP TRIGGER members_ad; DROP TRIGGER members_au;");
+        raw.exec("INSERT INTO members (id, name, generation) VALUES ('2', '陈小妹', 2)");
+    }
+
+    db_.Initialize(path);
+    EXPECT_EQ(db_.SearchMembers("小妹").size(), 1u);
+    EXPECT_EQ(db_.SearchMembers("大伯").size(), 1u);
+}
+
+// Reads use the pool only when it can exist; without it they share the writer connection
+// and still see every write
+TEST_F(DatabaseManagerTest, ReadsFallBackToWriterWithoutPool) {
+    auto path = (dir_ / "pool.db").string();
+
+    db_.Initialize(path, {.read_connections = 0});
+    EXPECT_EQ(db_.GetReadConnectionCount(), 0u);
+    db_.SaveMember({.id = "1", .name = "Writer Only", .generation = 1});
+    EXPECT_EQ(db_.GetAllMembers().size(), 1u);
+
+    db_.Initialize(":memory:");  // no WAL for in-memory databases
+    EXPECT_EQ(db_.GetReadConnectionCount(), 0u);
+    db_.SaveMember({.id = "m", .name = "In Memory", .generation = 1});
+    ASSERT_EQ(db_.GetAllMembers().size(), 1u);
+    EXPECT_EQ(db_.SearchMembers("memory").size(), 1u);
+
+    db_.Initialize(path, {.read_connections = 2});
+    EXPECT_EQ(db_.GetReadConnectionCount(), 2u);
+    db_.SaveMember({.id = "2", .name = "Pooled", .generation = 2, .father_id = "1"});
+    EXPECT_EQ(db_.GetAllMembers().size(), 2u);  // committed write visible to a pooled reader
+    EXPECT_EQ(db_.SearchMembers("pooled").size(), 1u);
+}
+
+// Repeated detail lookups come from the member cache; every write path updates or drops
+// the cached record
+TEST_F(DatabaseManagerTest, MemberDetailCacheFollowsWrites) {
+    db_.SaveMember({.id = "1", .name = "陈始祖", .bio = "first"});
+    auto before = db_.GetMemberCacheStats();
+    EXPECT_EQ(db_.GetMemberById("1").bio, "first");
+    EXPECT_EQ(db_.GetMemberById("1").bio, "first");
+    EXPECT_TRUE(db_.GetMemberById("missing").id.empty());
+    auto stats = db_.GetMemberCacheStats();
+    EXPECT_EQ(stats.hits - before.hits, 1u);
+    EXPECT_EQ(stats.misses - before.misses, 2u);  // absent ids are not cached
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, 0u);
+
+    db_.SaveMember({.id = "1", .name = "陈始祖", .bio = "edited"});
+    EXPECT_EQ(db_.GetMemberById("1").bio, "edited");
+    ASSERT_TRUE(db_.UpdateMemberPortrait("1", "media/p.jpg"));
+    auto patched = db_.GetMemberById("1");
+    EXPECT_EQ(patched.portrait_path, "media/p.jpg");
+    EXPECT_EQ(patched.bio, "edited");
+    ASSERT_TRUE(db_.DeleteMember("1"));
+    EXPECT_TRUE(db_.GetMemberById("1").id.empty());
+    EXPECT_EQ(db_.GetMemberCacheStats().entries, 0u);
+
+    // Reopening starts empty; with member_cache off every lookup queries SQLite
+    db_.SaveMember({.id = "2", .name = "陈二", .generation = 2});
+    db_.GetMemberById("2");
+    db_.Initialize((dir_ / "clan.db").string(), {.member_cache = false});
+    EXPECT_EQ(db_.GetMemberCacheStats().entries, 0u);
+    before = db_.GetMemberCacheStats();
+    EXPECT_EQ(db_.GetMemberById("2").name, "陈二");
+    EXPECT_EQ(db_.GetMemberById("2").name, "陈二");
+    stats = db_.GetMemberCacheStats();
+    EXPECT_EQ(stats.hits, before.hits);
+    EXPECT_EQ(stats.misses, before.misses);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+// Operation logs: concurrent appends arrive in per-producer order and in batches, Flush
+// waits for them, and stopping the writer commits what is still queued
+TEST_F(OperationLogWriterTest, BatchesAppendsAndFlushesOnStop) {
+    std::mutex mutex;
+    std::vector<std::vector<OperationLog>> batches;
+    auto record = [&](const std::vector<OperationLog>& batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(batch);
+        return true;
+    };
+
+    {
+        OperationLogWriter writer(
+            record, {.batch_size = 64, .max_delay = std::chrono::milliseconds(20)});
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&writer, t] {
+                for (int i = 0; i < 500; ++i) {
+                    writer.Append({.action = "UPDATE",
+                                   .target_type = "member",
+                                   .target_id = std::to_string(t),
+                                   .changes = std::to_string(i)});
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        writer.Flush();
+        auto stats = writer.stats();
+        EXPECT_EQ(stats.appended, 2000u);
+        EXPECT_EQ(stats.committed, 2000u);
+        EXPECT_LT(stats.batches, 2000u);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<int> next(4, 0);
+        for (const auto& batch : batches) {
+            for (const auto& log : batch) {
+                int& expected = next[std::stoi(log.target_id)];
+                EXPECT_EQ(log.changes, std::to_string(expected));
+                ++expected;
+                EXPECT_GT(log.created_at, 0);
+            }
+        }
+        EXPECT_EQ(next, std::vector<int>(4, 500));
+    }
+
+    batches.clear();
+    {
+        OperationLogWriter writer(record,
+                                  {.batch_size = 1000, .max_delay = std::chrono::hours(1)});
+        for (int i = 0; i < 3; ++i) {
+            writer.Append({.action = "CREATE", .target_type = "member"});
+        }
+        writer.Stop();
+        EXPECT_EQ(writer.stats().committed, 3u);
+        writer.Append({.action = "DELETE", .target_type = "member"});  // written inline
+        EXPECT_EQ(writer.stats().committed, 4u);
+    }
+
+    OperationLogWriter failing([](const std::vector<OperationLog>&) { return false; });
+    failing.Append({.action = "CREATE", .target_type = "member"});
+    failing.Flush();
+    EXPECT_EQ(failing.stats().dropped, 1u);
+
+    db_.AddOperationLog("UPDATE", "member", "m1", "陈始祖", "{}");
+    auto logs = db_.GetOperationLogs();
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(logs[0].target_name, "陈始祖");
+}
+
+// Field diffs: only changed columns, long text as a splice on code point boundaries,
+// lossless encoding, and a member rebuilt at any log id by undoing later diffs
+TEST_F(MemberDiffTest, EncodesChangedFieldsAndReplaysHistory) {
+    std::string bio = "生于福建老家，" + std::string(80, 'a') + "，迁居台北。";
+    Member v1{.id = "m1", .name = "陈大", .generation = 2, .bio = bio};
+    Member v2 = v1;
+    v2.name = "陈大伯";
+    v2.bio = "生于福建泉州，" + std::string(80, 'a') + "，迁居台北。";
+    v2.spouse_name = "林\"氏\"\n";
+
+    auto diff = DiffMembers(v1, v2);
+    ASSERT_EQ(diff.size(), 3u);
+    EXPECT_EQ(diff[0].column, MemberColumn::kName);
+    EXPECT_EQ(diff[2].column, MemberColumn::kBio);
+    EXPECT_TRUE(diff[2].splice);
+    EXPECT_EQ(diff[2].before, "老家");
+    EXPECT_EQ(diff[2].after, "泉州");
+    EXPECT_TRUE(DiffMembers(v1, v1).empty());
+
+    std::string encoded = EncodeMemberDiff(diff);
+    EXPECT_LT(encoded.size(), v2.bio.size());
+    auto decoded = DecodeMemberDiff(encoded);
+    ASSERT_TRUE(decoded.has_value());
+    Member replayed = v1;
+    ASSERT_TRUE(ApplyMemberDiff(replayed, *decoded));
+    EXPECT_EQ(replayed.bio, v2.bio);
+    EXPECT_EQ(replayed.spouse_name, v2.spouse_name);
+    ASSERT_TRUE(ApplyMemberDiff(replayed, *decoded, /*reverse=*/true));
+    EXPECT_EQ(replayed.name, v1.name);
+    EXPECT_EQ(replayed.bio, v1.bio);
+    EXPECT_FALSE(ApplyMemberDiff(replayed, *decoded, /*reverse=*/true));  // already undone
+    EXPECT_EQ(DecodeMemberDiff(R"({"name":["\u9648","\ud83d\ude00"]})")->at(0).after,
+              "\xF0\x9F\x98\x80");
+    EXPECT_FALSE(DecodeMemberDiff(R"({"id":"m1","name":"陈大"})").has_value());  // old format
+    EXPECT_FALSE(DecodeMemberDiff("").has_value());
+
+    auto logEntry = [&](const char* action, const Member& before, const Member& after) {
+        db_.AddOperationLog(action, "member", "m1", after.name,
+                            EncodeMemberDiff(DiffMembers(before, after)));
+        return db_.GetOperationLogs(1)[0].id;
+    };
+    db_.SaveMember(v1);
+    int created = logEntry("CREATE", Member{}, v1);
+    db_.SaveMember(v2);
+    int updated = logEntry("UPDATE", v1, v2);
+    db_.DeleteMember("m1");
+    int deleted = logEntry("DELETE", v2, Member{});
+
+    auto atCreate = db_.GetMemberAtLog("m1", created);
+    ASSERT_TRUE(atCreate.ok) << atCreate.error;
+    EXPECT_TRUE(atCreate.exists);
+    EXPECT_EQ(atCreate.member.bio, v1.bio);
+    EXPECT_EQ(atCreate.member.generation, 2);
+    auto atUpdate = db_.GetMemberAtLog("m1", updated);
+    ASSERT_TRUE(atUpdate.ok) << atUpdate.error;
+    EXPECT_EQ(atUpdate.member.name, "陈大伯");
+    EXPECT_EQ(atUpdate.member.spouse_name, v2.spouse_name);
+    EXPECT_FALSE(db_.GetMemberAtLog("m1", deleted).exists);
+    auto beforeCreate = db_.GetMemberAtLog("m1", created - 1);
+    EXPECT_TRUE(beforeCreate.ok);
+    EXPECT_FALSE(beforeCreate.exists);
+
+    db_.AddOperationLog("UPDATE", "member", "m1", "陈大伯", R"({"id":"m1"})");
+    EXPECT_FALSE(db_.GetMemberAtLog("m1", updated).ok);
+}
+
+// Keyset pages never repeat or skip an entry (ties on created_at included), filters use
+// their own index, and archived entries stay queryable
+TEST_F(DatabaseManagerTest, PagesFiltersAndArchivesOperationLogs) {
+    for (int i = 0; i < 7; ++i) {
+        db_.AddOperationLog(i % 2 ? "UPDATE" : "CREATE", "member",
+                            "m" + std::to_string(i % 3), "name", "{}");
+    }
+    db_.FlushOperationLogs();
+
+    std::vector<int> seen;
+    OperationLogQuery query;
+    query.limit = 3;
+    for (;;) {
+        auto page = db_.QueryOperationLogs(query);
+        for (const auto& log : page.logs) {
+            seen.push_back(log.id);
+        }
+        if (!page.has_more) {
+            break;
+        }
+        query.cursor_created_at = page.logs.back().created_at;
+        query.cursor_id = page.logs.back().id;
+    }
+    ASSERT_EQ(seen.size(), 7u);
+    EXPECT_TRUE(std::is_sorted(seen.rbegin(), seen.rend()));
+    EXPECT_EQ(std::set<int>(seen.begin(), seen.end()).size(), 7u);
+
+    OperationLogQuery updates;
+    updates.action = "UPDATE";
+    EXPECT_EQ(db_.QueryOperationLogs(updates).logs.size(), 3u);
+    OperationLogQuery target;
+    target.target_type = "member";
+    target.target_id = "m0";
+    auto m0 = db_.QueryOperationLogs(target);
+    ASSERT_EQ(m0.logs.size(), 3u);  // entries 0, 3, 6
+    EXPECT_EQ(m0.logs[0].target_id, "m0");
+    EXPECT_FALSE(m0.has_more);
+
+    auto count = db_.CountOperationLogs(updates);
+    EXPECT_TRUE(count.exact);
+    EXPECT_EQ(count.count, 3);
+    count = db_.CountOperationLogs(updates, /*cap=*/2);
+    EXPECT_FALSE(count.exact);
+    EXPECT_EQ(count.count, 2);
+    EXPECT_EQ(db_.CountOperationLogs({}).count, 7);
+
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+    EXPECT_EQ(db_.ArchiveOperationLogs(now + 1), 7);
+    EXPECT_TRUE(db_.QueryOperationLogs({}).logs.empty());
+    target.archived = true;
+    EXPECT_EQ(db_.QueryOperationLogs(target).logs.size(), 3u);
+    EXPECT_EQ(db_.ArchiveOperationLogs(now + 1), 0);
+}
+
+// Batch media import: files go through the parallel lanes, progress arrives once per file
+// and the rows land in batched transactions
+TEST_F(ResourceManagerTest, ImportFilesPipelinesCopiesAndCommitsInBatches) {
+    db_.SaveMember({.id = "m1", .name = "陈始祖"});
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 10; ++i) {
+        auto path = dir_ / ("clan_import_test_" + std::to_string(i) + ".jpg");
+        std::ofstream(path, std::ios::binary) << std::string(1000 + i, 'a' + i);
+        paths.push_back(path.string());
+    }
+    paths.push_back((dir_ / "missing.jpg").string());
+
+    std::atomic<int> thumbnails{0};
+    std::vector<size_t> progress;
+    MediaImportOptions options;
+    options.io_parallelism = 3;
+    options.commit_batch = 4;
+    options.after_copy = [&](const MediaResource&, const std::filesystem::path& stored) {
+        EXPECT_TRUE(std::filesystem::exists(stored));
+        ++thumbnails;
+    };
+    auto result = ResourceManager::instance().ImportFiles(
+        paths, "m1", "photo", [&](const MediaImportProgress& p) { progress.push_back(p.done); },
+        options);
+
+    ASSERT_EQ(result.imported.size(), 10u);
+    ASSERT_EQ(result.failed.size(), 1u);
+    EXPECT_EQ(result.failed[0].file, paths.back());
+    EXPECT_EQ(thumbnails.load(), 10);
+    ASSERT_EQ(progress.size(), 11u);
+    EXPECT_EQ(progress.back(), 11u);
+    std::set<std::string> ids;
+    for (size_t i = 0; i < result.imported.size(); ++i) {
+        EXPECT_EQ(result.imported[i].title, "clan_import_test_" + std::to_string(i));
+        ids.insert(result.imported[i].id);
+    }
+    EXPECT_EQ(ids.size(), 10u);
+    EXPECT_EQ(db_.GetMediaResources("m1", "photo").size(), 10u);
+    for (const auto& res : result.imported) {
+        EXPECT_TRUE(std::filesystem::exists(dir_ / res.file_path)) << res.file_path;
+    }
+}
+
+// XXH64 reference vectors, split-invariant streaming, and content-addressed media names:
+// same bytes share a file whatever the name, same name and size no longer collide
+TEST_F(ContentHashTest, MatchesXxh64AndNamesMediaByContent) {
+    EXPECT_EQ(ContentHashHex(Xxh64Hash("", 0)), "ef46db3751d8e999");
+    EXPECT_EQ(ContentHashHex(Xxh64Hash("abc", 3)), "44bc2cf5ad770999");
+    const std::string text = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(ContentHashHex(Xxh64Hash(text.data(), text.size())), "fbcea83c8a378bf1");
+    for (size_t split : {0, 1, 7, 31, 32, 33, 39}) {
+        Xxh64 hash;
+        hash.Update(text.data(), split);
+        hash.Update(text.data() + split, text.size() - split);
+        EXPECT_EQ(hash.Digest(), 0xfbcea83c8a378bf1ULL) << split;
+    }
+
+    std::filesystem::create_directories(dir_ / "a");
+    std::filesystem::create_directories(dir_ / "b");
+    std::ofstream(dir_ / "a" / "photo.jpg", std::ios::binary) << "first family photo";
+    std::ofstream(dir_ / "b" / "photo.jpg", std::ios::binary) << "other family photo";
+    std::ofstream(dir_ / "b" / "copy.jpg", std::ios::binary) << "first family photo";
+    EXPECT_EQ(HashFile(dir_ / "a" / "photo.jpg"), Xxh64Hash("first family photo", 18));
+    EXPECT_FALSE(HashFile(dir_ / "missing.jpg").has_value());
+    EXPECT_TRUE(SameFileContents(dir_ / "a" / "photo.jpg", dir_ / "b" / "copy.jpg"));
+    EXPECT_FALSE(SameFileContents(dir_ / "a" / "photo.jpg", dir_ / "b" / "photo.jpg"));
+
+    db_.SaveMember({.id = "m1", .name = "陈始祖"});
+
+    auto& resources = ResourceManager::instance();
+    auto first = resources.ImportFile((dir_ / "a" / "photo.jpg").string(), "m1", "photo");
+    auto other = resources.ImportFile((dir_ / "b" / "photo.jpg").string(), "m1", "photo");
+    auto copy = resources.ImportFile((dir_ / "b" / "copy.jpg").string(), "m1", "photo");
+    EXPECT_EQ(first.file_hash, ContentHashHex(Xxh64Hash("first family photo", 18)));
+    EXPECT_EQ(first.file_path, "media/" + first.file_hash + ".jpg");
+    EXPECT_NE(other.file_path, first.file_path);
+    EXPECT_EQ(copy.file_path, first.file_path);
+
+    // A different file already under the hash name (a collision) is never reused
+    auto media = resources.media_dir();
+    EXPECT_EQ(media, dir_ / "media");
+    std::ofstream(dir_ / "c.png", std::ios::binary) << "third";
+    std::string hash = ContentHashHex(Xxh64Hash("third", 5));
+    std::ofstream(media / (hash + ".png"), std::ios::binary) << "not the third";
+    auto collided = resources.ImportFile((dir_ / "c.png").string(), "m1", "photo");
+    EXPECT_EQ(collided.file_path, "media/" + hash + "-1.png");
+}
+
+// The copy hashes what it writes (across several copy chunks), never replaces an existing
+// file, and a stored import reports its size and ingest method
+TEST_F(FileIngestTest, CopiesAndHashesInOnePass) {
+    std::string video(20 * 1024 * 1024 + 5, '\0');
+    for (size_t i = 0; i < video.size(); ++i) {
+        video[i] = static_cast<char>((i * 131) ^ (i >> 12));
+    }
+    std::ofstream(dir_ / "video.mp4", std::ios::binary) << video;
+
+    std::string error;
+    auto copied = IngestFile(dir_ / "video.mp4", dir_ / "copy.mp4", {}, &error);
+    ASSERT_TRUE(copied.has_value()) << error;
+    EXPECT_EQ(copied->bytes, video.size());
+    EXPECT_EQ(copied->hash, Xxh64Hash(video.data(), video.size()));
+    EXPECT_TRUE(SameFileContents(dir_ / "video.mp4", dir_ / "copy.mp4"));
+
+    std::ofstream(dir_ / "other.mp4", std::ios::binary) << "other";
+    EXPECT_FALSE(IngestFile(dir_ / "other.mp4", dir_ / "copy.mp4", {}, &error).has_value());
+    EXPECT_FALSE(error.empty());
+    EXPECT_TRUE(SameFileContents(dir_ / "video.mp4", dir_ / "copy.mp4"));
+    EXPECT_FALSE(IngestFile(dir_ / "missing.mp4", dir_ / "none.mp4").has_value());
+    EXPECT_FALSE(std::filesystem::exists(dir_ / "none.mp4"));
+
+    auto linked = IngestFile(dir_ / "video.mp4", dir_ / "link.mp4", {.allow_hardlink = true});
+    ASSERT_TRUE(linked.has_value());
+    EXPECT_TRUE(linked->method == IngestMethod::kReflink ||
+                linked->method == IngestMethod::kHardlink);
+    EXPECT_EQ(linked->hash, copied->hash);
+
+    std::ofstream(dir_ / "empty.txt", std::ios::binary);
+    auto empty = IngestFile(dir_ / "empty.txt", dir_ / "empty-copy.txt");
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty->bytes, 0u);
+    EXPECT_EQ(empty->hash, Xxh64Hash("", 0));
+
+    db_.SaveMember({.id = "m1", .name = "陈始祖"});
+    auto& resources = ResourceManager::instance();
+    MediaIngest first, second;
+    auto res = resources.ImportFile((dir_ / "video.mp4").string(), "m1", "video", &first);
+    resources.ImportFile((dir_ / "copy.mp4").string(), "m1", "video", &second);
+    EXPECT_EQ(res.file_hash, ContentHashHex(copied->hash));
+    EXPECT_EQ(res.file_size, static_cast<long long>(video.size()));
+    EXPECT_EQ(first.bytes, video.size());
+    EXPECT_FALSE(first.deduplicated);
+    EXPECT_TRUE(second.deduplicated);
+    EXPECT_TRUE(SameFileContents(dir_ / "video.mp4", first.stored));
+
+    EXPECT_EQ(first.stored.parent_path(), dir_ / "media");
+    for (const auto& entry : std::filesystem::directory_iterator(dir_ / "media")) {
+        EXPECT_NE(entry.path().extension(), ".part") << entry.path();
+    }
+}
+
+// Exact repeats hit the cache, a typed-ahead keyword filters the cached prefix rows, and
+// concurrent identical queries run once
+TEST(SearchCacheTest, RefinesPrefixesAndSharesInflightQueries) {
+    std::vector<Member> rows = {
+        {.id = "1", .name = "陈大伯"},
+        {.id = "2", .name = "陈大", .bio = "Dabo's brother"},
+        {.id = "3", .name = "Lin", .aliases = "dabo-keeper"},
+    };
+    std::atomic<int> calls{0};
+    auto query = [&] {
+        ++calls;
+        return SearchCache::Result{rows, true};
+    };
+
+    SearchCache cache;
+    EXPECT_EQ(cache.Search({"陈大"}, 10, 1, query)->members.size(), 3u);
+    EXPECT_EQ(cache.Search({"陈大"}, 10, 1, query)->members.size(), 3u);
+    auto refined = cache.Search({"陈大伯"}, 10, 1, query);
+    ASSERT_EQ(refined->members.size(), 1u);
+    EXPECT_EQ(refined->members[0].id, "1");
+    EXPECT_EQ(cache.Search({"陈大"}, 10, 2, query)->members.size(), 3u);  // new revision
+
+    cache.Search({"da"}, 10, 1, query);
+    auto words = cache.Search({"DABO"}, 10, 1, query);  // case-insensitive word prefix
+    ASSERT_EQ(words->members.size(), 2u);
+    EXPECT_EQ(words->members[0].id, "2");
+    EXPECT_EQ(cache.Search({"da"}, 3, 1, query)->members.size(), 3u);
+    EXPECT_EQ(cache.Search({"dab"}, 3, 1, query)->members.size(), 3u);  // prefix hit the limit
+    EXPECT_EQ(calls.load(), 5);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.executed, 5u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.refined, 2u);
+
+    // A query running on another thread is joined rather than repeated
+    std::promise<void> started, release;
+    auto slow = [&] {
+        ++calls;
+        started.set_value();
+        release.get_future().wait();
+        return SearchCache::Result{rows, true};
+    };
+    auto first = std::async(std::launch::async, [&] { return cache.Search({"林"}, 10, 1, slow); });
+    started.get_future().wait();
+    auto second = std::async(std::launch::async, [&] { return cache.Search({"林"}, 10, 1, slow); });
+    while (cache.stats().shared == 0) {
+        std::this_thread::yield();
+    }
+    release.set_value();
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(calls.load(), 6);
+
+    EXPECT_TRUE(MatchesFtsKeyword(rows[2], "KEEP"));
+    EXPECT_FALSE(MatchesFtsKeyword(rows[2], "eeper"));  // word runs match as prefixes only
+    EXPECT_TRUE(MatchesFtsKeyword(rows[0], "大伯"));
+    EXPECT_FALSE(MatchesFtsKeyword(rows[0], "陈伯"));
+}
+
+// Bulk import: one transaction, UPSERT by id, FatherName resolved in both directions,
+// search index rebuilt and its triggers restored
+TEST_F(DatabaseManagerTest, ImportMembersFromCsv) {
+    db_.SaveMember({.id = "root", .name = "陈始祖", .generation = 1, .bio = "old bio"});
+
+    std::istringstream csv(
+        "\xEF\xBB\xBFId,Name,Gender,Generation,FatherName,Bio\n"
+        "root,陈始祖,M,1,,\"家族始祖，\"\"渡海\"\"来台。\"\n"
+        ",陈三孙,M,3,陈大伯,\"第一行\n第二行\"\n"
+        ",陈大伯,M,2,陈始祖,勤劳耕作\n"
+        "\n"
+        ",,M,2,,no name\n"
+        ",陈孤儿,F,2,无名氏,\n");
+    CsvMemberSource source(csv);
+    size_t indexingEvents = 0;
+    auto result = db_.ImportMembers(source, [&](const ImportProgress& p) {
+        indexingEvents += p.indexing ? 1 : 0;
+    });
+
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.imported, 4u);
+    EXPECT_EQ(result.skipped, 1u);
+    EXPECT_EQ(result.unresolved_fathers, 1u);
+    EXPECT_EQ(indexingEvents, 1u);
+
+    EXPECT_EQ(db_.GetMemberById("root").bio, "家族始祖，\"渡海\"来台。");  // upserted
+    auto elder = db_.SearchMembers("大伯");
+    ASSERT_EQ(elder.size(), 1u);
+    EXPECT_EQ(elder[0].father_id, "root");
+    auto grandson = db_.SearchMembers("三孙");
+    ASSERT_EQ(grandson.size(), 1u);
+    EXPECT_EQ(grandson[0].father_id, elder[0].id);  // forward reference
+    EXPECT_EQ(grandson[0].bio, "第一行\n第二行");
+    EXPECT_EQ(db_.GetDescendants("root").size(), 2u);
+
+    db_.SaveMember({.id = "late", .name = "陈后来"});  // FTS triggers are back
+    EXPECT_EQ(db_.SearchMembers("后来").size(), 1u);
+
+    // Edits made in the app to columns the file does not have (portrait, aliases, mother)
+    // survive a re-import; columns it has are taken from the file again
+    Member edited = db_.GetMemberById(elder[0].id);
+    edited.aliases = "大伯公";
+    edited.mother_id = "late";
+    edited.bio = "edited in the app";
+    db_.SaveMember(edited);
+    ASSERT_TRUE(db_.UpdateMemberPortrait(elder[0].id, "media/elder.jpg"));
+
+    // Re-import without ids: rows match existing members by name and father
+    csv.clear();
+    csv.seekg(0);
+    CsvMemberSource again(csv);
+    result = db_.ImportMembers(again);
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.imported, 4u);
+    EXPECT_EQ(result.matched, 3u);  // every id-less row, the unresolved orphan included
+    EXPECT_EQ(db_.SearchMembers("大伯")[0].id, elder[0].id);
+    EXPECT_EQ(db_.SearchMembers("三孙")[0].id, grandson[0].id);
+    EXPECT_EQ(db_.GetAllMembers().size(), 5u);  // root, 大伯, 三孙, 孤儿, 后来
+    auto reimported = db_.GetMemberById(elder[0].id);
+    EXPECT_EQ(reimported.portrait_path, "media/elder.jpg");
+    EXPECT_EQ(reimported.aliases, "大伯公");
+    EXPECT_EQ(reimported.mother_id, "late");
+    EXPECT_EQ(reimported.bio, "勤劳耕作");
+
+    std::istringstream gedcom(
+        "0 HEAD\n"
+        "0 @I1@ INDI\n1 NAME /陈/始祖\n1 SEX M\n1 BIRT\n2 DATE 1 JAN 1880\n2 PLAC 泉州\n"
+        "1 NOTE 家族始祖\n2 CONT 渡海来台\n"
+        "0 @I2@ INDI\n1 NAME John /Chen/\n1 SEX M\n1 FAMC @F1@\n1 DEAT\n2 DATE ABT 1950\n"
+        "0 @I3@ INDI\n1 NAME 李氏\n1 SEX F\n"
+        "0 @F1@ FAM\n1 HUSB @I1@\n1 WIFE @I3@\n1 CHIL @I2@\n0 TRLR\n");
+    GedcomMemberSource ged(gedcom, "a.ged:");
+    ImportRecord r;
+    ASSERT_TRUE(ged.Next(r));
+    EXPECT_EQ(r.member.id, "a.ged:I1");
+    EXPECT_EQ(r.member.name, "陈始祖");
+    EXPECT_EQ(r.member.birth_date, "1880-01-01");
+    EXPECT_EQ(r.member.birth_place, "泉州");
+    EXPECT_EQ(r.member.bio, "家族始祖\n渡海来台");
+    EXPECT_FALSE(r.columns & kImportPortrait);
+    ASSERT_TRUE(ged.Next(r));
+    EXPECT_EQ(r.member.name, "John Chen");
+    EXPECT_EQ(r.member.father_id, "a.ged:I1");
+    EXPECT_EQ(r.member.mother_id, "a.ged:I3");
+    EXPECT_EQ(r.member.generation, 2);
+    EXPECT_EQ(r.member.death_date, "ABT 1950");
+    ASSERT_TRUE(ged.Next(r));
+    EXPECT_FALSE(ged.Next(r));
+
+    // Xrefs only identify individuals within one file: another file gets its own members,
+    // the same file updates its own
+    for (const char* prefix : {"a.ged:", "b.ged:", "a.ged:"}) {
+        gedcom.clear();
+        gedcom.seekg(0);
+        GedcomMemberSource source(gedcom, prefix);
+        ASSERT_TRUE(db_.ImportMembers(source).ok);
+    }
+    EXPECT_EQ(db_.GetAllMembers().size(), 11u);
+    EXPECT_EQ(db_.GetMemberById("b.ged:I2").father_id, "b.ged:I1");
+}
+
+// Viewer ring: lines come out in order, a full ring drops (and counts) new lines instead
+// of blocking, long lines are cut on a UTF-8 boundary, and concurrent producers lose
+// nothing while the consumer keeps up
+TEST(LogRingTest, DrainsInOrderAndDropsWhenFull) {
+    LogRing ring(5);
+    ASSERT_EQ(ring.capacity(), 8u);
+    for (int i = 0; i < 10; ++i) {
+        ring.Push(i, 0, spdlog::level::info, std::to_string(i));
+    }
+    EXPECT_EQ(ring.dropped(), 2u);
+    std::string seen;
+    EXPECT_EQ(ring.Drain([&](const LogLine& line) { seen += line.view(); }, 3), 3u);
+    EXPECT_EQ(ring.Drain([&](const LogLine& line) { seen += line.view(); }), 5u);
+    EXPECT_EQ(seen, "01234567");
+
+    std::string text(LogLine::kMaxText - 1, 'a');
+    text += "陈";
+    ring.Push(0, 0, spdlog::level::warn, text);
+    ring.Drain([&](const LogLine& line) {
+        EXPECT_TRUE(line.truncated);
+        EXPECT_EQ(line.length, LogLine::kMaxText - 1);
+        EXPECT_EQ(line.level, spdlog::level::warn);
+    });
+
+    // Through a logger: the sink keeps the bare message, not the pattern
+    auto shared = std::make_shared<LogRing>(1024);
+    spdlog::logger logger("ring_test", std::make_shared<LogRingSink>(shared));
+    logger.info("member {} saved", 42);
+    std::string message;
+    shared->Drain([&](const LogLine& line) { message = line.view(); });
+    EXPECT_EQ(message, "member 42 saved");
+
+    // Producers retry when the ring is full, so every line must arrive, in per-thread order
+    constexpr int kThreads = 4, kPerThread = 20000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&shared, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                std::string text = std::to_string(t) + ":" + std::to_string(i);
+                while (!shared->Push(0, t, spdlog::level::info, text)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<int> next(kThreads, 0);
+    size_t received = 0;
+    bool ordered = true;
+    while (received < static_cast<size_t>(kThreads * kPerThread)) {
+        received += shared->Drain([&](const LogLine& line) {
+            auto text = line.view();
+            int t = text[0] - '0';
+            ordered = ordered && std::to_string(next[t]++) == text.substr(2);
+        });
+    }
+    for (auto& p : producers) {
+        p.join();
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(shared->Drain([](const LogLine&) {}), 0u);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsedWithinCost) {
+    LruCache<std::string, std::string> cache(10, [](const std::string& v) { return v.size(); });
+    cache.Put("a", "1234");
+    cache.Put("b", "1234");
+    ASSERT_TRUE(cache.Get("a"));  // b is now the coldest
+    cache.Put("c", "1234");
+    EXPECT_FALSE(cache.Get("b"));
+    EXPECT_EQ(*cache.Get("a"), "1234");
+    EXPECT_EQ(cache.cost(), 8u);
+
+    cache.Put("a", "12");  // replacing updates the cost
+    EXPECT_EQ(cache.cost(), 6u);
+    cache.Put("huge", std::string(11, 'x'));  // larger than the budget: not stored
+    EXPECT_FALSE(cache.Get("huge"));
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(ThumbnailCacheTest, EncodesOncePerSourceVersionAndTier) {
+    EnsureTestLog();
+    auto dir = std::filesystem::temp_directory_path() / "clan_thumb_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto source = dir / "portrait.png";
+    std::ofstream(source) << "v1";
+
+    int encodes = 0;
+    auto encoder = [&](const std::filesystem::path& path, int width) {
+        ++encodes;
+        std::ifstream in(path);
+        std::string content((std::istreambuf_iterator<char>(in)), {});
+        return content + "@" + std::to_string(width);
+    };
+
+    {
+        ThumbnailCache cache(dir / "thumbs", 1024);
+        EXPECT_EQ(ThumbnailCache::SizeTier(100), 128);
+        EXPECT_EQ(ThumbnailCache::SizeTier(2000), 500);
+        EXPECT_EQ(*cache.Get(source, 100, encoder), "v1@128");
+        EXPECT_EQ(*cache.Get(source, 128, encoder), "v1@128");  // memory hit, same tier
+        EXPECT_EQ(*cache.Get(source, 64, encoder), "v1@64");
+        EXPECT_EQ(encodes, 2);
+        EXPECT_EQ(cache.stats().memory_hits, 1u);
+        EXPECT_EQ(cache.Get(dir / "missing.png", 64, encoder), nullptr);
+    }
+
+    // A new instance finds the thumbnails on disk
+    ThumbnailCache cache(dir / "thumbs", 1024);
+    EXPECT_EQ(*cache.Get(source, 64, encoder), "v1@64");
+    EXPECT_EQ(encodes, 2);
+    EXPECT_EQ(cache.stats().disk_hits, 1u);
+
+    // Replacing the source changes its key, and the old version's tiers go
+    std::ofstream(source) << "v2-longer";
+    EXPECT_EQ(*cache.Get(source, 64, encoder), "v2-longer@64");
+    EXPECT_EQ(encodes, 3);
+    auto thumbFiles = [&] {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir / "thumbs")) {
+            count += entry.is_regular_file() ? 1 : 0;
+        }
+        return count;
+    };
+    EXPECT_EQ(thumbFiles(), 1u);
+    EXPECT_EQ(cache.stats().disk_bytes, std::string("v2-longer@64").size());
+
+    // Past the disk budget the least recently used files are removed
+    ThumbnailCache small(dir / "small", 1024, 40);
+    for (int i = 0; i < 6; ++i) {
+        auto other = dir / ("other" + std::to_string(i) + ".png");
+        std::ofstream(other) << "photo-" << i;
+        EXPECT_EQ(*small.Get(other, 64, encoder), "photo-" + std::to_string(i) + "@64");
+    }
+    EXPECT_LE(small.stats().disk_bytes, 40u);
+    EXPECT_GT(small.stats().disk_bytes, 0u);
+    ThumbnailCache reopened(dir / "small", 1024, 40);
+    EXPECT_EQ(reopened.stats().disk_bytes, small.stats().disk_bytes);
+    EXPECT_EQ(*reopened.Get(dir / "other5.png", 64, encoder), "photo-5@64");
+    EXPECT_EQ(reopened.stats().disk_hits, 1u);  // the newest file survived
+    std::filesystem::remove_all(dir);
+}
+
+// Loopback media endpoint: full and ranged reads, ETag revalidation, no way out of the root
+TEST(MediaServerTest, ServesRangesAndRevalidates) {
+    EnsureTestLog();
+    auto dir = std::filesystem::temp_directory_path() / "clan_media_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "root" / "media");
+    std::ofstream(dir / "root" / "media" / "clip.mp4", std::ios::binary) << "0123456789";
+    std::ofstream(dir / "secret.txt") << "outside the root";
+
+    auto& server = MediaServer::instance();
+    ASSERT_TRUE(server.Start(dir / "root", {}));
+    std::string url = server.MediaUrl("media/clip.mp4");
+    std::string path = url.substr(url.find('/', std::strlen("http://")));
+    std::string token = path.substr(0, path.find("/file/"));
+
+    httplib::Client cli("127.0.0.1", server.port());
+    auto full = cli.Get(path);
+    ASSERT_TRUE(full);
+    EXPECT_EQ(full->status, 200);
+    EXPECT_EQ(full->body, "0123456789");
+
+    auto ranged = cli.Get(path, {{"Range", "bytes=2-5"}});
+    ASSERT_TRUE(ranged);
+    EXPECT_EQ(ranged->status, 206);
+    EXPECT_EQ(ranged->body, "2345");
+
+    auto cached = cli.Get(path, {{"If-None-Match", full->get_header_value("ETag")}});
+    ASSERT_TRUE(cached);
+    EXPECT_EQ(cached->status, 304);
+
+    auto escape = cli.Get(token + "/file/..%2Fsecret.txt");
+    ASSERT_TRUE(escape);
+    EXPECT_GE(escape->status, 400);
+    auto guessed = cli.Get("/0000/file/media/clip.mp4");
+    ASSERT_TRUE(guessed);
+    EXPECT_EQ(guessed->status, 404);
+
+    server.Stop();
+    EXPECT_TRUE(server.MediaUrl("media/clip.mp4").empty());
+}
@@ -19,6 +19,7 @@ function App() {
     setSelectedMember,
     avatarSrc,
     fetchMemberDetail,
+    expandMember,
     updateMemberPortrait,
   } = useClanBridge();
 
@@ -39,6 +40,9 @@ function App() {
   const [showSearchResults, setShowSearchResults] = useState(false);
 
   const treeRef = useRef<ClanTreeHandle>(null);
+  // Id of the latest search sent through the bridge; older answers are ignored
+  const searchSeqRef = useRef(0);
+  const searchRequestRef = useRef<string | null>(null);
 
   // Fetch generation names when admin mode enters
   useEffect(() => {
@@ -63,12 +67,17 @@ function App() {
     };
   }, []);
 
-  const handleNodeClick = (id: string) => fetchMemberDetail(id);
+  const handleNodeClick = (id: string) => {
+    fetchMemberDetail(id);
+    expandMember(id);
+  };
 
   // Define callback interface for global window object
   useEffect(() => {
     // @ts-ignore
-    window.onSearchResultsReceived = (results: any) => {
+    window.onSearchResultsReceived = (results: any, requestId?: string) => {
+        // A newer search is in flight: this answer is stale
+        if (requestId !== undefined && requestId !== searchRequestRef.current) return;
         console.log("Async search results received:", results);
         if (results && results.length > 0) {
             if (results.length === 1) {
@@ -100,7 +109,10 @@ function App() {
     if (window.CallBridge) {
         console.log("Invoking searchMembers:", text);
         try {
-            window.CallBridge.invoke("searchMembers", text);
+            // Tagged request: the backend drops older searches still in flight
+            const requestId = `search-${++searchSeqRef.current}`;
+            searchRequestRef.current = requestId;
+            window.CallBridge.invoke("request", requestId, "searchMembers", text);
             // Result will be handled by window.onSearchResultsReceived
         } catch (e) {
             console.error("Search invoke failed:", e);
@@ -202,6 +214,7 @@ function App() {
         mediaList={media.mediaList}
         currentUrl={media.currentMediaUrl}
         isUploading={media.isUploading}
+        uploadProgress={media.uploadProgress}
         audioState={media.audioState}
         actions={{
           close: media.actions.closeMedia,
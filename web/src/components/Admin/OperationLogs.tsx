@@ -1,5 +1,6 @@
 import React, { useEffect, useState } from 'react';
 import './OperationLogs.css';
+import type { OperationLogPage, OperationLogQuery } from '../../types';
 
 interface LogEntry {
   id: number;
@@ -19,26 +20,47 @@ interface OperationLogsProps {
 export const OperationLogs: React.FC<OperationLogsProps> = ({ isOpen, onClose }) => {
   const [logs, setLogs] = useState<LogEntry[]>([]);
   const [loading, setLoading] = useState(false);
+  const [loadingMore, setLoadingMore] = useState(false);
+  const [hasMore, setHasMore] = useState(false);
+  const [total, setTotal] = useState<{ count: number; exact: boolean } | null>(null);
+  const [action, setAction] = useState("");
 
   useEffect(() => {
     if (isOpen) {
       fetchLogs();
     }
-  }, [isOpen]);
+  }, [isOpen, action]);
 
-  const fetchLogs = () => {
-    setLoading(true);
-    if (window.CallBridge) {
-        window.onOperationLogsReceived = (data: LogEntry[]) => {
-             setLoading(false);
-             if (Array.isArray(data)) {
-                 setLogs(data);
-             }
-        };
-        window.CallBridge.invoke("getOperationLogs", 100, 0);
+  // 游标分页：下一页从当前最后一条之后开始，不用 offset
+  const fetchLogs = (after?: LogEntry) => {
+    if (!window.CallBridge) {
+      return;
+    }
+    if (after) {
+      setLoadingMore(true);
     } else {
-        setLoading(false);
+      setLoading(true);
+    }
+    window.onOperationLogPageReceived = (page: OperationLogPage) => {
+      setLoading(false);
+      setLoadingMore(false);
+      if (!page || !Array.isArray(page.logs)) {
+        return;
+      }
+      setLogs(prev => (after ? [...prev, ...page.logs] : page.logs));
+      setHasMore(page.hasMore);
+      if (page.total !== undefined) {
+        setTotal({ count: page.total, exact: page.totalExact ?? false });
+      }
+    };
+    const query: OperationLogQuery = { limit: 100 };
+    if (action) {
+      query.action = action;
     }
+    if (after) {
+      query.before = { createdAt: after.createdAt, id: after.id };
+    }
+    window.CallBridge.invoke("queryOperationLogs", JSON.stringify(query));
   };
 
   const formatDate = (ts: number) => {
@@ -71,6 +93,16 @@ export const OperationLogs: React.FC<OperationLogsProps> = ({ isOpen, onClose })
              <button className="export-btn" onClick={exportJSON} title="导出 JSON">
                 💾
              </button>
+             <select className="logs-filter" value={action} onChange={e => setAction(e.target.value)}>
+               <option value="">全部操作</option>
+               <option value="CREATE">CREATE</option>
+               <option value="UPDATE">UPDATE</option>
+               <option value="DELETE">DELETE</option>
+               <option value="IMPORT">IMPORT</option>
+             </select>
+             {total && (
+               <span className="logs-total">共 {total.count}{total.exact ? "" : "+"} 条</span>
+             )}
            </div>
            <button className="close-btn" onClick={onClose}>✕</button>
         </div>
@@ -106,6 +138,15 @@ export const OperationLogs: React.FC<OperationLogsProps> = ({ isOpen, onClose })
                     </tbody>
                 </table>
             )}
+            {!loading && hasMore && (
+              <button
+                className="load-more-btn"
+                disabled={loadingMore}
+                onClick={() => fetchLogs(logs[logs.length - 1])}
+              >
+                {loadingMore ? "加载中..." : "加载更多"}
+              </button>
+            )}
         </div>
       </div>
     </div>
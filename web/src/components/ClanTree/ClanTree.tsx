@@ -186,7 +186,11 @@ const ClanTree = forwardRef<ClanTreeHandle, ClanTreeProps>(
               const isMale = d.gender === "M";
 
               const rawPath = d.portraitPath || (d as any).portrait_path;
-              const imageUrl = getAvatarUrl(rawPath);
+              // Prefer the 64px thumbnail served by the app over the full-size file
+              const imageUrl = d.avatarUrl || getAvatarUrl(rawPath);
+              // Paged tree: children not loaded yet (clicking the node loads them)
+              const hiddenChildren =
+                (d.childCount ?? 0) - (node.children?.length ?? 0);
 
               return (
                 <g
@@ -311,6 +315,17 @@ const ClanTree = forwardRef<ClanTreeHandle, ClanTreeProps>(
                         >
                           {d.generation}世 · {d.generationName}字辈
                         </div>
+                        {hiddenChildren > 0 && (
+                          <div
+                            style={{
+                              fontSize: "11px",
+                              color: "var(--gold)",
+                              marginTop: "4px",
+                            }}
+                          >
+                            +{hiddenChildren} 子嗣
+                          </div>
+                        )}
                       </div>
                     </div>
                   </foreignObject>
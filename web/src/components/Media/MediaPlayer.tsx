@@ -1,5 +1,5 @@
 import React, { useState, useEffect, useRef } from "react";
-import type { MediaItem } from "../../types";
+import type { MediaItem, ResourceImportProgress } from "../../types";
 import "./MediaPlayer.css";
 
 interface MediaPlayerProps {
@@ -8,6 +8,7 @@ interface MediaPlayerProps {
   mediaList: MediaItem[];
   currentUrl: string;
   isUploading: boolean;
+  uploadProgress?: ResourceImportProgress | null;
   audioState: {
     isPlaying: boolean;
     progress: number;
@@ -39,6 +40,7 @@ const MediaPlayer: React.FC<MediaPlayerProps> = ({
   mediaList,
   currentUrl,
   isUploading,
+  uploadProgress = null,
   audioState,
   actions,
   avatarSrc,
@@ -208,6 +210,11 @@ const MediaPlayer: React.FC<MediaPlayerProps> = ({
               disabled={isUploading}
             >
               <span className="upload-icon">{isUploading ? "⏳" : "➕"}</span>
+              {uploadProgress && (
+                <span>
+                  {uploadProgress.done}/{uploadProgress.total}
+                </span>
+              )}
               <span>上传{isVideo ? "视频" : "录音"}</span>
             </button>
           )}
@@ -532,8 +539,18 @@ const MediaPlayer: React.FC<MediaPlayerProps> = ({
 
             <div className="photo-strip">
               {isAdminMode && (
-                <button className="strip-upload-btn" onClick={actions.upload}>
-                  <span>+</span>
+                <button
+                  className="strip-upload-btn"
+                  onClick={actions.upload}
+                  disabled={isUploading}
+                >
+                  <span>
+                    {uploadProgress
+                      ? `${uploadProgress.done}/${uploadProgress.total}`
+                      : isUploading
+                        ? "⏳"
+                        : "+"}
+                  </span>
                 </button>
               )}
               <div className="strip-scroll">
@@ -545,7 +562,7 @@ const MediaPlayer: React.FC<MediaPlayerProps> = ({
                     }`}
                     onClick={() => actions.select(item.url)}
                   >
-                    <img src={item.url} alt="" />
+                    <img src={item.thumbUrl || item.url} alt="" loading="lazy" />
                   </div>
                 ))}
               </div>
@@ -1,5 +1,130 @@
-import { useState, useEffect } from "react";
-import type { FamilyMember } from "../types"; // [Fix] type import
+import { useState, useEffect, useRef } from "react";
+import type { FamilyMember, TreeDelta, TreePage } from "../types"; // [Fix] type import
+
+// Paged tree: the first screen is the roots down a few generations, the rest is loaded
+// when a node is expanded, so opening a huge clan costs the same as a small one.
+const INITIAL_DEPTH = 3;
+const INITIAL_LIMIT = 2000;
+const CHILD_PAGE = 500;
+
+const adjustChildCount = (
+  byId: Map<string, FamilyMember>,
+  parentId: string | undefined,
+  by: number
+) => {
+  const parent = parentId ? byId.get(parentId) : undefined;
+  if (parent) {
+    byId.set(parent.id, { ...parent, childCount: Math.max(0, (parent.childCount ?? 0) + by) });
+  }
+};
+
+// Apply an incremental tree delta (add/update/remove) to the loaded part of the tree.
+// Nodes whose parent is not loaded are skipped; expanding the parent fetches them.
+const applyTreeDelta = (data: FamilyMember[], delta: TreeDelta): FamilyMember[] => {
+  const byId = new Map(data.map((m) => [m.id, m]));
+  for (const change of delta.changes) {
+    if (change.op === "remove") {
+      const removed = byId.get(change.id);
+      if (removed) {
+        byId.delete(change.id);
+        adjustChildCount(byId, removed.parentId, -1);
+      }
+    } else {
+      const node = change.node;
+      const current = byId.get(node.id);
+      if (!current && node.parentId && !byId.has(node.parentId)) continue;
+      if (current?.parentId !== node.parentId) {
+        adjustChildCount(byId, current?.parentId, -1);
+        adjustChildCount(byId, node.parentId, +1);
+      }
+      // Keep fields the delta does not carry (e.g. bio loaded by detail view)
+      byId.set(node.id, { ...current, ...node });
+    }
+  }
+  return Array.from(byId.values());
+};
+
+// Merge a page into the loaded nodes; page nodes are at least as new as ours.
+const mergeTreePage = (data: FamilyMember[], page: TreePage): FamilyMember[] => {
+  const byId = new Map(data.map((m) => [m.id, m]));
+  for (const node of page.nodes) {
+    byId.set(node.id, { ...byId.get(node.id), ...node });
+  }
+  return Array.from(byId.values());
+};
+
+// Decoder for the binary tree snapshot written by core/json/tree_snapshot.cc. Sections
+// are 4-byte aligned little-endian arrays, viewed in place as typed arrays.
+const SNAPSHOT_MAGIC = 0x31535443; // "CTS1"
+const SNAPSHOT_VERSION = 1;
+const SNAPSHOT_GENDERS = ["", "M", "F"];
+
+export const decodeTreeSnapshot = (
+  buffer: ArrayBuffer
+): { revision: number; members: FamilyMember[] } => {
+  const header = new Uint32Array(buffer, 0, 6);
+  if (header[0] !== SNAPSHOT_MAGIC || header[1] !== SNAPSHOT_VERSION) {
+    throw new Error("Unsupported tree snapshot");
+  }
+  const count = header[2];
+  const stringCount = header[3];
+  const revision = header[4] + header[5] * 2 ** 32;
+
+  let offset = 24;
+  const int32Column = () => {
+    const column = new Int32Array(buffer, offset, count);
+    offset += 4 * count;
+    return column;
+  };
+  const uint32Column = () => {
+    const column = new Uint32Array(buffer, offset, count);
+    offset += 4 * count;
+    return column;
+  };
+  const parent = int32Column();
+  const generation = int32Column();
+  const gender = new Uint8Array(buffer, offset, count);
+  offset += (count + 3) & ~3;
+  const ids = uint32Column();
+  const names = uint32Column();
+  const generationNames = uint32Column();
+  const spouseNames = uint32Column();
+  const portraitPaths = uint32Column();
+  const lifeSpans = uint32Column();
+  const avatarUrls = uint32Column();
+  const stringOffsets = new Uint32Array(buffer, offset, stringCount + 1);
+  offset += 4 * (stringCount + 1);
+  const blob = new Uint8Array(buffer, offset);
+
+  const decoder = new TextDecoder();
+  const strings = new Array<string>(stringCount);
+  for (let i = 0; i < stringCount; i++) {
+    strings[i] = decoder.decode(blob.subarray(stringOffsets[i], stringOffsets[i + 1]));
+  }
+
+  const childCount = new Uint32Array(count);
+  for (let i = 0; i < count; i++) {
+    if (parent[i] >= 0) childCount[parent[i]]++;
+  }
+
+  const members = new Array<FamilyMember>(count);
+  for (let i = 0; i < count; i++) {
+    members[i] = {
+      id: strings[ids[i]],
+      name: strings[names[i]],
+      parentId: parent[i] >= 0 ? strings[ids[parent[i]]] : "",
+      generation: generation[i],
+      generationName: strings[generationNames[i]],
+      spouseName: strings[spouseNames[i]],
+      gender: SNAPSHOT_GENDERS[gender[i]],
+      portraitPath: strings[portraitPaths[i]],
+      lifeSpan: strings[lifeSpans[i]],
+      avatarUrl: strings[avatarUrls[i]] || undefined,
+      childCount: childCount[i],
+    };
+  }
+  return { revision, members };
+};
 
 export const useClanBridge = () => {
   const [isBridgeReady, setIsBridgeReady] = useState(false);
@@ -8,14 +133,46 @@ export const useClanBridge = () => {
     null
   );
   const [avatarSrc, setAvatarSrc] = useState<string>("");
+  // Revision of the tree snapshot we hold; deltas must start from it
+  const treeRevisionRef = useRef<number>(-1);
 
   // 暴露给外部调用 C++ 的方法
   const fetchMemberDetail = (id: string) => {
     window.CallBridge?.invoke("fetchMemberDetail", id);
   };
 
+  // Request id of the initial (or resync) page; its answer replaces the loaded nodes
+  const rootRequestRef = useRef<string | null>(null);
+  const pageSeqRef = useRef(0);
+
   const fetchFamilyTree = () => {
-    window.CallBridge?.invoke("fetchFamilyTree", "init");
+    const requestId = `tree-${++pageSeqRef.current}`;
+    rootRequestRef.current = requestId;
+    window.CallBridge?.invoke(
+      "request", requestId, "fetchSubtree", "", INITIAL_DEPTH, INITIAL_LIMIT
+    );
+  };
+
+  // Child page requests in flight: request id -> parent and offset
+  const childRequestsRef = useRef(new Map<string, { id: string; offset: number }>());
+
+  const fetchChildren = (id: string, offset: number) => {
+    const requestId = `children-${++pageSeqRef.current}`;
+    childRequestsRef.current.set(requestId, { id, offset });
+    window.CallBridge?.invoke("request", requestId, "fetchTreeChildren", id, offset, CHILD_PAGE);
+  };
+
+  // The whole tree at once, as a binary snapshot (JSON when the app cannot serve one)
+  const loadFullTree = () => {
+    window.CallBridge?.invoke("fetchTreeSnapshot");
+  };
+
+  // Load the children of a node that has more than are on screen
+  const expandMember = (id: string) => {
+    const node = familyData.find((m) => m.id === id);
+    if (!node || !node.childCount) return;
+    const loaded = familyData.filter((m) => m.parentId === id).length;
+    if (loaded < node.childCount) fetchChildren(id, 0);
   };
 
   const getLocalImage = (path: string) => {
@@ -40,7 +197,51 @@ export const useClanBridge = () => {
         clearInterval(timer);
 
         // 绑定全局回调
-        window.onFamilyTreeDataReceived = (data) => setFamilyData(data);
+        window.onFamilyTreeDataReceived = (data, revision) => {
+          treeRevisionRef.current = revision ?? -1;
+          setFamilyData(data);
+        };
+
+        window.onTreePageReceived = (page, requestId) => {
+          if (requestId !== undefined && requestId === rootRequestRef.current) {
+            rootRequestRef.current = null;
+            treeRevisionRef.current = page.revision;
+            setFamilyData(page.nodes);
+            return;
+          }
+          setFamilyData((prev) => mergeTreePage(prev, page));
+          // Children beyond one page: keep going from where this one ended
+          const children = requestId ? childRequestsRef.current.get(requestId) : undefined;
+          if (children) {
+            childRequestsRef.current.delete(requestId!);
+            if (page.hasMore) fetchChildren(children.id, children.offset + page.nodes.length);
+          }
+        };
+
+        window.onTreeSnapshotReady = async (info) => {
+          try {
+            if (!info.url) throw new Error("media server not running");
+            const response = await fetch(info.url);
+            const snapshot = decodeTreeSnapshot(await response.arrayBuffer());
+            treeRevisionRef.current = snapshot.revision;
+            setFamilyData(snapshot.members);
+          } catch (e) {
+            console.warn("Tree snapshot unavailable, falling back to JSON:", e);
+            window.CallBridge?.invoke("fetchFamilyTree", "snapshot-fallback");
+          }
+        };
+
+        window.onFamilyTreeDeltaReceived = (delta) => {
+          if (delta.resync || delta.since !== treeRevisionRef.current) {
+            // Gap in the feed: fall back to a full snapshot
+            fetchFamilyTree();
+            return;
+          }
+          treeRevisionRef.current = delta.revision;
+          if (delta.changes.length > 0) {
+            setFamilyData((prev) => applyTreeDelta(prev, delta));
+          }
+        };
 
         window.onMemberDetailReceived = (data) => {
           if (data) {
@@ -101,6 +302,8 @@ export const useClanBridge = () => {
     setSelectedMember, // 允许手动关闭详情
     avatarSrc,
     fetchMemberDetail,
+    expandMember, // 分页家谱：展开尚未加载子节点的成员
+    loadFullTree, // 一次载入整棵树（二进制快照）
     updateMemberPortrait, // 导出此方法供组件使用
   };
 };
@@ -1,5 +1,5 @@
 import { useState, useEffect, useRef } from "react";
-import type { FamilyMember } from "../types";
+import type { FamilyMember, ResourceImportProgress } from "../types";
 
 export const useMedia = (selectedMember: FamilyMember | null) => {
   const [mediaType, setMediaType] = useState<
@@ -9,6 +9,7 @@ export const useMedia = (selectedMember: FamilyMember | null) => {
   const [mediaList, setMediaList] = useState<any[]>([]);
   const [currentMediaUrl, setCurrentMediaUrl] = useState<string>("");
   const [isUploading, setIsUploading] = useState(false);
+  const [uploadProgress, setUploadProgress] = useState<ResourceImportProgress | null>(null);
   
   // Media counts for SidePanel display
   const [mediaCounts, setMediaCounts] = useState<{
@@ -75,9 +76,14 @@ export const useMedia = (selectedMember: FamilyMember | null) => {
       }
     };
 
+    window.onResourceImportProgress = (progress) => {
+      setUploadProgress(progress);
+    };
+
     // Batch import callback - handles multi-file import results
     window.onMultipleResourcesImported = (result) => {
       setIsUploading(false);
+      setUploadProgress(null);
       if (result.status === "cancelled") return;
 
       // Show import results summary
@@ -262,6 +268,7 @@ export const useMedia = (selectedMember: FamilyMember | null) => {
     currentMediaUrl,
     setCurrentMediaUrl,
     isUploading,
+    uploadProgress,
     mediaCounts,  // Add for SidePanel display
     audioState: {
       isPlaying: isPlayingAudio,
@@ -12,22 +12,51 @@ export interface FamilyMember {
   birthPlace?: string;
   deathPlace?: string;
   portraitPath?: string;
+  avatarUrl?: string; // thumbnail URL from the app's media server (tree nodes)
+  lifeSpan?: string; // "1910-1985" (tree nodes)
   aliases?: string;
   fatherName?: string;
   bio?: string;
+  childCount?: number; // paged tree: children in the database, loaded or not
   children?: FamilyMember[];
 }
 
+export type TreeChange =
+  | { op: "add" | "update"; node: FamilyMember }
+  | { op: "remove"; id: string };
+
+export interface TreeDelta {
+  revision: number;
+  since: number;
+  resync: boolean;
+  changes: TreeChange[];
+}
+
+// One window of the paged tree (fetchSubtree / fetchTreeChildren / fetchGenerations)
+export interface TreePage {
+  revision: number;
+  nodes: FamilyMember[];
+  hasMore: boolean; // the limit cut the window short
+}
+
+// fetchTreeSnapshot answer: where to download the binary tree snapshot
+export interface TreeSnapshotInfo {
+  url: string; // empty when the app cannot serve it; use fetchFamilyTree instead
+  revision: number;
+  bytes: number;
+}
+
 export interface MediaItem {
   id: string;
   url: string;
+  thumbUrl?: string; // photos: small cached thumbnail from the media server
   title: string;
   type: "video" | "photo" | "audio";
 }
 
 export interface OperationLog {
   id: number;
-  action: "CREATE" | "UPDATE" | "DELETE";
+  action: "CREATE" | "UPDATE" | "DELETE" | "IMPORT";
   targetType: "member" | "media";
   targetId: string;
   targetName: string;
@@ -35,6 +64,26 @@ export interface OperationLog {
   createdAt: number;
 }
 
+export interface OperationLogQuery {
+  action?: string;
+  targetType?: string;
+  targetId?: string;
+  since?: number;
+  until?: number;
+  // Last entry of the previous page; omit for the first page
+  before?: { createdAt: number; id: number };
+  limit?: number;
+  archived?: boolean;
+}
+
+export interface OperationLogPage {
+  logs: OperationLog[];
+  hasMore: boolean;
+  // First page only; a lower bound or estimate when totalExact is false
+  total?: number;
+  totalExact?: boolean;
+}
+
 export interface SaveMemberResult {
   success: boolean;
   id?: string;
@@ -53,6 +102,7 @@ export interface BatchImportResult {
   imported: number;
   failed: number;
   total: number;
+  elapsedMs?: number;
   resources?: Array<{
     id: string;
     title: string;
@@ -64,20 +114,50 @@ export interface BatchImportResult {
   }>;
 }
 
+// importMultipleResources progress, at most every 100 ms and once for the last file
+export interface ResourceImportProgress {
+  done: number; // files finished, imported or failed
+  total: number;
+}
+
+// Bulk member import (importMembers bridge call)
+export interface MembersImportProgress {
+  rows: number; // rows written so far
+  indexing: boolean; // rows done, rebuilding the search index
+}
+
+export interface MembersImportResult {
+  success: boolean;
+  cancelled?: boolean;
+  imported?: number;
+  matched?: number; // id-less rows that updated a member with the same name and father
+  skipped?: number; // rows without a name
+  unresolvedFathers?: number; // FatherName matching no member
+  elapsedMs?: number;
+  error?: string;
+}
+
 // 扩展 Window 接口
 declare global {
   interface Window {
     CallBridge?: {
+      // invoke("request", requestId, method, ...args) answers through the method's usual
+      // callback with requestId as an extra last argument; invoke("cancelRequest",
+      // requestId) drops it if it has not been answered yet.
       // eslint-disable-next-line @typescript-eslint/no-explicit-any
       invoke: (name: string, ...args: any[]) => any;
     };
-    onFamilyTreeDataReceived?: (data: FamilyMember[]) => void;
+    onFamilyTreeDataReceived?: (data: FamilyMember[], revision?: number) => void;
+    onFamilyTreeDeltaReceived?: (delta: TreeDelta) => void;
+    onTreePageReceived?: (page: TreePage, requestId?: string) => void;
+    onTreeSnapshotReady?: (info: TreeSnapshotInfo) => void;
     onMemberDetailReceived?: (data: FamilyMember) => void;
     onLocalImageLoaded?: (path: string, base64: string) => void;
     // eslint-disable-next-line @typescript-eslint/no-explicit-any
     onResourceImported?: (data: any) => void;
     // eslint-disable-next-line @typescript-eslint/no-explicit-any
     onMultipleResourcesImported?: (result: BatchImportResult) => void;
+    onResourceImportProgress?: (progress: ResourceImportProgress) => void;
     // Admin management callbacks
     onMemberSaved?: (result: SaveMemberResult) => void;
     onMemberDeleted?: (result: DeleteMemberResult) => void;
@@ -86,6 +166,9 @@ declare global {
     onMediaResourceDeleted?: (result: any) => void;
     onSettingsReceived?: (key: string, value: string[]) => void;
     onOperationLogsReceived?: (logs: OperationLog[]) => void;
+    onOperationLogPageReceived?: (page: OperationLogPage) => void;
     onFileSelected?: (filePath: string) => void;
+    onMembersImportProgress?: (progress: MembersImportProgress) => void;
+    onMembersImported?: (result: MembersImportResult) => void;
   }
 }